@@ -0,0 +1,262 @@
+/*
+  ==============================================================================
+
+    AudioRecorder.cpp
+    Created: 18 Oct 2026 7:05:33am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "AudioRecorder.h"
+#include "CallbackProfiler.h"
+
+// how much audio each ring holds, several seconds of a slow or busy disk
+static const double ringSeconds = 4.0;
+// how often the writer looks for audio to write
+static const int writeIntervalMs = 20;
+static const int bitsPerSample = 24;
+
+//==============================================================================
+String AudioRecorder::getFormatName(Format format)
+{
+    switch (format)
+    {
+        case Format::wav:   return "WAV";
+        case Format::flac:  return "FLAC";
+    }
+    return {};
+}
+
+AudioRecorder::Stream::Stream(int ringSize)
+                     : fifo(ringSize),
+                       ring(2, ringSize)
+{
+    ring.clear();
+}
+
+AudioRecorder::AudioRecorder()
+             : Thread("Recorder")
+{
+}
+
+AudioRecorder::~AudioRecorder()
+{
+    stop();
+}
+
+void AudioRecorder::prepare(double _sampleRate)
+{
+    //the files were started at the old rate, so they end here
+    if (isRecording() && _sampleRate != sampleRate)
+    {
+        std::cout << "AudioRecorder::prepare the sample rate changed, recording stopped" << std::endl;
+        stop();
+    }
+    sampleRate = _sampleRate;
+}
+
+bool AudioRecorder::start(const File& _folder, Format format, int numDecks, bool includeDecks)
+{
+    stop();
+
+    if (! _folder.createDirectory())
+    {
+        std::cout << "AudioRecorder::start cannot create " << _folder.getFullPathName() << std::endl;
+        return false;
+    }
+    folder = _folder;
+
+    std::unique_ptr<AudioFormat> audioFormat;
+    if (format == Format::flac)
+    {
+        audioFormat.reset(new FlacAudioFormat());
+    }
+    else
+    {
+        audioFormat.reset(new WavAudioFormat());
+    }
+
+    StringArray names{"master"};
+    for (int i = 0; includeDecks && i < numDecks; ++i)
+    {
+        names.add("deck " + String(i + 1));
+    }
+
+    ringSize = roundToInt(ringSeconds * sampleRate);
+    for (auto& name : names)
+    {
+        auto file = folder.getChildFile(name + audioFormat->getFileExtensions()[0]);
+        file.deleteFile();
+
+        std::unique_ptr<FileOutputStream> stream (new FileOutputStream(file));
+        std::unique_ptr<AudioFormatWriter> writer;
+        if (stream->openedOk())
+        {
+            writer.reset(audioFormat->createWriterFor(stream.get(), sampleRate, 2, bitsPerSample, {}, 0));
+        }
+        if (writer == nullptr)
+        {
+            std::cout << "AudioRecorder::start cannot write " << file.getFullPathName() << std::endl;
+            streams.clear();
+            return false;
+        }
+        //the writer owns the stream now
+        stream.release();
+
+        auto* recorderStream = streams.add(new Stream(ringSize));
+        recorderStream->writer = std::move(writer);
+    }
+
+    samplesRecorded = 0;
+    droppedBlocks = 0;
+    peakRingSamples = 0;
+
+    startThread(4);
+    recording = true;
+    return true;
+}
+
+void AudioRecorder::stop()
+{
+    if (! recording.exchange(false))
+    {
+        return;
+    }
+
+    //a push that saw the flag still set finishes before the streams go away
+    while (pushesInProgress.load() > 0)
+    {
+        Thread::yield();
+    }
+
+    //the writer drains what is left before it exits, then the writers close their files
+    stopThread(10000);
+    streams.clear();
+}
+
+bool AudioRecorder::isRecording() const
+{
+    return recording;
+}
+
+File AudioRecorder::getFolder() const
+{
+    return folder;
+}
+
+AudioRecorder::Stats AudioRecorder::getStats() const
+{
+    Stats stats;
+    stats.secondsRecorded = samplesRecorded / sampleRate;
+    stats.droppedBlocks = droppedBlocks;
+    stats.peakRingUsage = ringSize > 0 ? peakRingSamples / (float) ringSize : 0.0f;
+    return stats;
+}
+
+void AudioRecorder::pushMaster(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    push(0, buffer, startSample, numSamples);
+
+    if (recording.load(std::memory_order_relaxed))
+    {
+        samplesRecorded.fetch_add(numSamples, std::memory_order_relaxed);
+    }
+}
+
+void AudioRecorder::pushDeck(int deckIndex, const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    push(deckIndex + 1, buffer, startSample, numSamples);
+}
+
+//==============================================================================
+void AudioRecorder::push(int streamIndex, const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    //a single atomic load when not recording
+    if (! recording.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    ++pushesInProgress;
+    if (recording && isPositiveAndBelow(streamIndex, streams.size()))
+    {
+        CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::record);
+        auto* stream = streams.getUnchecked(streamIndex);
+
+        //a block is written whole or not at all, so a file never has half a block missing
+        if (stream->fifo.getFreeSpace() < numSamples)
+        {
+            ++droppedBlocks;
+        }
+        else
+        {
+            int start1, size1, start2, size2;
+            stream->fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                const auto* samples = buffer.getReadPointer(jmin(ch, buffer.getNumChannels() - 1), startSample);
+                stream->ring.copyFrom(ch, start1, samples, size1);
+                stream->ring.copyFrom(ch, start2, samples + size1, size2);
+            }
+            stream->fifo.finishedWrite(size1 + size2);
+
+            const int used = stream->fifo.getNumReady();
+            if (used > peakRingSamples.load(std::memory_order_relaxed))
+            {
+                peakRingSamples.store(used, std::memory_order_relaxed);
+            }
+        }
+    }
+    --pushesInProgress;
+}
+
+void AudioRecorder::run()
+{
+    while (! threadShouldExit())
+    {
+        if (! drain())
+        {
+            wait(writeIntervalMs);
+        }
+    }
+
+    //nothing more is pushed once stop() has been called
+    drain();
+}
+
+bool AudioRecorder::drain()
+{
+    bool wroteAny = false;
+
+    for (auto* stream : streams)
+    {
+        const int numReady = stream->fifo.getNumReady();
+        if (numReady == 0)
+        {
+            continue;
+        }
+
+        int start1, size1, start2, size2;
+        stream->fifo.prepareToRead(numReady, start1, size1, start2, size2);
+
+        for (auto block : { std::make_pair(start1, size1), std::make_pair(start2, size2) })
+        {
+            if (block.second == 0)
+            {
+                continue;
+            }
+            const float* channels[] = { stream->ring.getReadPointer(0, block.first),
+                                        stream->ring.getReadPointer(1, block.first) };
+            if (! stream->writer->writeFromFloatArrays(channels, 2, block.second))
+            {
+                std::cout << "AudioRecorder::drain could not write to the recording" << std::endl;
+            }
+        }
+
+        stream->fifo.finishedRead(size1 + size2);
+        wroteAny = true;
+    }
+    return wroteAny;
+}
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    AudioRecorder.h
+    Created: 18 Oct 2026 7:05:33am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Records the master output, and optionally each deck before its fader, to
+    WAV or FLAC files. The audio threads only copy their blocks into lock-free
+    ring buffers, one per file; a writer thread drains and encodes them. A block
+    that finds its ring full is dropped and counted, so the counters show
+    whether the disk kept up.
+*/
+class AudioRecorder : private Thread
+{
+public:
+    enum class Format
+    {
+        wav,
+        flac
+    };
+
+    /** counters for the recording in progress, or the last one */
+    struct Stats
+    {
+        double secondsRecorded = 0;
+        int droppedBlocks = 0;
+        /** the most of any ring that was ever waiting to be written, from 0 to 1 */
+        float peakRingUsage = 0;
+    };
+
+    /** e.g. "WAV", for menus */
+    static String getFormatName(Format format);
+
+    AudioRecorder();
+    ~AudioRecorder() override;
+
+    /** the device's rate; a different rate while recording ends the recording */
+    void prepare(double sampleRate);
+
+    /** starts master.wav (or .flac) in the folder, with "deck 1" and on beside it when
+        includeDecks is set. False if a file couldn't be created */
+    bool start(const File& folder, Format format, int numDecks, bool includeDecks);
+    /** waits for the writer to catch up, then closes the files */
+    void stop();
+    bool isRecording() const;
+    /** where the last recording was started */
+    File getFolder() const;
+
+    Stats getStats() const;
+
+    /** called by the audio thread with the output going to the device */
+    void pushMaster(const AudioBuffer<float>& buffer, int startSample, int numSamples);
+    /** called by each deck's rendering thread with its signal before the fader */
+    void pushDeck(int deckIndex, const AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+private:
+    /** one file and the ring that feeds it; only one thread ever pushes to each */
+    struct Stream
+    {
+        Stream(int ringSize);
+
+        std::unique_ptr<AudioFormatWriter> writer;
+        AbstractFifo fifo;
+        AudioBuffer<float> ring;
+    };
+
+    /** writer thread */
+    void run() override;
+    /** writes whatever is waiting in the rings, returns true if there was anything */
+    bool drain();
+
+    void push(int streamIndex, const AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    //streams is only changed by start() and stop(), with no push in progress
+    OwnedArray<Stream> streams;
+    std::atomic<bool> recording{false};
+    std::atomic<int> pushesInProgress{0};
+
+    std::atomic<double> sampleRate{44100.0};
+    File folder;
+
+    std::atomic<int64> samplesRecorded{0};
+    std::atomic<int> droppedBlocks{0};
+    std::atomic<int> peakRingSamples{0};
+    int ringSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioRecorder)
+};
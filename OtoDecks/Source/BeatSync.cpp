@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    BeatSync.cpp
+    Created: 17 Oct 2026 9:40:17pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BeatSync.h"
+
+//==============================================================================
+void BeatSync::setMasterDeck(int deckIndex)
+{
+    masterDeck = deckIndex < maxDecks ? jmax(-1, deckIndex) : -1;
+}
+
+int BeatSync::getMasterDeck() const
+{
+    return masterDeck;
+}
+
+void BeatSync::publish(int deckIndex, int64 block, const BeatClock& clock)
+{
+    write(deckIndex, block, clock, true);
+}
+
+void BeatSync::clear(int deckIndex, int64 block)
+{
+    write(deckIndex, block, {}, false);
+}
+
+void BeatSync::reset(int deckIndex)
+{
+    write(deckIndex, -1, {}, false);
+    write(deckIndex, -2, {}, false);
+}
+
+bool BeatSync::read(int deckIndex, int64 block, BeatClock& clock) const
+{
+    if (! isPositiveAndBelow(deckIndex, maxDecks) || block < 0)
+    {
+        return false;
+    }
+    auto& line = lines[deckIndex][block & 1];
+
+    //the writer holds the line for a handful of stores, and is normally writing the other one
+    //anyway, so a retry or two is all it takes. Give up rather than spin if it keeps changing
+    for (int attempt = 0; attempt < 4; ++attempt)
+    {
+        const auto before = line.sequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0)
+        {
+            continue;
+        }
+
+        const bool isRunning = line.isRunning.load(std::memory_order_relaxed);
+        const auto lineBlock = line.block.load(std::memory_order_relaxed);
+        clock.originSample = line.originSample.load(std::memory_order_relaxed);
+        clock.beatAtOrigin = line.beatAtOrigin.load(std::memory_order_relaxed);
+        clock.beatsPerSample = line.beatsPerSample.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (line.sequence.load(std::memory_order_relaxed) == before)
+        {
+            return isRunning && lineBlock == block;
+        }
+    }
+    return false;
+}
+
+void BeatSync::write(int deckIndex, int64 block, const BeatClock& clock, bool isRunning)
+{
+    if (! isPositiveAndBelow(deckIndex, maxDecks))
+    {
+        return;
+    }
+    auto& line = lines[deckIndex][block & 1];
+
+    //only this deck writes its lines, so the counter needs no read-modify-write
+    const auto sequence = line.sequence.load(std::memory_order_relaxed);
+    line.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    line.block.store(block, std::memory_order_relaxed);
+    line.isRunning.store(isRunning, std::memory_order_relaxed);
+    line.originSample.store(clock.originSample, std::memory_order_relaxed);
+    line.beatAtOrigin.store(clock.beatAtOrigin, std::memory_order_relaxed);
+    line.beatsPerSample.store(clock.beatsPerSample, std::memory_order_relaxed);
+
+    line.sequence.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    BeatSync.h
+    Created: 17 Oct 2026 9:40:17pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Where a deck's beats are on the shared sample clock: the beat playing at
+    originSample, and how far the beat moves per sample from there.
+
+    The clock is the number of samples a deck has rendered since prepareToPlay.
+    DeckEngine prepares every deck together and renders each of them every block,
+    so all decks agree on it, and on how many blocks they've rendered.
+*/
+struct BeatClock
+{
+    int64 originSample = 0;
+    double beatAtOrigin = 0;
+    double beatsPerSample = 0;
+
+    double getBeatAt(int64 sample) const
+    {
+        return beatAtOrigin + beatsPerSample * (double) (sample - originSample);
+    }
+};
+
+//==============================================================================
+/*
+    Sync between decks. Every playing deck publishes its BeatClock once a block,
+    stamped with the block's number, and a deck in sync mode follows the clock
+    the master deck published for the block before the one it is rendering.
+
+    The master measures its line afresh every block, so this block's line and
+    last block's can put a beat a little apart. Decks render in parallel, and
+    reading whichever happens to be there would make followers jitter by that
+    much depending on thread timing. The previous block's line is always
+    complete by the time any deck starts a block, so every follower sees the
+    same one whatever the timing, and offline renders come out the same each time.
+
+    Each deck keeps the lines for the last two blocks, each behind a sequence
+    counter, so a reader never sees half of an update and neither side ever locks.
+*/
+class BeatSync
+{
+public:
+    static constexpr int maxDecks = 8;
+
+    /** the deck the others follow, -1 for none. Any thread */
+    void setMasterDeck(int deckIndex);
+    int getMasterDeck() const;
+
+    /** the deck's clock for block number block (that deck's audio thread) */
+    void publish(int deckIndex, int64 block, const BeatClock& clock);
+    /** marks a deck as having no beat to follow in block number block, when it's stopped or has no beatgrid */
+    void clear(int deckIndex, int64 block);
+    /** forgets a deck's clocks, when its device is prepared or released */
+    void reset(int deckIndex);
+
+    /** the deck's clock for block number block; false if it had none then or the block's line has
+        already been replaced (any thread, never blocks) */
+    bool read(int deckIndex, int64 block, BeatClock& clock) const;
+
+private:
+    struct Line
+    {
+        // odd while the clock is being written
+        std::atomic<uint32> sequence{0};
+        std::atomic<int64> block{-1};
+        std::atomic<bool> isRunning{false};
+        std::atomic<int64> originSample{0};
+        std::atomic<double> beatAtOrigin{0};
+        std::atomic<double> beatsPerSample{0};
+    };
+
+    /** a block's line goes in the half its number picks, so the one before it is left alone */
+    void write(int deckIndex, int64 block, const BeatClock& clock, bool isRunning);
+
+    Line lines[maxDecks][2];
+    std::atomic<int> masterDeck{0};
+};
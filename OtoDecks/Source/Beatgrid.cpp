@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    Beatgrid.cpp
+    Created: 17 Oct 2026 9:14:52pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Beatgrid.h"
+#include "VectorKernels.h"
+
+static const double minBpm = 60.0;
+static const double maxBpm = 200.0;
+// the autocorrelation can't tell 64 from 128 BPM, so it leans towards the tempos DJs play
+static const double preferredBpm = 120.0;
+
+//==============================================================================
+bool Beatgrid::isValid() const
+{
+    return bpm > 0;
+}
+
+double Beatgrid::getBeatAt(double seconds) const
+{
+    return (seconds - firstBeat) * bpm / 60.0;
+}
+
+double Beatgrid::getTimeOfBeat(double beat) const
+{
+    return firstBeat + beat * 60.0 / bpm;
+}
+
+Beatgrid Beatgrid::analyse(const AudioBuffer<float>& samples, double sampleRate)
+{
+    //about 5ms per frame
+    const int hop = nextPowerOfTwo(roundToInt(sampleRate / 200.0));
+    const int numChannels = jmin(2, samples.getNumChannels());
+    const int numFrames = samples.getNumSamples() / jmax(1, hop);
+    const double frameRate = sampleRate / hop;
+
+    //too short to find a tempo in
+    if (sampleRate <= 0 || numChannels == 0 || numFrames < frameRate * 10.0)
+    {
+        return {};
+    }
+
+    //onset strength: how sharply the energy of the low end (kicks) and of the whole band rises in each frame
+    HeapBlock<float> onsets((size_t) numFrames, true);
+    {
+        const float lowCoefficient = (float) (1.0 - std::exp(-MathConstants<double>::twoPi * 150.0 / sampleRate));
+        float low = 0;
+        double previousLow = 0, previousFull = 0;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            double lowEnergy = 0, fullEnergy = 0;
+
+            for (int i = frame * hop; i < (frame + 1) * hop; ++i)
+            {
+                float x = samples.getSample(0, i);
+                if (numChannels > 1)
+                {
+                    x = 0.5f * (x + samples.getSample(1, i));
+                }
+                low += lowCoefficient * (x - low);
+                lowEnergy += low * low;
+                fullEnergy += x * x;
+            }
+
+            const double logLow = std::log(1.0e-9 + lowEnergy / hop);
+            const double logFull = std::log(1.0e-9 + fullEnergy / hop);
+
+            if (frame > 0)
+            {
+                onsets[frame] = (float) (jmax(0.0, logLow - previousLow) + 0.5 * jmax(0.0, logFull - previousFull));
+            }
+            previousLow = logLow;
+            previousFull = logFull;
+        }
+    }
+
+    //keep only what stands out from the last quarter second, so loud passages don't drown the quiet ones
+    {
+        const int span = jmax(1, roundToInt(frameRate * 0.25));
+        HeapBlock<float> raw((size_t) numFrames, false);
+        std::memcpy(raw.getData(), onsets.getData(), sizeof(float) * (size_t) numFrames);
+
+        double sum = 0;
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            sum += raw[frame];
+            if (frame >= span)
+            {
+                sum -= raw[frame - span];
+            }
+            onsets[frame] = jmax(0.0f, raw[frame] - (float) (sum / jmin(frame + 1, span)));
+        }
+    }
+
+    //rough tempo: the strongest autocorrelation lag, weighted towards preferredBpm
+    const int minLag = jmax(2, (int) std::floor(frameRate * 60.0 / maxBpm));
+    const int maxLag = (int) std::ceil(frameRate * 60.0 / minBpm);
+    HeapBlock<double> scores((size_t) maxLag + 2, true);
+    int bestLag = 0;
+
+    for (int lag = minLag - 1; lag <= maxLag + 1; ++lag)
+    {
+        const double correlation = VectorKernels::dotProduct(onsets, onsets + lag, numFrames - lag);
+        const double octaves = std::log2(frameRate * 60.0 / lag / preferredBpm);
+        scores[lag] = correlation * std::exp(-0.5 * octaves * octaves / (0.8 * 0.8));
+
+        if (lag >= minLag && lag <= maxLag && (bestLag == 0 || scores[lag] > scores[bestLag]))
+        {
+            bestLag = lag;
+        }
+    }
+
+    if (scores[bestLag] <= 0)
+    {
+        return {};
+    }
+
+    //parabolic fit through the neighbours for a fractional lag
+    const double before = scores[bestLag - 1], peak = scores[bestLag], after = scores[bestLag + 1];
+    const double curvature = before - 2.0 * peak + after;
+    const double lagOffset = curvature < 0 ? jlimit(-0.5, 0.5, 0.5 * (before - after) / curvature) : 0.0;
+    const double roughBpm = frameRate * 60.0 / (bestLag + lagOffset);
+
+    //exact tempo and phase: the period whose beats pile up onsets most sharply over the whole track.
+    //a slightly wrong tempo drifts across the track and smears its phase histogram
+    Beatgrid best;
+    double bestScore = 0, bestMean = 0;
+    HeapBlock<double> histogram;
+
+    for (double candidate = roughBpm * 0.985; candidate <= roughBpm * 1.015; candidate += 0.01)
+    {
+        const double period = frameRate * 60.0 / candidate;
+        const int numBins = (int) period;
+        histogram.calloc((size_t) numBins);
+
+        double phase = 0;
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            histogram[jmin(numBins - 1, (int) (phase * numBins / period))] += onsets[frame];
+            phase += 1.0;
+            if (phase >= period)
+            {
+                phase -= period;
+            }
+        }
+
+        double total = 0;
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            total += histogram[bin];
+
+            const double score = histogram[bin]
+                               + 0.5 * (histogram[(bin + numBins - 1) % numBins] + histogram[(bin + 1) % numBins]);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                best.bpm = candidate;
+                //an onset is measured over its frame, so it lands half a frame in
+                best.firstBeat = ((bin + 0.5) * period / numBins + 0.5) / frameRate;
+            }
+        }
+
+        if (best.bpm == candidate)
+        {
+            bestMean = total / numBins;
+        }
+    }
+
+    //a beat should stand well clear of the average; ambient tracks and speech don't
+    if (bestScore < 3.0 * bestMean)
+    {
+        return {};
+    }
+
+    best.firstBeat = std::fmod(best.firstBeat, 60.0 / best.bpm);
+    return best;
+}
@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    Beatgrid.h
+    Created: 17 Oct 2026 9:14:52pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Where the beats of a track fall, assuming a constant tempo: beat n is at
+    firstBeat + n * 60 / bpm seconds. Beats before firstBeat have negative numbers.
+*/
+struct Beatgrid
+{
+    double bpm = 0;
+    // time of beat 0 in seconds, within the first beat of the track
+    double firstBeat = 0;
+
+    /** false when no steady beat was found */
+    bool isValid() const;
+
+    /** beats since beat 0 at a time in the track */
+    double getBeatAt(double seconds) const;
+    /** time in the track of a (fractional) beat */
+    double getTimeOfBeat(double beat) const;
+
+    /** estimates the grid of a decoded track. Takes a few tens of milliseconds
+        per minute of audio, so call it off the message and audio threads */
+    static Beatgrid analyse(const AudioBuffer<float>& samples, double sampleRate);
+};
@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+    CallbackProfiler.cpp
+    Created: 18 Oct 2026 2:24:38am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CallbackProfiler.h"
+
+thread_local CallbackProfiler::ScopedStage* CallbackProfiler::ScopedStage::current = nullptr;
+
+/** raises value to at least newValue */
+static void updateMaximum(std::atomic<int64>& value, int64 newValue)
+{
+    auto previous = value.load(std::memory_order_relaxed);
+    while (newValue > previous && ! value.compare_exchange_weak(previous, newValue, std::memory_order_relaxed))
+    {
+    }
+}
+
+//==============================================================================
+CallbackProfiler& CallbackProfiler::getInstance()
+{
+    static CallbackProfiler instance;
+    return instance;
+}
+
+String CallbackProfiler::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case Stage::callback:   return "callback";
+        case Stage::decode:     return "decode";
+        case Stage::stretch:    return "stretch";
+        case Stage::resample:   return "resample";
+        case Stage::eq:         return "eq";
+        case Stage::mix:        return "mix";
+        case Stage::limiter:    return "limiter";
+        case Stage::record:     return "record";
+        case Stage::waveformPaint:  return "wf paint";
+        case Stage::waveformLayer:  return "wf layer";
+    }
+    return {};
+}
+
+CallbackProfiler::CallbackProfiler()
+                : secondsPerTick(1.0 / (double) Time::getHighResolutionTicksPerSecond())
+{
+    reset();
+}
+
+void CallbackProfiler::setEnabled(bool shouldBeEnabled)
+{
+    enabled = shouldBeEnabled;
+}
+
+bool CallbackProfiler::isEnabled() const
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void CallbackProfiler::reset()
+{
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        for (auto& bin : histograms[stage])
+        {
+            bin = 0;
+        }
+        counts[stage] = 0;
+        totalNanoseconds[stage] = 0;
+        maxNanoseconds[stage] = 0;
+    }
+
+    blocks = 0;
+    deadlineMisses = 0;
+    totalLoad = 0;
+    worstLoad = 0;
+}
+
+CallbackProfiler::Stats CallbackProfiler::getStats() const
+{
+    Stats stats;
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        auto& stage = stats.stages[i];
+        stage.count = counts[i];
+        if (stage.count == 0)
+        {
+            continue;
+        }
+
+        stage.mean = totalNanoseconds[i] / (double) stage.count / 1000.0;
+        stage.max = maxNanoseconds[i] / 1000.0;
+        stage.p50 = getPercentile(i, stage.count, 0.5);
+        stage.p99 = getPercentile(i, stage.count, 0.99);
+        stage.p999 = getPercentile(i, stage.count, 0.999);
+    }
+
+    stats.blocks = blocks;
+    stats.deadlineMisses = deadlineMisses;
+    stats.meanLoad = stats.blocks > 0 ? totalLoad / (double) stats.blocks / 1.0e6 : 0.0;
+    stats.worstLoad = worstLoad / 1.0e6;
+    return stats;
+}
+
+String CallbackProfiler::createReport(int deviceXRuns) const
+{
+    const auto stats = getStats();
+
+    String report;
+    report << "blocks " << stats.blocks << ", deadline misses " << stats.deadlineMisses;
+    if (deviceXRuns >= 0)
+    {
+        report << ", device xruns " << deviceXRuns;
+    }
+    report << newLine
+           << "callback load " << String(stats.meanLoad * 100.0, 1) << "% mean, "
+           << String(stats.worstLoad * 100.0, 1) << "% worst" << newLine << newLine;
+
+    report << String::formatted("%-10s %9s %9s %9s %9s %9s %9s", "stage (us)", "calls", "mean", "p50", "p99", "p99.9", "max") << newLine;
+    for (int i = 0; i < numStages; ++i)
+    {
+        const auto& stage = stats.stages[i];
+        report << String::formatted("%-10s %9lld %9.1f %9.1f %9.1f %9.1f %9.1f",
+                                    getStageName((Stage) i).toRawUTF8(), (long long) stage.count,
+                                    stage.mean, stage.p50, stage.p99, stage.p999, stage.max)
+               << newLine;
+    }
+    return report;
+}
+
+bool CallbackProfiler::writeReport(const File& file, int deviceXRuns) const
+{
+    if (! file.replaceWithText(createReport(deviceXRuns)))
+    {
+        std::cout << "CallbackProfiler::writeReport could not write " << file.getFullPathName() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//==============================================================================
+void CallbackProfiler::record(Stage stage, int64 ticks) noexcept
+{
+    const auto nanoseconds = (int64) (ticks * secondsPerTick * 1.0e9);
+    const int index = (int) stage;
+
+    histograms[index][getBin(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    counts[index].fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds[index].fetch_add(nanoseconds, std::memory_order_relaxed);
+    updateMaximum(maxNanoseconds[index], nanoseconds);
+}
+
+void CallbackProfiler::recordBlock(int64 ticks, double budgetSeconds) noexcept
+{
+    const auto load = (int64) (ticks * secondsPerTick / budgetSeconds * 1.0e6);
+
+    blocks.fetch_add(1, std::memory_order_relaxed);
+    totalLoad.fetch_add(load, std::memory_order_relaxed);
+    updateMaximum(worstLoad, load);
+
+    if (load > 1000000)
+    {
+        deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int CallbackProfiler::getBin(int64 nanoseconds) noexcept
+{
+    if (nanoseconds < 4)
+    {
+        return (int) jmax((int64) 0, nanoseconds);
+    }
+
+    //the octave, then which quarter of it
+    const auto value = (uint32) jmin(nanoseconds, (int64) 0xffffffff);
+    const int octave = findHighestSetBit(value);
+    const int quarter = (int) (value >> (octave - 2)) & 3;
+    return octave * 4 + quarter - 4;
+}
+
+double CallbackProfiler::getBinTop(int bin)
+{
+    if (bin < 4)
+    {
+        return bin + 1;
+    }
+    return (double) ((int64) (5 + bin % 4) << (bin / 4 - 1));
+}
+
+double CallbackProfiler::getPercentile(int stageIndex, int64 count, double fraction) const
+{
+    const auto target = (int64) std::ceil(count * fraction);
+    int64 seen = 0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        seen += histograms[stageIndex][bin].load(std::memory_order_relaxed);
+        if (seen >= target)
+        {
+            return getBinTop(bin) / 1000.0;
+        }
+    }
+    return maxNanoseconds[stageIndex] / 1000.0;
+}
+
+//==============================================================================
+void CallbackProfiler::ScopedStage::begin() noexcept
+{
+    active = true;
+    parent = current;
+    current = this;
+    startTicks = Time::getHighResolutionTicks();
+}
+
+void CallbackProfiler::ScopedStage::end() noexcept
+{
+    const auto elapsed = Time::getHighResolutionTicks() - startTicks;
+
+    current = parent;
+    if (parent != nullptr)
+    {
+        parent->childTicks += elapsed;
+    }
+
+    //the callback is timed whole, everything else without the stages it called into
+    auto& profiler = getInstance();
+    if (stage == Stage::callback)
+    {
+        profiler.record(stage, elapsed);
+        if (budgetSeconds > 0)
+        {
+            profiler.recordBlock(elapsed, budgetSeconds);
+        }
+    }
+    else
+    {
+        profiler.record(stage, elapsed - childTicks);
+    }
+}
+
+//==============================================================================
+CallbackProfiler::ProfiledSource::ProfiledSource(AudioSource* _input, Stage _stage)
+                                : input(_input),
+                                  stage(_stage)
+{
+}
+
+void CallbackProfiler::ProfiledSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void CallbackProfiler::ProfiledSource::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    ScopedStage scope(stage);
+    input->getNextAudioBlock(bufferToFill);
+}
+
+void CallbackProfiler::ProfiledSource::releaseResources()
+{
+    input->releaseResources();
+}
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    CallbackProfiler.h
+    Created: 18 Oct 2026 2:24:38am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Times the audio callback and each stage of the deck chain inside it, so we
+    can see how much of the block's budget goes where.
+
+    Code marks a stage with a ScopedStage. Stages nest: a stage's time is its
+    own, without the stages it calls into, so the decode inside the resampler
+    isn't counted twice. The callback itself is the one exception and is timed
+    whole. Every stage keeps a histogram of its times with four bins per
+    octave, plus a count, total and maximum. A callback that took longer than
+    the audio it rendered lasts is counted as a deadline miss.
+
+    Recording is a few relaxed atomic adds and works from any thread, which
+    matters because DeckEngine renders decks on its workers. While profiling is
+    off a ScopedStage only checks one flag. The waveform stages are timed on
+    the message thread, as the decks' waveforms are painted.
+*/
+class CallbackProfiler
+{
+public:
+    enum class Stage
+    {
+        callback,
+        decode,
+        stretch,
+        resample,
+        eq,
+        mix,
+        limiter,
+        record,
+        waveformPaint,
+        waveformLayer
+    };
+
+    static constexpr int numStages = 10;
+
+    /** times in microseconds */
+    struct StageStats
+    {
+        int64 count = 0;
+        double mean = 0;
+        double max = 0;
+        double p50 = 0;
+        double p99 = 0;
+        double p999 = 0;
+    };
+
+    struct Stats
+    {
+        StageStats stages[numStages];
+        int64 blocks = 0;
+        int64 deadlineMisses = 0;
+        /** the share of a block's duration the callback took, on average and at worst */
+        double meanLoad = 0;
+        double worstLoad = 0;
+    };
+
+    /** the profiler every stage reports to */
+    static CallbackProfiler& getInstance();
+
+    /** e.g. "resample", for reports */
+    static String getStageName(Stage stage);
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const;
+
+    /** clears every count; stages still in flight may land in either side */
+    void reset();
+
+    Stats getStats() const;
+    /** a table of the stats; deviceXRuns is left out when negative */
+    String createReport(int deviceXRuns = -1) const;
+    /** writes createReport() to a text file */
+    bool writeReport(const File& file, int deviceXRuns = -1) const;
+
+    //==============================================================================
+    /** times the enclosing scope as one stage */
+    class ScopedStage
+    {
+    public:
+        explicit ScopedStage(Stage _stage) noexcept
+            : stage(_stage)
+        {
+            if (getInstance().isEnabled())
+            {
+                begin();
+            }
+        }
+
+        /** times the whole callback for a block of numSamples, counting a miss if it overran */
+        ScopedStage(int numSamples, double sampleRate) noexcept
+            : stage(Stage::callback)
+        {
+            if (getInstance().isEnabled() && sampleRate > 0)
+            {
+                budgetSeconds = numSamples / sampleRate;
+                begin();
+            }
+        }
+
+        ~ScopedStage()
+        {
+            if (active)
+            {
+                end();
+            }
+        }
+
+    private:
+        void begin() noexcept;
+        void end() noexcept;
+
+        const Stage stage;
+        bool active = false;
+        double budgetSeconds = 0;
+        int64 startTicks = 0;
+        int64 childTicks = 0;
+        ScopedStage* parent = nullptr;
+
+        // the innermost stage running on this thread
+        static thread_local ScopedStage* current;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedStage)
+    };
+
+    //==============================================================================
+    /** passes another source through, timing it as a stage */
+    class ProfiledSource : public AudioSource
+    {
+    public:
+        ProfiledSource(AudioSource* _input, Stage _stage);
+
+        void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+        void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+        void releaseResources() override;
+
+    private:
+        AudioSource* input;
+        const Stage stage;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfiledSource)
+    };
+
+private:
+    // four bins per octave of nanoseconds, the last catching anything over four seconds
+    static constexpr int numBins = 124;
+
+    CallbackProfiler();
+
+    void record(Stage stage, int64 ticks) noexcept;
+    void recordBlock(int64 ticks, double budgetSeconds) noexcept;
+    /** the bin a time in nanoseconds falls in, and the time at the top of a bin */
+    static int getBin(int64 nanoseconds) noexcept;
+    static double getBinTop(int bin);
+    /** the time under which a fraction of a stage's calls fell, in microseconds */
+    double getPercentile(int stageIndex, int64 count, double fraction) const;
+
+    const double secondsPerTick;
+
+    std::atomic<bool> enabled{false};
+
+    std::atomic<uint32> histograms[numStages][numBins];
+    std::atomic<int64> counts[numStages];
+    std::atomic<int64> totalNanoseconds[numStages];
+    std::atomic<int64> maxNanoseconds[numStages];
+
+    std::atomic<int64> blocks{0};
+    std::atomic<int64> deadlineMisses{0};
+    // in millionths of the budget, so they add up as integers
+    std::atomic<int64> totalLoad{0};
+    std::atomic<int64> worstLoad{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CallbackProfiler)
+};
@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    CueSource.cpp
+    Created: 18 Oct 2026 1:36:52am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "CueSource.h"
+
+//==============================================================================
+CueSource::CueSource(PositionableAudioSource* _source)
+          : source(_source)
+{
+}
+
+CueSource::~CueSource()
+{
+    //the audio thread has let go of the track by now, so every region is ours
+    for (auto* region : regions)
+    {
+        delete region;
+    }
+}
+
+bool CueSource::setRegion(int slot, std::unique_ptr<Region> region)
+{
+    if (! isPositiveAndBelow(slot, maxRegions))
+    {
+        std::cout << "CueSource::setRegion slot should be between 0 and " << maxRegions - 1 << std::endl;
+        return false;
+    }
+
+    deleteRetiredRegions();
+
+    if (! pendingRegions.push(region.get(), slot))
+    {
+        std::cout << "CueSource::setRegion the audio thread hasn't picked up the last regions yet" << std::endl;
+        return false;
+    }
+
+    region.release();
+    return true;
+}
+
+void CueSource::deleteRetiredRegions()
+{
+    retiredRegions.deleteRetired();
+}
+
+void CueSource::setLoop(int64 start, int64 end)
+{
+    const bool wasLooping = loopEnd > loopStart;
+    const int64 oldEnd = loopEnd;
+
+    loopStart = start;
+    loopEnd = end;
+
+    if (end <= start || ! wasLooping)
+    {
+        return;
+    }
+
+    //halving a loop from its second half lands where the playhead would be had it been this short all along
+    auto pos = position.load();
+    if (pos >= end && pos < oldEnd && pos >= start)
+    {
+        position.compare_exchange_strong(pos, start + (pos - start) % (end - start));
+    }
+}
+
+bool CueSource::hasLoop() const
+{
+    return loopEnd > loopStart;
+}
+
+void CueSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+void CueSource::releaseResources()
+{
+    source->releaseResources();
+}
+
+void CueSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    takePendingRegions();
+
+    auto startPos = position.load();
+    auto pos = startPos;
+    int done = 0;
+
+    //a loop shorter than the block wraps as many times as it has to
+    while (done < bufferToFill.numSamples)
+    {
+        int length = bufferToFill.numSamples - done;
+        bool wraps = false;
+
+        if (loopEnd > loopStart && pos < loopEnd && pos + length >= loopEnd)
+        {
+            length = (int) (loopEnd - pos);
+            wraps = true;
+        }
+
+        readSegment(AudioSourceChannelInfo(bufferToFill.buffer, bufferToFill.startSample + done, length), pos);
+        done += length;
+        pos = wraps ? loopStart : pos + length;
+    }
+
+    //a hot cue triggered during the block has already moved the position, and it stands
+    position.compare_exchange_strong(startPos, pos);
+}
+
+void CueSource::setNextReadPosition(int64 newPosition)
+{
+    position = newPosition;
+}
+
+int64 CueSource::getNextReadPosition() const
+{
+    return position;
+}
+
+int64 CueSource::getTotalLength() const
+{
+    return source->getTotalLength();
+}
+
+bool CueSource::isLooping() const
+{
+    //loops are played here, so the transport never sees the end of the track while one is on
+    return false;
+}
+
+//==============================================================================
+void CueSource::takePendingRegions()
+{
+    pendingRegions.take([this] (Region* region, int slot)
+    {
+        retiredRegions.retire(regions[slot]);
+        regions[slot] = region;
+    });
+}
+
+void CueSource::readSegment(const AudioSourceChannelInfo& bufferToFill, int64 pos)
+{
+    int offset = bufferToFill.startSample;
+    int numSamples = bufferToFill.numSamples;
+
+    while (numSamples > 0)
+    {
+        auto* region = findRegion(pos);
+
+        //carrying on from the source is always safe; a region only stands in for it after a jump
+        if (region == nullptr || pos == sourcePosition)
+        {
+            if (pos != sourcePosition)
+            {
+                source->setNextReadPosition(pos);
+            }
+            source->getNextAudioBlock(AudioSourceChannelInfo(bufferToFill.buffer, offset, numSamples));
+            sourcePosition = pos + numSamples;
+            return;
+        }
+
+        const int64 regionEnd = region->start + region->samples.getNumSamples();
+        const int length = (int) jmin((int64) numSamples, regionEnd - pos);
+        const int regionOffset = (int) (pos - region->start);
+
+        for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+        {
+            const int regionChannel = jmin(ch, region->samples.getNumChannels() - 1);
+            bufferToFill.buffer->copyFrom(ch, offset, region->samples, regionChannel, regionOffset, length);
+        }
+
+        //send the source on to where the region runs out, so it has the whole region's length to buffer
+        if (sourcePosition != regionEnd)
+        {
+            source->setNextReadPosition(regionEnd);
+            sourcePosition = regionEnd;
+        }
+
+        pos += length;
+        offset += length;
+        numSamples -= length;
+    }
+}
+
+CueSource::Region* CueSource::findRegion(int64 pos) const
+{
+    for (auto* region : regions)
+    {
+        if (region != nullptr && pos >= region->start && pos < region->start + region->samples.getNumSamples())
+        {
+            return region;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    CueSource.h
+    Created: 18 Oct 2026 1:36:52am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "HandOverFifo.h"
+
+//==============================================================================
+/*
+    Sits between a track's source and its transport, playing hot cues and loops
+    without asking the decoder to seek.
+
+    A background thread decodes a few seconds of audio around each hot cue and
+    loop into RAM regions, and the message thread hands them over. A jump that lands in a region is
+    played from it while the source is sent on to the region's end, so by the
+    time playback gets there the read-ahead has had seconds to catch up. Loops
+    wrap at their exact end sample, however many times that falls in a block.
+
+    Positions are in the source's samples. The audio thread swaps regions in
+    and out without allocating or freeing them.
+*/
+class CueSource : public PositionableAudioSource
+{
+public:
+    /** one for each hot cue, one for the loop and one where a scratch lets go */
+    static constexpr int maxRegions = 10;
+
+    struct Region
+    {
+        int64 start = 0;
+        AudioBuffer<float> samples;
+    };
+
+    /** takes ownership of source */
+    CueSource(PositionableAudioSource* source);
+    ~CueSource() override;
+
+    /** hands a decoded region to the audio thread, replacing whatever was in that
+        slot; nullptr empties it. False if the audio thread is too far behind (message thread) */
+    bool setRegion(int slot, std::unique_ptr<Region> region);
+    /** deletes regions the audio thread has finished with (message thread) */
+    void deleteRetiredRegions();
+
+    /** loops between start and end from the next block; end at or before start plays
+        straight through. A playhead already past the new end of a shrinking loop
+        wraps back into it (audio thread) */
+    void setLoop(int64 start, int64 end);
+    /** true while a loop is set, which keeps playback from ever reaching the end (audio thread) */
+    bool hasLoop() const;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(int64 newPosition) override;
+    int64 getNextReadPosition() const override;
+    int64 getTotalLength() const override;
+    bool isLooping() const override;
+
+private:
+    /** picks up handed over regions at the start of a block (audio thread) */
+    void takePendingRegions();
+    /** fills bufferToFill from pos on, without wrapping */
+    void readSegment(const AudioSourceChannelInfo& bufferToFill, int64 pos);
+    /** the region holding pos, or nullptr */
+    Region* findRegion(int64 pos) const;
+
+    std::unique_ptr<PositionableAudioSource> source;
+
+    std::atomic<int64> position{0};
+    // where the source will read from next, so a jump can be told from playing on
+    int64 sourcePosition = 0;
+
+    int64 loopStart = 0;
+    int64 loopEnd = 0;
+
+    // owned by the audio thread
+    Region* regions[maxRegions] = {};
+
+    // tagged with their slots
+    HandOverFifo<Region, 16> pendingRegions;
+    RetireFifo<Region, 32> retiredRegions;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CueSource)
+};
@@ -2,52 +2,275 @@
 
 #include "DJAudioPlayer.h"
 
-DJAudioPlayer::DJAudioPlayer(AudioFormatManager& _formatManager) 
-: formatManager(_formatManager)
+// the most a synced deck bends its tempo to catch up with the master's beat
+static const double maxPhaseCorrection = 0.04;
+// decoded into RAM after a hot cue or a loop's end: plenty of time for the read-ahead to refill behind it
+static const double regionSeconds = 3.0;
+// decoded before a cue as well, in case a seek in seconds lands a sample or two early
+static const int64 prerollSamples = 256;
+// the most one loop's region holds; the rest of a longer loop streams as usual
+static const double maxRegionSeconds = 40.0;
+// the shortest loop halving goes down to
+static const int64 minLoopSamples = 64;
+// a scratch plays from this much of the track either side of where it started, and asks for
+// the next window once it gets within the margin of an edge, which leaves time to decode it
+static const double scratchWindowSeconds = 6.0;
+static const double scratchMarginSeconds = 3.0;
+// auto gain never moves a track further than this, and only boosts it until its true peak reaches the headroom
+static const double maxAutoGainDecibels = 12.0;
+static const double autoGainHeadroom = -1.0;
+
+// each hot cue has a region in the CueSource, then the loop, then where the last scratch let go
+static const int scratchRegionSlot = DJAudioPlayer::numHotCues + 1;
+static_assert(CueSource::maxRegions == DJAudioPlayer::numHotCues + 2, "one region per hot cue, the loop and the scratch");
+// the regionDecoder slot for scratch windows, which don't go to the CueSource
+static const int scratchWindowSlot = CueSource::maxRegions;
+
+DJAudioPlayer::DJAudioPlayer(AudioFormatManager& _formatManager,
+                             ReadAheadPool& _readAheadPool,
+                             DecodedTrackCache& _decodedTrackCache,
+                             TrackAnalyser& _trackAnalyser,
+                             BeatSync& _beatSync,
+                             AudioRecorder& _recorder,
+                             int _deckIndex)
+: formatManager(_formatManager),
+  readAheadPool(_readAheadPool),
+  decodedTrackCache(_decodedTrackCache),
+  trackAnalyser(_trackAnalyser),
+  beatSync(_beatSync),
+  recorder(_recorder),
+  deckIndex(_deckIndex),
+  readAheadSize(_readAheadPool.getDefaultBufferSize()),
+  trackLoader(_formatManager, _readAheadPool, _decodedTrackCache),
+  regionDecoder(_formatManager)
 {
+    trackLoader.addChangeListener(this);
+    regionDecoder.addChangeListener(this);
+    decodedTrackCache.addChangeListener(this);
+    trackAnalyser.addChangeListener(this);
 
+    std::fill(std::begin(hotCues), std::end(hotCues), -1);
 }
 DJAudioPlayer::~DJAudioPlayer()
 {
+    trackLoader.removeChangeListener(this);
+    regionDecoder.removeChangeListener(this);
+    decodedTrackCache.removeChangeListener(this);
+    trackAnalyser.removeChangeListener(this);
+    stopTimer();
 
+    //the audio device has been shut down by now, so every track is back in our hands
+    delete pendingTrack.exchange(nullptr);
+    delete activeTrack;
+    delete nextTrack;
+    delete outgoingTrack;
+    deleteRetiredTracks();
 }
 
-void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate) 
+void DJAudioPlayer::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
-    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    //tracks decoded from here on are converted to this rate up front
+    decodedTrackCache.setSampleRate(sampleRate);
+
+    //short enough to feel instant, long enough not to zipper
+    gainRamp.reset(sampleRate, 0.02);
+    speedRamp.reset(sampleRate, 0.05);
+    fade.reset(sampleRate, 0.005);
+    scratchMix.reset(sampleRate, 0.01);
+    scratcher.prepare(sampleRate);
+    scratchBuffer.setSize(2, jmax(1, samplesPerBlockExpected));
+    advanceBuffer.setSize(2, jmax(1, samplesPerBlockExpected));
+    eq.prepare(samplesPerBlockExpected, sampleRate, 2);
+    meter.prepare(samplesPerBlockExpected, sampleRate);
+
+    //every deck is prepared at the same time, which starts the shared sample clock
+    deviceSampleRate = sampleRate;
+    samplesRendered = 0;
+    blocksRendered = 0;
+    beatSync.reset(deckIndex);
+
     resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
 }
 void DJAudioPlayer::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
-    resampleSource.getNextAudioBlock(bufferToFill);
+{
+    takePendingTrack();
+    commandQueue.drain([this] (const DeckCommand& command) { handleCommand(command); });
+
+    double speedRatio = speedRamp.isSmoothing() ? speedRamp.skip(bufferToFill.numSamples)
+                                                : speedRamp.getCurrentValue();
+
+    //a few atomics and some arithmetic per block, whatever the decks are doing
+    double beat = 0;
+    const bool hasBeat = getBeatPosition(beat);
+    if (syncActive && hasBeat)
+    {
+        speedRatio = followMaster(beat, speedRatio, bufferToFill.numSamples);
+    }
+
+    //the resampler ramps across the block to the new speed, so corrections land sample by sample
+    if (speedRatio != appliedSpeed)
+    {
+        applySpeed(speedRatio);
+    }
+    publishBeatClock(hasBeat, beat, speedRatio);
+
+    {
+        CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::resample);
+
+        //the chain stands still while only the scratch is heard
+        if (scratchMix.getCurrentValue() < 1.0f || scratchMix.isSmoothing())
+        {
+            resampleSource.getNextAudioBlock(bufferToFill);
+        }
+        if (scratchMix.getCurrentValue() > 0.0f || scratchMix.isSmoothing())
+        {
+            renderScratch(bufferToFill);
+        }
+    }
+    {
+        CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::eq);
+        eq.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+    //the deck's own recording is taken before its fader
+    recorder.pushDeck(deckIndex, *bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+
+    if (gainRamp.isSmoothing())
+    {
+        const float startGain = gainRamp.getCurrentValue();
+        bufferToFill.buffer->applyGainRamp(bufferToFill.startSample, bufferToFill.numSamples,
+                                           startGain, gainRamp.skip(bufferToFill.numSamples));
+    }
+    else
+    {
+        bufferToFill.buffer->applyGain(bufferToFill.startSample, bufferToFill.numSamples, gainRamp.getTargetValue());
+    }
+    meter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
 
+    samplesRendered += bufferToFill.numSamples;
+    ++blocksRendered;
+    publishPlayhead();
 }
 void DJAudioPlayer::releaseResources()
 {
-    transportSource.releaseResources();
     resampleSource.releaseResources();
+    beatSync.reset(deckIndex);
 }
 
 void DJAudioPlayer::loadURL(URL audioURL)
 {
-    auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
-    if (reader != nullptr) // good file!
-    {       
-        std::unique_ptr<AudioFormatReaderSource> newSource (new AudioFormatReaderSource (reader, 
-true)); 
-        transportSource.setSource (newSource.get(), 0, nullptr, reader->sampleRate);             
-        readerSource.reset (newSource.release());          
+    takeAdvance();
+    deleteRetiredTracks();
+
+    //a freshly loaded track waits for PLAY, as it did when the transport swapped sources
+    playRequested = false;
+    requestedURL = audioURL;
+    sendCommand(DeckCommand::Type::stop);
+
+    stopScratch();
+    clearCuesAndLoop();
+
+    //a preloaded track comes back straight away, anything else arrives via changeListenerCallback
+    auto track = trackLoader.load(audioURL, readAheadSize);
+    if (track != nullptr)
+    {
+        swapInTrack(std::move(track));
+    }
+}
+
+void DJAudioPlayer::preloadURL(URL audioURL)
+{
+    trackLoader.preload(audioURL, readAheadSize);
+}
+
+void DJAudioPlayer::queueNext(URL audioURL)
+{
+    if (audioURL != nextURL)
+    {
+        nextURL = audioURL;
+
+        //what the audio thread is holding was queued for a list that has since changed
+        if (handedOverNext != nullptr && handOverNext(nullptr))
+        {
+            handedOverNext = nullptr;
+        }
+    }
+    handOverNextTrack();
+}
+
+bool DJAudioPlayer::isLoading()
+{
+    return trackLoader.isLoading();
+}
+
+void DJAudioPlayer::setOfflineRendering(bool shouldBeOffline)
+{
+    trackLoader.setOffline(shouldBeOffline);
+    regionDecoder.setOffline(shouldBeOffline);
+}
+
+bool DJAudioPlayer::waitForLoad(int timeoutMs)
+{
+    const auto giveUpTime = Time::getMillisecondCounter() + (uint32) timeoutMs;
+
+    while (trackLoader.isLoading())
+    {
+        auto track = trackLoader.takeLoadedTrack();
+        if (track != nullptr)
+        {
+            swapInTrack(std::move(track));
+            return true;
+        }
+
+        if (Time::getMillisecondCounter() > giveUpTime)
+        {
+            return false;
+        }
+        Thread::sleep(1);
+    }
+
+    //a preloaded track was swapped in by loadURL itself, anything else failed to open
+    return currentTrack != nullptr && currentTrack->url == requestedURL;
+}
+
+void DJAudioPlayer::changeListenerCallback (ChangeBroadcaster* source)
+{
+    if (source == &decodedTrackCache)
+    {
+        fetchBeatgrid();
+        return;
+    }
+    if (source == &regionDecoder)
+    {
+        takeDecodedRegions();
+        return;
+    }
+    if (source == &trackAnalyser)
+    {
+        if (! playRequested)
+        {
+            fetchLoudness();
+        }
+        return;
+    }
+
+    auto track = trackLoader.takeLoadedTrack();
+    if (track != nullptr)
+    {
+        swapInTrack(std::move(track));
     }
 }
-void DJAudioPlayer::setGain(double gain)
+
+void DJAudioPlayer::setGain(double _gain)
 {
-    if (gain < 0 || gain > 1.0)
+    if (_gain < 0 || _gain > 1.0)
     {
         std::cout << "DJAudioPlayer::setGain gain should be between 0 and 1" << std::endl;
     }
     else {
-        transportSource.setGain(gain);
+        gain = _gain;
+        updateGain();
     }
-   
+
 }
 void DJAudioPlayer::setSpeed(double ratio)
 {
@@ -56,38 +279,1473 @@ void DJAudioPlayer::setSpeed(double ratio)
         std::cout << "DJAudioPlayer::setSpeed ratio should be between 0 and 100" << std::endl;
     }
     else {
-        resampleSource.setResamplingRatio(ratio);
+        commandQueue.setLatest(DeckCommand::Type::setSpeed, ratio);
+    }
+}
+
+void DJAudioPlayer::setKeyLock(bool shouldBeOn)
+{
+    if (sendCommand(DeckCommand::Type::setKeyLock, shouldBeOn ? 1.0 : 0.0))
+    {
+        keyLock = shouldBeOn;
+    }
+}
+
+bool DJAudioPlayer::isKeyLockOn()
+{
+    return keyLock;
+}
+
+void DJAudioPlayer::setResamplingQuality(VarispeedResampler::Quality quality)
+{
+    if (sendCommand(DeckCommand::Type::setResamplingQuality, (double) quality))
+    {
+        resamplingQuality = quality;
     }
 }
 
+VarispeedResampler::Quality DJAudioPlayer::getResamplingQuality()
+{
+    return resamplingQuality;
+}
+
 void DJAudioPlayer::setPositionRelative(double pos)
 {
      if (pos < 0 || pos > 1.0)
     {
         std::cout << "DJAudioPlayer::setPositionRelative pos should be between 0 and 1" << std::endl;
     }
-    else {
-        double posInSecs = transportSource.getLengthInSeconds() * pos;
+    else if (currentTrack != nullptr) {
+        double posInSecs = currentTrack->transportSource.getLengthInSeconds() * pos;
         setPosition(posInSecs);
     }
 }
 
+void DJAudioPlayer::setEqBand(DeckEQ::Band band, double decibels)
+{
+    if (decibels < DeckEQ::killDecibels || decibels > DeckEQ::maxBoostDecibels)
+    {
+        std::cout << "DJAudioPlayer::setEqBand decibels should be between " << DeckEQ::killDecibels
+                  << " and " << DeckEQ::maxBoostDecibels << std::endl;
+        return;
+    }
+
+    const auto type = band == DeckEQ::Band::low ? DeckCommand::Type::setLowGain
+                    : band == DeckEQ::Band::mid ? DeckCommand::Type::setMidGain
+                                                : DeckCommand::Type::setHighGain;
+    commandQueue.setLatest(type, DeckEQ::decibelsToBandGain(decibels));
+}
+
+void DJAudioPlayer::setFilter(double amount)
+{
+    if (amount < -1.0 || amount > 1.0)
+    {
+        std::cout << "DJAudioPlayer::setFilter amount should be between -1 and 1" << std::endl;
+    }
+    else {
+        commandQueue.setLatest(DeckCommand::Type::setFilter, amount);
+    }
+}
+
 void DJAudioPlayer::setPosition(double posInSecs)
 {
-    transportSource.setPosition(posInSecs);
+    sendCommand(DeckCommand::Type::setPosition, posInSecs);
+}
+
+void DJAudioPlayer::setHotCue(int index)
+{
+    if (! isPositiveAndBelow(index, numHotCues))
+    {
+        std::cout << "DJAudioPlayer::setHotCue index should be between 0 and " << numHotCues - 1 << std::endl;
+        return;
+    }
+    if (currentTrack == nullptr || trackLoader.isLoading())
+    {
+        std::cout << "DJAudioPlayer::setHotCue no track loaded" << std::endl;
+        return;
+    }
+
+    if (isHotCuePending(index))
+    {
+        return;
+    }
+
+    //the cue is set when its region arrives in takeDecodedRegions
+    const auto cue = getPlayheadSample();
+    const auto start = jmax((int64) 0, cue - prerollSamples);
+    pendingHotCues[index] = cue;
+    requestRegion(index, start, cue - start + (int64) (regionSeconds * currentTrack->sourceSampleRate), hotCueRequests[index]);
+}
+
+void DJAudioPlayer::triggerHotCue(int index)
+{
+    if (! hasHotCue(index) || currentTrack == nullptr)
+    {
+        return;
+    }
+
+    //half a sample in, so the transport's conversion back to samples lands on the cue itself
+    setPosition((hotCues[index] + 0.5) / currentTrack->sourceSampleRate);
+}
+
+void DJAudioPlayer::clearHotCue(int index)
+{
+    if (! hasHotCue(index) && ! isHotCuePending(index))
+    {
+        return;
+    }
+
+    //a region still on its way is dropped when it arrives
+    hotCueRequests[index] = 0;
+    hotCues[index] = -1;
+    if (currentTrack != nullptr)
+    {
+        currentTrack->cueSource->setRegion(index, nullptr);
+    }
+}
+
+bool DJAudioPlayer::hasHotCue(int index)
+{
+    return isPositiveAndBelow(index, numHotCues) && hotCues[index] >= 0;
+}
+
+bool DJAudioPlayer::isHotCuePending(int index)
+{
+    return isPositiveAndBelow(index, numHotCues) && hotCueRequests[index] != 0;
+}
+
+void DJAudioPlayer::setLoopIn()
+{
+    if (currentTrack == nullptr || trackLoader.isLoading())
+    {
+        std::cout << "DJAudioPlayer::setLoopIn no track loaded" << std::endl;
+        return;
+    }
+
+    loopInSample = snapToBeatgrid(getPlayheadSample());
+
+    //moves the start of a loop that's playing, or ends it if the new start is past its end
+    if (looping)
+    {
+        updateLoop();
+    }
+}
+
+void DJAudioPlayer::setLoopOut()
+{
+    if (currentTrack == nullptr || loopInSample < 0)
+    {
+        std::cout << "DJAudioPlayer::setLoopOut set the loop in point first" << std::endl;
+        return;
+    }
+
+    const auto out = snapToBeatgrid(getPlayheadSample());
+    if (out - loopInSample < minLoopSamples)
+    {
+        std::cout << "DJAudioPlayer::setLoopOut loop out should be after loop in" << std::endl;
+        return;
+    }
+
+    loopOutSample = out;
+    looping = true;
+    updateLoop();
+}
+
+void DJAudioPlayer::setBeatLoop(double beats)
+{
+    if (beats < minLoopBeats || beats > maxLoopBeats)
+    {
+        std::cout << "DJAudioPlayer::setBeatLoop beats should be between " << minLoopBeats << " and " << maxLoopBeats << std::endl;
+        return;
+    }
+    if (currentTrack == nullptr || trackLoader.isLoading() || ! currentTrack->getBeatgrid().isValid())
+    {
+        std::cout << "DJAudioPlayer::setBeatLoop the track has no beatgrid yet" << std::endl;
+        return;
+    }
+
+    //the end is worked out from the grid rather than by adding a rounded length, so it sits on the beat too
+    const auto grid = currentTrack->getBeatgrid();
+    const double sampleRate = currentTrack->sourceSampleRate;
+    loopInSample = snapToBeatgrid(getPlayheadSample());
+    loopOutSample = (int64) std::llround(grid.getTimeOfBeat(grid.getBeatAt(loopInSample / sampleRate) + beats) * sampleRate);
+    looping = true;
+    updateLoop();
+}
+
+void DJAudioPlayer::halveLoop()
+{
+    if (! looping || (loopOutSample - loopInSample) / 2 < minLoopSamples)
+    {
+        return;
+    }
+
+    loopOutSample = loopInSample + (loopOutSample - loopInSample) / 2;
+    updateLoop();
+}
+
+void DJAudioPlayer::doubleLoop()
+{
+    if (! looping || currentTrack == nullptr)
+    {
+        return;
+    }
+
+    const auto length = loopOutSample - loopInSample;
+    if (loopOutSample + length > currentTrack->source->getTotalLength())
+    {
+        std::cout << "DJAudioPlayer::doubleLoop the loop would run past the end of the track" << std::endl;
+        return;
+    }
+
+    loopOutSample += length;
+    updateLoop();
+}
+
+void DJAudioPlayer::exitLoop()
+{
+    looping = false;
+    updateLoop();
+}
+
+bool DJAudioPlayer::isLooping()
+{
+    return looping;
+}
+
+bool DJAudioPlayer::isLoopPending()
+{
+    return looping && loopRequest != 0;
+}
+
+void DJAudioPlayer::startScratch()
+{
+    if (scratchRequested)
+    {
+        return;
+    }
+    if (currentTrack == nullptr || trackLoader.isLoading())
+    {
+        std::cout << "DJAudioPlayer::startScratch no track loaded" << std::endl;
+        return;
+    }
+
+    //the whole scratch plays from RAM, so the decoder is never asked to seek back and forth.
+    //It takes hold when the first window arrives in takeDecodedRegions
+    scratchRequested = true;
+    scratchStarted = false;
+    scratchRate = 0;
+    if (! requestScratchWindow(getPlayheadSample()))
+    {
+        scratchRequested = false;
+    }
+}
+
+void DJAudioPlayer::setScratchRate(double rate)
+{
+    if (! scratchRequested)
+    {
+        return;
+    }
+
+    //until the scratch takes hold, the rate goes along with its start
+    scratchRate = jlimit(-maxScratchRate, maxScratchRate, rate);
+    if (! scratchStarted)
+    {
+        return;
+    }
+    commandQueue.setLatest(DeckCommand::Type::setScratchRate, scratchRate);
+
+    //ask for the next window before the scratch runs off this one's edge; the scratch carries on
+    //from this one until it's ready. A position outside it is still the last scratch's, from
+    //before the audio thread picked this one up
+    const auto position = (int64) scratcher.getPosition();
+    const auto margin = (int64) (scratchMarginSeconds * currentTrack->sourceSampleRate);
+    if (scratchWindowRequest != 0 || position < scratchWindowStart || position > scratchWindowEnd)
+    {
+        return;
+    }
+    if ((scratchWindowStart > 0 && position - scratchWindowStart < margin)
+        || (scratchWindowEnd < currentTrack->source->getTotalLength() && scratchWindowEnd - position < margin))
+    {
+        requestScratchWindow(position);
+    }
+}
+
+void DJAudioPlayer::stopScratch()
+{
+    if (! scratchRequested)
+    {
+        return;
+    }
+    scratchRequested = false;
+    //a window still on its way is dropped when it arrives
+    scratchWindowRequest = 0;
+    if (! scratchStarted)
+    {
+        return;
+    }
+    scratchStarted = false;
+
+    //the window's samples become a region where the scratch lets go, so the deck carries on
+    //from RAM while its source catches up
+    if (scratchRegion != nullptr && currentTrack != nullptr)
+    {
+        currentTrack->cueSource->setRegion(scratchRegionSlot, std::move(scratchRegion));
+    }
+    scratchRegion = nullptr;
+
+    sendCommand(DeckCommand::Type::stopScratch);
+}
+
+bool DJAudioPlayer::isScratching()
+{
+    return scratchRequested;
+}
+
+void DJAudioPlayer::setSync(bool shouldBeOn)
+{
+    if (sendCommand(DeckCommand::Type::setSync, shouldBeOn ? 1.0 : 0.0))
+    {
+        sync = shouldBeOn;
+    }
+}
+
+bool DJAudioPlayer::isSyncOn()
+{
+    return sync;
+}
+
+void DJAudioPlayer::makeSyncMaster()
+{
+    beatSync.setMasterDeck(deckIndex);
+}
+
+bool DJAudioPlayer::isSyncMaster()
+{
+    return beatSync.getMasterDeck() == deckIndex;
+}
+
+Beatgrid DJAudioPlayer::getBeatgrid()
+{
+    if (currentTrack == nullptr)
+    {
+        return {};
+    }
+    return currentTrack->getBeatgrid();
+}
+
+double DJAudioPlayer::getTempo()
+{
+    return tempo;
 }
 
 
 void DJAudioPlayer::start()
 {
-    transportSource.start();
+    //while a load is in flight the new track starts when it is swapped in
+    if (trackLoader.isLoading() || sendCommand(DeckCommand::Type::play))
+    {
+        playRequested = true;
+    }
 }
 void DJAudioPlayer::stop()
 {
-  transportSource.stop();
+    if (sendCommand(DeckCommand::Type::stop))
+    {
+        playRequested = false;
+    }
 }
 
 double DJAudioPlayer::getPositionRelative()
 {
-    return transportSource.getCurrentPosition() / transportSource.getLengthInSeconds();
+    if (currentTrack == nullptr)
+    {
+        return 0;
+    }
+    //the transport stands still while the scratch moves
+    if (scratchStarted)
+    {
+        return scratcher.getPosition() / jmax((int64) 1, currentTrack->source->getTotalLength());
+    }
+    return currentTrack->transportSource.getCurrentPosition() / currentTrack->transportSource.getLengthInSeconds();
+}
+
+double DJAudioPlayer::PlayheadSnapshot::getSecondsAt(double now) const
+{
+    const double elapsed = jlimit(0.0, maxExtrapolation, (now - timestamp) / 1000.0);
+    return jlimit(0.0, jmax(0.0, lengthInSeconds), seconds + rate * elapsed);
+}
+
+bool DJAudioPlayer::getPlayheadSnapshot(PlayheadSnapshot& snapshot) const
+{
+    //the same handful of stores as a beat clock, so a few tries are plenty
+    for (int attempt = 0; attempt < 4; ++attempt)
+    {
+        const auto before = playheadSequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0)
+        {
+            continue;
+        }
+
+        snapshot.seconds = playheadSeconds.load(std::memory_order_relaxed);
+        snapshot.rate = playheadRate.load(std::memory_order_relaxed);
+        snapshot.timestamp = playheadTimestamp.load(std::memory_order_relaxed);
+        snapshot.lengthInSeconds = playheadLength.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (playheadSequence.load(std::memory_order_relaxed) == before)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DJAudioPlayer::setReadAheadSize(int numSamples)
+{
+    if (numSamples < 1024)
+    {
+        std::cout << "DJAudioPlayer::setReadAheadSize buffer should be at least 1024 samples" << std::endl;
+    }
+    else {
+        readAheadSize = numSamples;
+    }
+}
+
+ReadAheadSource::Stats DJAudioPlayer::getReadAheadStats()
+{
+    //tracks playing from RAM have no read-ahead buffer to run dry
+    if (currentTrack == nullptr || currentTrack->readAheadSource == nullptr)
+    {
+        return {};
+    }
+    return currentTrack->readAheadSource->getStats();
+}
+
+LevelMeter& DJAudioPlayer::getMeter()
+{
+    return meter;
+}
+
+void DJAudioPlayer::setAutoGain(bool shouldBeOn)
+{
+    autoGain = shouldBeOn;
+    updateGain();
+}
+
+bool DJAudioPlayer::isAutoGainOn()
+{
+    return autoGain;
+}
+
+void DJAudioPlayer::setTargetLoudness(double lufs)
+{
+    if (lufs < LevelMeter::minimumLoudness || lufs > 0)
+    {
+        std::cout << "DJAudioPlayer::setTargetLoudness lufs should be between " << LevelMeter::minimumLoudness << " and 0" << std::endl;
+        return;
+    }
+    targetLoudness = lufs;
+    updateGain();
+}
+
+double DJAudioPlayer::getTargetLoudness()
+{
+    return targetLoudness;
+}
+
+double DJAudioPlayer::getAutoGainDecibels()
+{
+    return autoGainDecibels;
+}
+
+void DJAudioPlayer::setAutoAdvance(bool shouldBeOn)
+{
+    if (! sendCommand(DeckCommand::Type::setAutoAdvance, shouldBeOn ? 1.0 : 0.0))
+    {
+        return;
+    }
+    autoAdvance = shouldBeOn;
+
+    if (autoAdvance)
+    {
+        //a few times a second is plenty to notice an advance and hand the next track over
+        startTimerHz(10);
+        handOverNextTrack();
+        return;
+    }
+
+    stopTimer();
+    takeAdvance();
+
+    //NEXT goes back to loading the queued track, so the audio thread can let go of its copy
+    if (handedOverNext != nullptr && handOverNext(nullptr))
+    {
+        handedOverNext = nullptr;
+    }
+    deleteRetiredTracks();
+}
+
+bool DJAudioPlayer::isAutoAdvanceOn()
+{
+    return autoAdvance;
+}
+
+void DJAudioPlayer::setAdvanceCrossfade(double seconds)
+{
+    if (seconds < 0 || seconds > maxAdvanceCrossfade)
+    {
+        std::cout << "DJAudioPlayer::setAdvanceCrossfade seconds should be between 0 and " << maxAdvanceCrossfade << std::endl;
+        return;
+    }
+    if (sendCommand(DeckCommand::Type::setAdvanceCrossfade, seconds))
+    {
+        advanceCrossfade = seconds;
+    }
+}
+
+double DJAudioPlayer::getAdvanceCrossfade()
+{
+    return advanceCrossfade;
+}
+
+bool DJAudioPlayer::skipToNext()
+{
+    if (! autoAdvance || handedOverNext == nullptr || handedOverNext->url != nextURL)
+    {
+        return false;
+    }
+    return sendCommand(DeckCommand::Type::advance);
+}
+
+int DJAudioPlayer::getNumAdvances()
+{
+    return numAdvances;
+}
+
+URL DJAudioPlayer::getURL()
+{
+    return requestedURL;
+}
+
+void DJAudioPlayer::timerCallback()
+{
+    takeAdvance();
+    deleteRetiredTracks();
+    handOverNextTrack();
+}
+
+//==============================================================================
+bool DJAudioPlayer::sendCommand(DeckCommand::Type type, double value, double value2)
+{
+    if (! commandQueue.push(type, value, value2))
+    {
+        std::cout << "DJAudioPlayer::sendCommand the audio thread has fallen behind, command " << (int) type
+                  << " was dropped" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DJAudioPlayer::handleCommand(const DeckCommand& command)
+{
+    switch (command.type)
+    {
+        case DeckCommand::Type::setGain:
+            gainRamp.setTargetValue((float) command.value);
+            break;
+
+        case DeckCommand::Type::setSpeed:
+            speedRamp.setTargetValue(command.value);
+            break;
+
+        case DeckCommand::Type::setKeyLock:
+            keyLockActive = command.value != 0;
+            timeStretcher.setKeyLock(keyLockActive);
+            applySpeed(appliedSpeed);
+            break;
+
+        case DeckCommand::Type::setResamplingQuality:
+            resampleSource.setQuality((VarispeedResampler::Quality) (int) command.value);
+            break;
+
+        case DeckCommand::Type::setPosition:
+            pendingSeek = command.value;
+            break;
+
+        case DeckCommand::Type::setSync:
+            syncActive = command.value != 0;
+            syncJustEngaged = syncActive;
+
+            if (! syncActive)
+            {
+                //glide from the synced tempo back to the speed setting
+                const auto speedSetting = speedRamp.getTargetValue();
+                speedRamp.setCurrentAndTargetValue(appliedSpeed);
+                speedRamp.setTargetValue(speedSetting);
+            }
+            break;
+
+        case DeckCommand::Type::setLowGain:
+            eq.setBandGain(DeckEQ::Band::low, (float) command.value);
+            break;
+
+        case DeckCommand::Type::setMidGain:
+            eq.setBandGain(DeckEQ::Band::mid, (float) command.value);
+            break;
+
+        case DeckCommand::Type::setHighGain:
+            eq.setBandGain(DeckEQ::Band::high, (float) command.value);
+            break;
+
+        case DeckCommand::Type::setFilter:
+            eq.setFilter((float) command.value);
+            break;
+
+        case DeckCommand::Type::setLoop:
+            if (activeTrack != nullptr)
+            {
+                activeTrack->cueSource->setLoop((int64) command.value, (int64) command.value2);
+            }
+            break;
+
+        case DeckCommand::Type::startScratch:
+            if (activeTrack != nullptr)
+            {
+                //taking hold of a moving record starts at the speed it was going
+                const double ratio = activeTrack->sourceSampleRate / deviceSampleRate;
+                scratcher.start((double) activeTrack->cueSource->getNextReadPosition(), playing ? appliedSpeed * ratio : 0.0,
+                                activeTrack->cueSource->getTotalLength());
+                scratching = true;
+                scratchSpeed = playing ? appliedSpeed : 0.0;
+                scratchMix.setTargetValue(1.0f);
+
+                //the rate set for this scratch may be the same as the last one's
+                commandQueue.resendLatest(DeckCommand::Type::setScratchRate);
+            }
+            break;
+
+        case DeckCommand::Type::setScratchRate:
+            //a rate left over from a scratch that has let go waits for the next one to start
+            if (scratching && activeTrack != nullptr)
+            {
+                scratcher.setRate(command.value * activeTrack->sourceSampleRate / deviceSampleRate);
+                scratchSpeed = command.value;
+            }
+            break;
+
+        case DeckCommand::Type::stopScratch:
+            if (scratching && activeTrack != nullptr)
+            {
+                //the chain jumps to where the scratch let go straight away, and fades in under it
+                scratching = false;
+                scratchMix.setTargetValue(0.0f);
+                pendingSeek = scratcher.getPosition() / activeTrack->sourceSampleRate;
+                fade.setCurrentAndTargetValue(0.0f);
+            }
+            break;
+
+        case DeckCommand::Type::setAutoAdvance:
+            autoAdvanceActive = command.value != 0;
+            break;
+
+        case DeckCommand::Type::setAdvanceCrossfade:
+            advanceCrossfadeSeconds = command.value;
+            break;
+
+        case DeckCommand::Type::advance:
+            advanceRequested = nextTrack != nullptr;
+            break;
+
+        case DeckCommand::Type::play:
+            //a deck starting in sync drops straight onto the beat
+            playing = true;
+            syncJustEngaged = syncActive;
+            break;
+
+        case DeckCommand::Type::stop:
+            playing = false;
+            break;
+    }
+    updateFadeTarget();
+}
+
+void DJAudioPlayer::applySpeed(double speedRatio)
+{
+    appliedSpeed = speedRatio;
+
+    if (keyLockActive)
+    {
+        //the stretcher changes the tempo, so the resampler must leave the pitch alone
+        timeStretcher.setStretchRatio(speedRatio);
+        resampleSource.setResamplingRatio(1.0);
+    }
+    else
+    {
+        timeStretcher.setStretchRatio(1.0);
+        resampleSource.setResamplingRatio(speedRatio);
+    }
+}
+
+void DJAudioPlayer::updateFadeTarget()
+{
+    fade.setTargetValue(playing && pendingSeek < 0 ? 1.0f : 0.0f);
+}
+
+bool DJAudioPlayer::getBeatPosition(double& beat)
+{
+    if (activeTrack == nullptr)
+    {
+        return false;
+    }
+
+    const auto grid = activeTrack->getBeatgrid();
+    if (! grid.isValid())
+    {
+        return false;
+    }
+
+    //the transport runs ahead of what's heard by whatever the key lock has buffered
+    const double heard = activeTrack->transportSource.getCurrentPosition()
+                       - timeStretcher.getLatencySamples() / deviceSampleRate;
+    beat = grid.getBeatAt(heard);
+    return true;
+}
+
+double DJAudioPlayer::followMaster(double beat, double knobSpeed, int numSamples)
+{
+    const int master = beatSync.getMasterDeck();
+    if (master == deckIndex)
+    {
+        return knobSpeed;
+    }
+
+    //nothing to follow: hold the tempo sync last gave us. The master's line from the block before
+    //is finished whichever deck renders first, so every follower gets the same one
+    BeatClock masterClock;
+    if (! playing || ! beatSync.read(master, blocksRendered - 1, masterClock) || masterClock.beatsPerSample <= 0)
+    {
+        return appliedSpeed;
+    }
+
+    const double bpm = activeTrack->getBeatgrid().bpm;
+    double tempoRatio = masterClock.beatsPerSample * deviceSampleRate * 60.0 / bpm;
+
+    //a track at half or double the master's tempo locks onto every other beat
+    double beatsPerMasterBeat = 1.0;
+    if (tempoRatio > MathConstants<double>::sqrt2)
+    {
+        beatsPerMasterBeat = 0.5;
+        tempoRatio *= 0.5;
+    }
+    else if (tempoRatio < 1.0 / MathConstants<double>::sqrt2)
+    {
+        beatsPerMasterBeat = 2.0;
+        tempoRatio *= 2.0;
+    }
+
+    if (pendingSeek >= 0)
+    {
+        return tempoRatio;
+    }
+
+    //phase error in beats, to the nearest beat either way
+    double error = masterClock.getBeatAt(samplesRendered) * beatsPerMasterBeat - beat;
+    error -= std::round(error);
+
+    if (syncJustEngaged)
+    {
+        syncJustEngaged = false;
+
+        //more than a few milliseconds out: jump onto the beat behind the seek fade instead of drifting there.
+        //the seek happens a block from now, by when the track will have moved on a block's worth
+        if (std::abs(error) > 0.02)
+        {
+            const double seekFrom = activeTrack->transportSource.getCurrentPosition()
+                                  + numSamples / deviceSampleRate * tempoRatio;
+            pendingSeek = jmax(0.0, seekFrom + error * 60.0 / bpm);
+            updateFadeTarget();
+            return tempoRatio;
+        }
+    }
+
+    //win back half the error every beat, without bending the tempo audibly
+    return tempoRatio * (1.0 + jlimit(-maxPhaseCorrection, maxPhaseCorrection, 0.5 * error));
+}
+
+void DJAudioPlayer::publishBeatClock(bool hasBeat, double beat, double speedRatio)
+{
+    const double bpm = hasBeat ? activeTrack->getBeatgrid().bpm : 0.0;
+    tempo = bpm * speedRatio;
+
+    if (! hasBeat || ! playing || pendingSeek >= 0)
+    {
+        beatSync.clear(deckIndex, blocksRendered);
+        return;
+    }
+    beatSync.publish(deckIndex, blocksRendered, { samplesRendered, beat, speedRatio * bpm / 60.0 / deviceSampleRate });
+}
+
+void DJAudioPlayer::publishPlayhead()
+{
+    double seconds = 0, rate = 0, length = 0;
+    if (activeTrack != nullptr)
+    {
+        length = activeTrack->transportSource.getLengthInSeconds();
+        if (scratching)
+        {
+            seconds = scratcher.getPosition() / activeTrack->sourceSampleRate;
+            rate = scratchSpeed;
+        }
+        else if (pendingSeek >= 0)
+        {
+            //the seek lands next block, so the GUI may as well be there already
+            seconds = pendingSeek;
+        }
+        else
+        {
+            seconds = activeTrack->transportSource.getCurrentPosition();
+            rate = playing ? appliedSpeed : 0.0;
+        }
+    }
+
+    //only the audio thread writes, so the counter needs no read-modify-write
+    const auto sequence = playheadSequence.load(std::memory_order_relaxed);
+    playheadSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    playheadSeconds.store(seconds, std::memory_order_relaxed);
+    playheadRate.store(rate, std::memory_order_relaxed);
+    playheadTimestamp.store(Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+    playheadLength.store(length, std::memory_order_relaxed);
+
+    playheadSequence.store(sequence + 2, std::memory_order_release);
+}
+
+void DJAudioPlayer::fetchBeatgrid()
+{
+    //only a streamed track is missing its grid, and only until its background decode finishes
+    if (currentTrack == nullptr || currentTrack->getBeatgrid().isValid() || ! currentTrack->url.isLocalFile())
+    {
+        return;
+    }
+
+    auto grid = decodedTrackCache.getBeatgrid(currentTrack->url.getLocalFile());
+    if (grid.isValid())
+    {
+        currentTrack->setBeatgrid(grid);
+    }
+}
+
+void DJAudioPlayer::fetchLoudness()
+{
+    if (currentTrack == nullptr || loudnessKnown || ! currentTrack->url.isLocalFile())
+    {
+        return;
+    }
+
+    //measured in the background when the track was added to the library, so loading never decodes it again
+    TrackAnalyser::Result result;
+    if (trackAnalyser.getResult(currentTrack->url.getLocalFile(), result) && result.hasLoudness)
+    {
+        loudnessKnown = true;
+        trackLoudness = result.loudness;
+        trackTruePeak = result.truePeak;
+        if (result.soundEnd > result.soundStart)
+        {
+            currentTrack->soundEnd = (int64) (result.soundEnd * currentTrack->sourceSampleRate);
+        }
+        updateGain();
+    }
+}
+
+void DJAudioPlayer::updateGain()
+{
+    autoGainDecibels = autoGain && loudnessKnown ? calculateAutoGain(trackLoudness, trackTruePeak) : 0.0;
+
+    if (currentTrack != nullptr)
+    {
+        currentTrack->autoGain = (float) Decibels::decibelsToGain(autoGainDecibels);
+    }
+    commandQueue.setLatest(DeckCommand::Type::setGain, gain * Decibels::decibelsToGain(autoGainDecibels));
+}
+
+double DJAudioPlayer::calculateAutoGain(float loudness, float truePeak)
+{
+    //a silent track is left alone rather than boosted as far as it will go
+    if (loudness <= LevelMeter::minimumLoudness)
+    {
+        return 0;
+    }
+
+    double decibels = targetLoudness - loudness;
+    if (decibels > 0)
+    {
+        decibels = jmin(decibels, jmax(0.0, autoGainHeadroom - truePeak));
+    }
+    return jlimit(-maxAutoGainDecibels, maxAutoGainDecibels, decibels);
+}
+
+void DJAudioPlayer::clearCuesAndLoop()
+{
+    std::fill(std::begin(hotCues), std::end(hotCues), -1);
+    loopInSample = -1;
+    loopOutSample = -1;
+    looping = false;
+    loopRegionStart = loopRegionEnd = 0;
+
+    //regions still being decoded belong to the old track
+    std::fill(std::begin(hotCueRequests), std::end(hotCueRequests), 0);
+    loopRequest = 0;
+    regionDecoder.cancelAll();
+}
+
+int64 DJAudioPlayer::getPlayheadSample()
+{
+    return currentTrack->cueSource->getNextReadPosition();
+}
+
+int64 DJAudioPlayer::snapToBeatgrid(int64 sample)
+{
+    const auto grid = currentTrack->getBeatgrid();
+    if (! grid.isValid())
+    {
+        return sample;
+    }
+
+    const double sampleRate = currentTrack->sourceSampleRate;
+    const double eighths = std::round(grid.getBeatAt(sample / sampleRate) * 8.0);
+    return jmax((int64) 0, (int64) std::llround(grid.getTimeOfBeat(eighths / 8.0) * sampleRate));
+}
+
+bool DJAudioPlayer::requestRegion(int slot, int64 start, int64 numSamples, uint32& request, bool makeScratchWindow)
+{
+    numSamples = jmin(numSamples, currentTrack->source->getTotalLength() - start);
+    if (numSamples <= 0)
+    {
+        request = 0;
+        return false;
+    }
+
+    request = regionDecoder.decode(slot, currentTrack->url, currentTrack->decodedTrack, start, numSamples, makeScratchWindow);
+
+    //offline the region is ready before decode() returns, and there's no message loop to deliver it
+    if (regionDecoder.isOffline())
+    {
+        takeDecodedRegions();
+    }
+    return true;
+}
+
+void DJAudioPlayer::takeDecodedRegions()
+{
+    RegionDecoder::Result result;
+    while (regionDecoder.takeDecodedRegion(result))
+    {
+        //anything not asked for any more was cleared, replaced or set on the last track
+        if (currentTrack == nullptr)
+        {
+            continue;
+        }
+
+        if (result.slot < numHotCues)
+        {
+            if (result.id != hotCueRequests[result.slot])
+            {
+                continue;
+            }
+
+            hotCueRequests[result.slot] = 0;
+            if (result.region != nullptr && currentTrack->cueSource->setRegion(result.slot, std::move(result.region)))
+            {
+                hotCues[result.slot] = pendingHotCues[result.slot];
+            }
+        }
+        else if (result.slot == numHotCues && result.id == loopRequest)
+        {
+            loopRequest = 0;
+            if (result.region != nullptr && currentTrack->cueSource->setRegion(numHotCues, std::move(result.region)))
+            {
+                loopRegionStart = requestedLoopStart;
+                loopRegionEnd = requestedLoopEnd;
+            }
+
+            //the loop may have shrunk while it waited, but never past what was decoded for it.
+            //One that couldn't be decoded still plays, from the source
+            if (looping)
+            {
+                sendCommand(DeckCommand::Type::setLoop, (double) loopInSample, (double) loopOutSample);
+            }
+        }
+        else if (result.slot == scratchWindowSlot && result.id == scratchWindowRequest)
+        {
+            scratchWindowRequest = 0;
+            if (result.window == nullptr || ! scratcher.setWindow(std::move(result.window)))
+            {
+                //a scratch that hadn't taken hold yet lets go; one that had carries on in the window it has
+                scratchRequested = scratchStarted;
+                continue;
+            }
+
+            scratchWindowStart = result.region->start;
+            scratchWindowEnd = result.region->start + result.region->samples.getNumSamples();
+            scratchRegion = std::move(result.region);
+
+            if (! scratchStarted)
+            {
+                //the rate goes first, so the audio thread can't start the scratch without it
+                commandQueue.setLatest(DeckCommand::Type::setScratchRate, scratchRate);
+                scratchStarted = sendCommand(DeckCommand::Type::startScratch);
+                scratchRequested = scratchStarted;
+            }
+        }
+    }
+}
+
+void DJAudioPlayer::updateLoop()
+{
+    if (currentTrack == nullptr)
+    {
+        return;
+    }
+
+    if (! looping || loopOutSample - loopInSample < minLoopSamples)
+    {
+        looping = false;
+        loopRequest = 0;
+        sendCommand(DeckCommand::Type::setLoop, 0, 0);
+        return;
+    }
+
+    //the loop and a few seconds past its end, so leaving it plays on from RAM while the source catches up.
+    //halving and doubling usually stay inside what's already decoded, or what's on its way
+    const double sampleRate = currentTrack->sourceSampleRate;
+    const auto start = jmax((int64) 0, loopInSample - prerollSamples);
+    const auto end = jmin(loopOutSample + (int64) (regionSeconds * sampleRate),
+                          start + (int64) (maxRegionSeconds * sampleRate),
+                          currentTrack->source->getTotalLength());
+
+    if (start >= loopRegionStart && end <= loopRegionEnd)
+    {
+        loopRequest = 0;
+        sendCommand(DeckCommand::Type::setLoop, (double) loopInSample, (double) loopOutSample);
+        return;
+    }
+    if (loopRequest != 0 && start >= requestedLoopStart && end <= requestedLoopEnd)
+    {
+        return;
+    }
+
+    //sent to the audio thread when the region arrives in takeDecodedRegions
+    requestedLoopStart = start;
+    requestedLoopEnd = end;
+    if (! requestRegion(numHotCues, start, end - start, loopRequest))
+    {
+        sendCommand(DeckCommand::Type::setLoop, (double) loopInSample, (double) loopOutSample);
+    }
+}
+
+bool DJAudioPlayer::requestScratchWindow(int64 position)
+{
+    const auto half = (int64) (scratchWindowSeconds * currentTrack->sourceSampleRate);
+    const auto start = jmax((int64) 0, position - half);
+    return requestRegion(scratchWindowSlot, start, position + half - start, scratchWindowRequest, true);
+}
+
+void DJAudioPlayer::renderScratch(const AudioSourceChannelInfo& bufferToFill)
+{
+    auto& buffer = *bufferToFill.buffer;
+    const int numChannels = jmin(2, buffer.getNumChannels());
+
+    for (int done = 0; done < bufferToFill.numSamples; done += scratchBuffer.getNumSamples())
+    {
+        const int start = bufferToFill.startSample + done;
+        const int length = jmin(bufferToFill.numSamples - done, scratchBuffer.getNumSamples());
+        scratcher.render(scratchBuffer, 0, length);
+
+        if (scratchMix.isSmoothing())
+        {
+            const float startMix = scratchMix.getCurrentValue();
+            const float endMix = scratchMix.skip(length);
+            buffer.applyGainRamp(start, length, 1.0f - startMix, 1.0f - endMix);
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                buffer.addFromWithRamp(ch, start, scratchBuffer.getReadPointer(ch), length, startMix, endMix);
+            }
+        }
+        else
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                buffer.copyFrom(ch, start, scratchBuffer, ch, 0, length);
+            }
+        }
+    }
+}
+
+void DJAudioPlayer::handOverNextTrack()
+{
+    if (nextURL.isEmpty() || (handedOverNext != nullptr && handedOverNext->url == nextURL))
+    {
+        return;
+    }
+
+    trackLoader.preload(nextURL, readAheadSize);
+    if (! autoAdvance)
+    {
+        return;
+    }
+
+    //still opening, the timer comes back for it
+    auto track = trackLoader.takePreloadedTrack(nextURL);
+    if (track == nullptr)
+    {
+        return;
+    }
+
+    //start at its first sound, stop at its last and level it, once the library has measured it.
+    //the seek refills its read-ahead long before it plays
+    TrackAnalyser::Result result;
+    if (nextURL.isLocalFile() && trackAnalyser.getResult(nextURL.getLocalFile(), result) && result.hasLoudness)
+    {
+        if (result.soundEnd > result.soundStart)
+        {
+            track->transportSource.setPosition(result.soundStart);
+            track->soundEnd = (int64) (result.soundEnd * track->sourceSampleRate);
+        }
+        if (autoGain)
+        {
+            track->autoGain = (float) Decibels::decibelsToGain(calculateAutoGain(result.loudness, result.truePeak));
+        }
+    }
+    track->transportSource.start();
+
+    if (handOverNext(track.get()))
+    {
+        handedOverNext = track.release();
+    }
+}
+
+bool DJAudioPlayer::handOverNext(LoadedTrack* track)
+{
+    if (! pendingNextTracks.push(track))
+    {
+        std::cout << "DJAudioPlayer::handOverNext the audio thread hasn't picked up the last track yet" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DJAudioPlayer::takeAdvance()
+{
+    auto* advanced = advancedTrack.load(std::memory_order_acquire);
+    if (advanced == nullptr)
+    {
+        return;
+    }
+
+    //the queued track is used up either way
+    handedOverNext = nullptr;
+
+    //a load swapped in since then replaces the track the audio thread moved on to
+    if (advancedFrom.load(std::memory_order_relaxed) == currentTrack)
+    {
+        stopScratch();
+        clearCuesAndLoop();
+
+        currentTrack = advanced;
+        requestedURL = advanced->url;
+        ++numAdvances;
+
+        fetchBeatgrid();
+        loudnessKnown = false;
+        fetchLoudness();
+        if (! loudnessKnown)
+        {
+            updateGain();
+        }
+    }
+
+    //the outgoing track can only be retired once this has run, so currentTrack is never left dangling
+    advancedTrack.store(nullptr, std::memory_order_release);
+}
+
+int DJAudioPlayer::findAdvance(int numSamples)
+{
+    //one advance at a time, and never in the middle of a scratch or a seek
+    if (nextTrack == nullptr || outgoingTrack != nullptr || scratching || pendingSeek >= 0
+        || advancedTrack.load(std::memory_order_acquire) != nullptr)
+    {
+        return numSamples;
+    }
+    if (advanceRequested)
+    {
+        return 0;
+    }
+    if (! autoAdvanceActive || activeTrack->cueSource->hasLoop() || appliedSpeed <= 0)
+    {
+        return numSamples;
+    }
+
+    auto end = activeTrack->soundEnd.load(std::memory_order_relaxed);
+    if (end < 0)
+    {
+        end = activeTrack->cueSource->getTotalLength();
+    }
+
+    //counted in device samples at the deck's speed, the unit the block and beginAdvance's fade are in
+    const double untilEnd = (end - activeTrack->cueSource->getNextReadPosition()) * deviceSampleRate
+                          / (activeTrack->sourceSampleRate * appliedSpeed);
+    const double untilAdvance = untilEnd - advanceCrossfadeSeconds * deviceSampleRate;
+    return untilAdvance < numSamples ? jmax(0, (int) untilAdvance) : numSamples;
+}
+
+void DJAudioPlayer::beginAdvance()
+{
+    outgoingTrack = activeTrack;
+    activeTrack = nextTrack;
+    nextTrack = nullptr;
+    advanceRequested = false;
+
+    //the deck's gain levels the outgoing track; move it onto the incoming one and keep the outgoing where it was
+    const float outgoingGain = outgoingTrack->autoGain.load(std::memory_order_relaxed);
+    const float incomingGain = activeTrack->autoGain.load(std::memory_order_relaxed);
+    gainRamp.setCurrentAndTargetValue(gainRamp.getTargetValue() / outgoingGain * incomingGain);
+    outgoingLevel = outgoingGain / incomingGain;
+
+    advancedFrom.store(outgoingTrack, std::memory_order_relaxed);
+    advancedTrack.store(activeTrack, std::memory_order_release);
+
+    //sync pulls the new track onto the beat by bending its tempo, since a seek would cut the crossfade
+    syncJustEngaged = false;
+
+    //ends as the outgoing track does, since findAdvance left advanceCrossfadeSeconds of the device's time for it
+    if (advanceCrossfadeSeconds > 0)
+    {
+        advanceFade.reset(deviceSampleRate, advanceCrossfadeSeconds);
+        advanceFade.setCurrentAndTargetValue(1.0f);
+        advanceFade.setTargetValue(0.0f);
+    }
+    else
+    {
+        retiredTracks.retire(outgoingTrack);
+        outgoingTrack = nullptr;
+    }
+}
+
+void DJAudioPlayer::renderOutgoing(const AudioSourceChannelInfo& bufferToFill)
+{
+    if (outgoingTrack == nullptr)
+    {
+        return;
+    }
+
+    auto& buffer = *bufferToFill.buffer;
+    const int numChannels = jmin(2, buffer.getNumChannels());
+
+    for (int done = 0; done < bufferToFill.numSamples; done += advanceBuffer.getNumSamples())
+    {
+        const int start = bufferToFill.startSample + done;
+        const int length = jmin(bufferToFill.numSamples - done, advanceBuffer.getNumSamples());
+        outgoingTrack->transportSource.getNextAudioBlock(AudioSourceChannelInfo(&advanceBuffer, 0, length));
+
+        //the incoming track fades in as the outgoing one fades out
+        const float startMix = advanceFade.getCurrentValue();
+        const float endMix = advanceFade.skip(length);
+        buffer.applyGainRamp(start, length, 1.0f - startMix, 1.0f - endMix);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            buffer.addFromWithRamp(ch, start, advanceBuffer.getReadPointer(ch), length,
+                                   startMix * outgoingLevel, endMix * outgoingLevel);
+        }
+
+        if (! advanceFade.isSmoothing())
+        {
+            retiredTracks.retire(outgoingTrack);
+            outgoingTrack = nullptr;
+            return;
+        }
+    }
+}
+
+void DJAudioPlayer::swapInTrack(std::unique_ptr<LoadedTrack> track)
+{
+    takeAdvance();
+    deleteRetiredTracks();
+
+    //the transport always runs; the deck plays and pauses by fading and no longer pulling from it
+    track->transportSource.start();
+
+    currentTrack = track.release();
+
+    //if the audio thread never picked up the previous hand-over, it is ours to delete
+    std::unique_ptr<LoadedTrack> neverPlayed (pendingTrack.exchange(currentTrack));
+
+    //the decode may have finished while the track waited as a preload
+    fetchBeatgrid();
+
+    //level the new track before it plays; until its loudness is known it plays as it is
+    loudnessKnown = false;
+    fetchLoudness();
+    if (! loudnessKnown)
+    {
+        updateGain();
+    }
+
+    if (playRequested)
+    {
+        sendCommand(DeckCommand::Type::play);
+    }
+}
+
+void DJAudioPlayer::deleteRetiredTracks()
+{
+    retiredTracks.deleteRetired([] (LoadedTrack& track)
+    {
+        if (track.readAheadSource == nullptr)
+        {
+            return;
+        }
+
+        auto stats = track.readAheadSource->getStats();
+        DBG("DJAudioPlayer: previous track played " << stats.blocksPlayed << " blocks, "
+            << stats.underrunBlocks << " underruns (" << stats.underrunSamples << " samples), "
+            << "lowest read-ahead " << stats.lowestBufferedSamples << " samples");
+    });
+}
+
+void DJAudioPlayer::takePendingTrack()
+{
+    retiredTracks.flush();
+
+    //queued tracks, each replacing the last
+    pendingNextTracks.take([this] (LoadedTrack* track, int)
+    {
+        retiredTracks.retire(nextTrack);
+        nextTrack = track;
+        advanceRequested = false;
+    });
+
+    auto* loadedTrack = pendingTrack.exchange(nullptr);
+    if (loadedTrack == nullptr)
+    {
+        return;
+    }
+
+    //a load cuts an automatic crossfade short
+    retiredTracks.retire(activeTrack);
+    retiredTracks.retire(outgoingTrack);
+    outgoingTrack = nullptr;
+    activeTrack = loadedTrack;
+
+    //a new track fades in from silence, and a seek meant for the old one doesn't apply
+    pendingSeek = -1;
+    fade.setCurrentAndTargetValue(0.0f);
+    updateFadeTarget();
+    syncJustEngaged = syncActive;
+}
+
+//==============================================================================
+void DJAudioPlayer::TrackSlot::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    //the resampler prepares its input for the most it pulls in a block at its fastest ratio,
+    //so that's the size tracks are prepared for rather than the device's block
+    owner.trackLoader.prepare(samplesPerBlockExpected, sampleRate);
+
+    //no callbacks run while the device is being prepared, so tracks can be re-prepared here
+    owner.takePendingTrack();
+
+    for (auto* track : { owner.activeTrack, owner.nextTrack, owner.outgoingTrack })
+    {
+        if (track != nullptr)
+        {
+            owner.trackLoader.prepareTrack(*track);
+        }
+    }
+}
+
+void DJAudioPlayer::TrackSlot::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    //reading the track, whether from RAM, the read-ahead ring or a cue region
+    CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::decode);
+
+    auto* track = owner.activeTrack;
+    auto& fade = owner.fade;
+
+    if (track == nullptr)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return;
+    }
+
+    //seeks happen once the fade out has finished, so the jump can't click
+    if (fade.getCurrentValue() == 0.0f && ! fade.isSmoothing())
+    {
+        if (owner.pendingSeek >= 0)
+        {
+            //a jump during an automatic crossfade leaves the outgoing track behind
+            owner.retiredTracks.retire(owner.outgoingTrack);
+            owner.outgoingTrack = nullptr;
+
+            track->transportSource.setPosition(owner.pendingSeek);
+            owner.pendingSeek = -1;
+            owner.updateFadeTarget();
+        }
+
+        //paused: leave the transport where it is
+        if (fade.getTargetValue() == 0.0f)
+        {
+            bufferToFill.clearActiveBufferRegion();
+            return;
+        }
+
+        //the transport stops itself at the end of the track, so a seek back needs it restarted
+        if (! track->transportSource.isPlaying())
+        {
+            track->transportSource.start();
+        }
+    }
+
+    //the queued track takes over on the sample the current one's audio runs out, less the crossfade
+    const int advanceAt = owner.findAdvance(bufferToFill.numSamples);
+    if (advanceAt < bufferToFill.numSamples)
+    {
+        if (advanceAt > 0)
+        {
+            track->transportSource.getNextAudioBlock(AudioSourceChannelInfo(bufferToFill.buffer, bufferToFill.startSample, advanceAt));
+        }
+        owner.beginAdvance();
+        bufferToFill.buffer->applyGain(bufferToFill.startSample, advanceAt, owner.outgoingLevel);
+
+        const AudioSourceChannelInfo rest (bufferToFill.buffer, bufferToFill.startSample + advanceAt, bufferToFill.numSamples - advanceAt);
+        owner.activeTrack->transportSource.getNextAudioBlock(rest);
+        owner.renderOutgoing(rest);
+    }
+    else
+    {
+        track->transportSource.getNextAudioBlock(bufferToFill);
+        owner.renderOutgoing(bufferToFill);
+    }
+
+    if (fade.isSmoothing())
+    {
+        const float startGain = fade.getCurrentValue();
+        bufferToFill.buffer->applyGainRamp(bufferToFill.startSample, bufferToFill.numSamples,
+                                           startGain, fade.skip(bufferToFill.numSamples));
+    }
+}
+
+void DJAudioPlayer::TrackSlot::releaseResources()
+{
+    for (auto* track : { owner.activeTrack, owner.nextTrack, owner.outgoingTrack })
+    {
+        if (track != nullptr)
+        {
+            track->transportSource.releaseResources();
+
+            //force a fresh prepare when the device comes back
+            track->preparedSampleRate = 0;
+        }
+    }
 }
@@ -3,23 +3,159 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ReadAheadPool.h"
+#include "TrackLoader.h"
+#include "RegionDecoder.h"
+#include "DecodedTrackCache.h"
+#include "TimeStretcher.h"
+#include "VarispeedResampler.h"
+#include "DeckCommandQueue.h"
+#include "HandOverFifo.h"
+#include "BeatSync.h"
+#include "DeckEQ.h"
+#include "CueSource.h"
+#include "CallbackProfiler.h"
+#include "LevelMeter.h"
+#include "TrackAnalyser.h"
+#include "Scratcher.h"
+#include "AudioRecorder.h"
 
-class DJAudioPlayer : public AudioSource {
+class DJAudioPlayer : public AudioSource,
+                      public ChangeListener,
+                      private Timer {
   public:
 
-    DJAudioPlayer(AudioFormatManager& _formatManager);
+    static constexpr int numHotCues = 8;
+    /** shortest and longest loops setBeatLoop() takes */
+    static constexpr double minLoopBeats = 1.0 / 32.0;
+    static constexpr double maxLoopBeats = 64.0;
+    /** the fastest setScratchRate() goes, either way */
+    static constexpr double maxScratchRate = 8.0;
+    /** the longest crossfade auto advance makes, in seconds */
+    static constexpr double maxAdvanceCrossfade = 30.0;
+
+    /** the loudness auto gain levels tracks to unless told otherwise, in LUFS */
+    static constexpr double defaultTargetLoudness = -14.0;
+
+    /** deckIndex is this deck's slot in beatSync and recorder. Loudness for auto gain comes from trackAnalyser */
+    DJAudioPlayer(AudioFormatManager& _formatManager,
+                  ReadAheadPool& _readAheadPool,
+                  DecodedTrackCache& _decodedTrackCache,
+                  TrackAnalyser& _trackAnalyser,
+                  BeatSync& _beatSync,
+                  AudioRecorder& _recorder,
+                  int _deckIndex);
     ~DJAudioPlayer();
 
     void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
     void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
     void releaseResources() override;
 
+    /** opens the track in the background and swaps it in once it is buffered */
     void loadURL(URL audioURL);
+    /** opens the track in the background so a later loadURL of it is instant */
+    void preloadURL(URL audioURL);
+    /** the track that plays after this one: preloaded for NEXT, and with auto advance on handed
+        to the audio thread ahead of time. An empty URL clears it */
+    void queueNext(URL audioURL);
+    /** true until the last loadURL has been swapped in */
+    bool isLoading();
+
+    /** for rendering offline without a message loop: loads are decoded up front and
+        waitForLoad() swaps them in, instead of the loader's change message */
+    void setOfflineRendering(bool shouldBeOffline);
+    /** blocks until the last loadURL has been swapped in. False if it failed or timed out */
+    bool waitForLoad(int timeoutMs);
+
+    //the setters below only queue a command; the audio thread applies it at the start of its next block
     void setGain(double gain);
     void setSpeed(double ratio);
+    /** with key lock on, speed changes the tempo but not the pitch */
+    void setKeyLock(bool shouldBeOn);
+    bool isKeyLockOn();
+    /** interpolator used when the speed changes the pitch, can be changed while playing */
+    void setResamplingQuality(VarispeedResampler::Quality quality);
+    VarispeedResampler::Quality getResamplingQuality();
     void setPosition(double posInSecs);
     void setPositionRelative(double pos);
-    
+    /** from DeckEQ::killDecibels, which kills the band, up to DeckEQ::maxBoostDecibels */
+    void setEqBand(DeckEQ::Band band, double decibels);
+    /** -1 closes the low pass, 1 closes the high pass, 0 is off */
+    void setFilter(double amount);
+
+    /** levels each track to the target loudness, on top of the volume, using the loudness the
+        library's analysis measured. A track analysed after it loaded is levelled once the deck stops,
+        rather than jump in volume mid-mix. Off until turned on */
+    void setAutoGain(bool shouldBeOn);
+    bool isAutoGainOn();
+    /** in LUFS */
+    void setTargetLoudness(double lufs);
+    double getTargetLoudness();
+    /** what auto gain is doing to the loaded track, in decibels */
+    double getAutoGainDecibels();
+
+    /** moves on to the queued track by itself where the current one's audio ends, leaving out
+        the silence either side, so the two play back to back or crossfade. The queued track
+        is opened and waiting on the audio thread long before then */
+    void setAutoAdvance(bool shouldBeOn);
+    bool isAutoAdvanceOn();
+    /** how long the two tracks overlap, in seconds; 0 plays them back to back */
+    void setAdvanceCrossfade(double seconds);
+    double getAdvanceCrossfade();
+    /** starts the auto advance now. False if the queued track isn't waiting on the audio thread yet */
+    bool skipToNext();
+    /** goes up by one every time the deck moves on to the queued track by itself */
+    int getNumAdvances();
+    /** the track loaded, or the one auto advance moved on to */
+    URL getURL();
+
+    /** puts hot cue index at the playhead and decodes the audio after it into RAM in the
+        background. The cue is set once that's done, so jumping back there never waits on the decoder */
+    void setHotCue(int index);
+    /** jumps to hot cue index, if it is set */
+    void triggerHotCue(int index);
+    void clearHotCue(int index);
+    bool hasHotCue(int index);
+    /** true while hot cue index is waiting for its audio to be decoded */
+    bool isHotCuePending(int index);
+
+    /** marks where the next loop starts, on the nearest 1/8 beat when the track has a beatgrid */
+    void setLoopIn();
+    /** ends the loop at the playhead and starts looping */
+    void setLoopOut();
+    /** loops a number of beats from the playhead, snapped to the beatgrid */
+    void setBeatLoop(double beats);
+    /** keeps the loop's start and halves or doubles its length */
+    void halveLoop();
+    void doubleLoop();
+    /** lets playback carry on past the loop's end */
+    void exitLoop();
+    bool isLooping();
+    /** true while the loop waits for its audio to be decoded; the last loop, if any, plays until then */
+    bool isLoopPending();
+
+    /** takes hold of the track like a record: from now until stopScratch() it plays at the
+        rate setScratchRate() gives, whether or not the deck is playing, from audio decoded
+        into RAM around the playhead. It takes hold once the background decode of that is done,
+        a moment later. Letting go carries on from wherever the scratch got to */
+    void startScratch();
+    /** 1 is the track's normal speed, 0 holds it still, negative plays it backwards */
+    void setScratchRate(double rate);
+    void stopScratch();
+    bool isScratching();
+
+    /** in sync the deck ignores its speed setting and follows the master deck's
+        tempo and beat phase. Engaging sync jumps straight onto the master's beat */
+    void setSync(bool shouldBeOn);
+    bool isSyncOn();
+    /** makes this the deck the others follow */
+    void makeSyncMaster();
+    bool isSyncMaster();
+    /** the beatgrid of the loaded track, invalid while it's still being analysed */
+    Beatgrid getBeatgrid();
+    /** the tempo the deck is playing at, 0 if its track has no beatgrid */
+    double getTempo();
+
 
     void start();
     void stop();
@@ -27,17 +163,255 @@ class DJAudioPlayer : public AudioSource {
     /** get the relative position of the playhead */
     double getPositionRelative();
 
+    /** where the audio thread had the track at its last block, and how fast it was moving,
+        so the GUI can carry the playhead on smoothly between blocks */
+    struct PlayheadSnapshot
+    {
+        double seconds = 0;
+        /** track seconds per second: the speed while playing, the scratch's rate, 0 when still */
+        double rate = 0;
+        /** when the block was rendered, on Time::getMillisecondCounterHiRes() */
+        double timestamp = 0;
+        double lengthInSeconds = 0;
+
+        /** seconds moved on at rate to the time now, never further than maxExtrapolation
+            past the block in case the device has stopped calling back */
+        double getSecondsAt(double now) const;
+
+        static constexpr double maxExtrapolation = 0.1;
+    };
+    /** the last block's playhead; false if the audio thread was mid-update every try (any thread) */
+    bool getPlayheadSnapshot(PlayheadSnapshot& snapshot) const;
+
+    /** number of samples buffered ahead of the playhead, applied on the next load */
+    void setReadAheadSize(int numSamples);
+    /** underrun counters for the track currently loaded */
+    ReadAheadSource::Stats getReadAheadStats();
+    /** the deck's output levels, after the EQ and volume */
+    LevelMeter& getMeter();
+
+    /** implement ChangeListener, called when the loader has a requested track ready */
+    void changeListenerCallback (ChangeBroadcaster* source) override;
+
 private:
+    /** implement Timer, runs auto advance on the message thread */
+    void timerCallback() override;
+
+    /** hands a loaded track to the audio thread without locking it */
+    void swapInTrack(std::unique_ptr<LoadedTrack> track);
+    /** deletes tracks the audio thread has finished with (message thread) */
+    void deleteRetiredTracks();
+    /** picks up handed over tracks at the start of a block (audio thread) */
+    void takePendingTrack();
+
+    /** queues an event for the audio thread, saying so if the queue is full (message thread) */
+    bool sendCommand(DeckCommand::Type type, double value = 0, double value2 = 0);
+    /** carries out the events queued and the settings changed since the last block (audio thread) */
+    void handleCommand(const DeckCommand& command);
+    /** sends the speed to the time stretcher or the resampler, depending on key lock (audio thread) */
+    void applySpeed(double speedRatio);
+    /** fades in when playing, out when stopped or about to seek (audio thread) */
+    void updateFadeTarget();
+
+    /** the beat being heard at the start of the block; false without a track or beatgrid (audio thread) */
+    bool getBeatPosition(double& beat);
+    /** the speed that keeps this deck on the master's tempo and beat, or knobSpeed if
+        there's nothing to follow (audio thread) */
+    double followMaster(double beat, double knobSpeed, int numSamples);
+    /** tells the other decks where this one's beats are (audio thread) */
+    void publishBeatClock(bool hasBeat, double beat, double speedRatio);
+    /** timestamps where the block left the playhead, for getPlayheadSnapshot() (audio thread) */
+    void publishPlayhead();
+    /** copies a streamed track's beatgrid from the cache once its background decode is done */
+    void fetchBeatgrid();
+    /** picks up the current track's loudness and where its audio ends, once the analyser has measured them */
+    void fetchLoudness();
+    /** works out the auto gain for the current track and sends it with the volume */
+    void updateGain();
+    /** the auto gain for a track of this loudness and true peak, in decibels */
+    double calculateAutoGain(float loudness, float truePeak);
+    /** forgets the hot cues and loop, which belong to the track they were set on */
+    void clearCuesAndLoop();
+
+    /** where the current track's source will read next, in its samples (message thread) */
+    int64 getPlayheadSample();
+    /** the nearest 1/8 beat to a sample of the current track, or the sample itself without a beatgrid */
+    int64 snapToBeatgrid(int64 sample);
+    /** asks regionDecoder for part of the current track, storing the request's id in request.
+        False if there's nothing of the track there to decode */
+    bool requestRegion(int slot, int64 start, int64 numSamples, uint32& request, bool makeScratchWindow = false);
+    /** hands decoded regions to the current track's CueSource and windows to the scratcher,
+        setting the cues, loop and scratch that were waiting for them (message thread) */
+    void takeDecodedRegions();
+    /** makes sure the loop is decoded into RAM and sends it to the audio thread once it is, or ends it */
+    void updateLoop();
+    /** asks for the window a scratch plays from, centred on position; it's handed over
+        in takeDecodedRegions */
+    bool requestScratchWindow(int64 position);
+    /** plays the scratch over the deck, crossfading while it starts or stops (audio thread) */
+    void renderScratch(const AudioSourceChannelInfo& bufferToFill);
+
+    /** opens the queued track and hands it to the audio thread, once the loader has it (message thread) */
+    void handOverNextTrack();
+    /** empties the audio thread's queued track slot, or fills it with track (message thread) */
+    bool handOverNext(LoadedTrack* track);
+    /** catches up with an advance the audio thread has made (message thread) */
+    void takeAdvance();
+    /** how many of the slot's numSamples play before the queued track takes over, numSamples
+        if it doesn't this block (audio thread) */
+    int findAdvance(int numSamples);
+    /** makes the queued track the active one, the old one fading out under it (audio thread) */
+    void beginAdvance();
+    /** mixes the outgoing track in as it fades out, and lets go of it once it has (audio thread) */
+    void renderOutgoing(const AudioSourceChannelInfo& bufferToFill);
+
+    /** the time stretcher's input: renders whichever track the audio thread currently owns,
+        fading it in and out and seeking while it is silent */
+    class TrackSlot : public AudioSource
+    {
+    public:
+        TrackSlot(DJAudioPlayer& _owner) : owner(_owner) {}
+
+        void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+        void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+        void releaseResources() override;
+
+    private:
+        DJAudioPlayer& owner;
+    };
+
     AudioFormatManager& formatManager;
+    ReadAheadPool& readAheadPool;
+    DecodedTrackCache& decodedTrackCache;
+    TrackAnalyser& trackAnalyser;
+    BeatSync& beatSync;
+    AudioRecorder& recorder;
+    const int deckIndex;
+    int readAheadSize;
+
+    TrackLoader trackLoader;
+    RegionDecoder regionDecoder;
+
+    // the newest track handed over, as seen from the message thread
+    LoadedTrack* currentTrack = nullptr;
+    // handed over but not yet picked up by the audio thread
+    std::atomic<LoadedTrack*> pendingTrack{nullptr};
+    // owned by the audio thread
+    LoadedTrack* activeTrack = nullptr;
 
-    std::unique_ptr<AudioFormatReaderSource> readerSource;
+    // the message thread deletes retired tracks before every hand-over, and the audio thread holds
+    // at most a few tracks plus the queued ones, so this has room to spare for everything in between
+    RetireFifo<LoadedTrack, 32> retiredTracks;
 
-    AudioTransportSource transportSource; 
-    
-    ResamplingAudioSource resampleSource{&transportSource, false, 2};
+    // queued tracks handed to the audio thread, nullptr emptying its slot
+    HandOverFifo<LoadedTrack, 4> pendingNextTracks;
+    // the audio thread's last advance: the track it moved on to, until the message thread has
+    // caught up with it, and the one it moved on from
+    std::atomic<LoadedTrack*> advancedTrack{nullptr};
+    std::atomic<LoadedTrack*> advancedFrom{nullptr};
+
+    DeckCommandQueue commandQueue;
+
+    // the message thread's view of the deck
+    bool playRequested = false;
+    URL requestedURL;
+    bool keyLock = false;
+    bool sync = false;
+    VarispeedResampler::Quality resamplingQuality = VarispeedResampler::Quality::cubic;
+    // the volume knob, and auto gain from the current track's measured loudness
+    double gain = 1.0;
+    bool autoGain = false;
+    double targetLoudness = defaultTargetLoudness;
+    bool loudnessKnown = false;
+    float trackLoudness = 0;
+    float trackTruePeak = 0;
+    double autoGainDecibels = 0;
+    // hot cues and the loop, in the current track's samples; -1 when not set
+    int64 hotCues[numHotCues];
+    int64 loopInSample = -1;
+    int64 loopOutSample = -1;
+    bool looping = false;
+    // the span already decoded into the loop's region
+    int64 loopRegionStart = 0;
+    int64 loopRegionEnd = 0;
+    // regions being decoded for the cues and the loop, by the id regionDecoder gave them; 0 when none
+    uint32 hotCueRequests[numHotCues] = {};
+    int64 pendingHotCues[numHotCues] = {};
+    uint32 loopRequest = 0;
+    int64 requestedLoopStart = 0;
+    int64 requestedLoopEnd = 0;
+    // the scratch, whether it has taken hold yet, and the rate it was last given
+    bool scratchRequested = false;
+    bool scratchStarted = false;
+    double scratchRate = 0;
+    // the span of the track the window handed over holds, and its samples for where the scratch lets go
+    int64 scratchWindowStart = 0;
+    int64 scratchWindowEnd = 0;
+    std::unique_ptr<CueSource::Region> scratchRegion;
+    // the next window, while it's being decoded; 0 when none
+    uint32 scratchWindowRequest = 0;
+    // auto advance, the track it moves on to, and the one handed to the audio thread for it
+    bool autoAdvance = false;
+    double advanceCrossfade = 0;
+    URL nextURL;
+    LoadedTrack* handedOverNext = nullptr;
+    int numAdvances = 0;
+
+    // the audio thread's state, ramped per sample so changes don't zipper or click
+    SmoothedValue<float, ValueSmoothingTypes::Linear> gainRamp{1.0f};
+    SmoothedValue<double, ValueSmoothingTypes::Linear> speedRamp{1.0};
+    SmoothedValue<float, ValueSmoothingTypes::Linear> fade{0.0f};
+    DeckEQ eq;
+    LevelMeter meter;
+    Scratcher scratcher;
+    bool scratching = false;
+    // how much of the output is the scratch rather than the deck's chain
+    SmoothedValue<float, ValueSmoothingTypes::Linear> scratchMix{0.0f};
+    AudioBuffer<float> scratchBuffer;
+    // the queued track, and the last one while it fades out under it
+    LoadedTrack* nextTrack = nullptr;
+    LoadedTrack* outgoingTrack = nullptr;
+    bool autoAdvanceActive = false;
+    bool advanceRequested = false;
+    double advanceCrossfadeSeconds = 0;
+    SmoothedValue<float, ValueSmoothingTypes::Linear> advanceFade{0.0f};
+    // keeps the outgoing track at its own auto gain once the deck's gain is the incoming one's
+    float outgoingLevel = 1.0f;
+    AudioBuffer<float> advanceBuffer;
+    bool playing = false;
+    bool keyLockActive = false;
+    double pendingSeek = -1;
+    bool syncActive = false;
+    bool syncJustEngaged = false;
+    // the speed last sent down the chain, which in sync is not the knob's
+    double appliedSpeed = 1.0;
+    double deviceSampleRate = 44100.0;
+    // this deck's count on the shared sample clock, see BeatClock
+    int64 samplesRendered = 0;
+    // and the blocks that took, which stamp the beat clocks in beatSync
+    int64 blocksRendered = 0;
+    std::atomic<double> tempo{0};
+    // the scratch's rate in track seconds per second, for the playhead snapshot
+    double scratchSpeed = 0;
+
+    // the playhead as of the last block, odd sequence while it's being written
+    std::atomic<uint32> playheadSequence{0};
+    std::atomic<double> playheadSeconds{0};
+    std::atomic<double> playheadRate{0};
+    std::atomic<double> playheadTimestamp{0};
+    std::atomic<double> playheadLength{0};
+
+    TrackSlot trackSlot{*this};
+
+    TimeStretcher timeStretcher{&trackSlot, 2};
+    CallbackProfiler::ProfiledSource stretchStage{&timeStretcher, CallbackProfiler::Stage::stretch};
+
+    VarispeedResampler resampleSource{&stretchStage, 2};
 
 };
 
 
 
 
+
+
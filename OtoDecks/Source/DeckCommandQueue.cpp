@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    DeckCommandQueue.cpp
+    Created: 17 Oct 2026 8:02:36pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DeckCommandQueue.h"
+
+//==============================================================================
+DeckCommandQueue::DeckCommandQueue(int capacity)
+                 : fifo(capacity)
+{
+    commands.allocate((size_t) capacity, true);
+
+    for (int i = 0; i < numLatestValues; ++i)
+    {
+        latestValues[i] = std::numeric_limits<double>::quiet_NaN();
+        drainedValues[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+bool DeckCommandQueue::push(DeckCommand::Type type, double value, double value2)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    if (size1 + size2 == 0)
+    {
+        return false;
+    }
+
+    commands[size1 > 0 ? start1 : start2] = { type, value, value2 };
+    fifo.finishedWrite(1);
+    return true;
+}
+
+void DeckCommandQueue::setLatest(DeckCommand::Type type, double value)
+{
+    jassert ((int) type < numLatestValues);
+    latestValues[(int) type].store(value, std::memory_order_relaxed);
+}
+
+void DeckCommandQueue::resendLatest(DeckCommand::Type type)
+{
+    jassert ((int) type < numLatestValues);
+    drainedValues[(int) type] = std::numeric_limits<double>::quiet_NaN();
+}
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    DeckCommandQueue.h
+    Created: 17 Oct 2026 8:02:36pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    A change to a deck's parameters, made on the message thread and carried
+    out by the audio thread.
+*/
+struct DeckCommand
+{
+    enum class Type
+    {
+        // continuous settings, where only the latest value matters: sent with DeckCommandQueue::setLatest
+        setGain,
+        setSpeed,
+        setLowGain,
+        setMidGain,
+        setHighGain,
+        setFilter,
+        setScratchRate,
+
+        // events, sent with DeckCommandQueue::push
+        setKeyLock,
+        setResamplingQuality,
+        setPosition,
+        setSync,
+        setLoop,
+        startScratch,
+        stopScratch,
+        setAutoAdvance,
+        setAdvanceCrossfade,
+        advance,
+        play,
+        stop
+    };
+
+    Type type;
+    // gain, speed ratio, position in seconds, 0/1 for key lock, sync and auto advance, a VarispeedResampler::Quality,
+    // a linear EQ band gain, the filter amount, a loop's start sample, a scratch rate or a crossfade in seconds
+    double value = 0;
+    // a loop's end sample
+    double value2 = 0;
+};
+
+//==============================================================================
+/*
+    Single producer, single consumer queue of DeckCommands. The message thread
+    pushes events and sets the latest continuous values, the audio thread
+    drains both at the start of each block. Neither side locks or allocates.
+*/
+class DeckCommandQueue
+{
+public:
+    DeckCommandQueue(int capacity = 256);
+
+    /** queues an event. Returns false, dropping it, if the audio thread has fallen that far behind */
+    bool push(DeckCommand::Type type, double value = 0, double value2 = 0);
+
+    /** sets a continuous value. Never fails: one the audio thread hasn't seen yet is just replaced */
+    void setLatest(DeckCommand::Type type, double value);
+
+    /** has drain hand over a continuous value again, even if it hasn't changed (audio thread) */
+    void resendLatest(DeckCommand::Type type);
+
+    /** calls handleCommand on every waiting event, oldest first, then on every continuous
+        value that changed since the last drain (audio thread) */
+    template <typename Handler>
+    void drain(Handler&& handleCommand)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+        {
+            handleCommand(commands[start1 + i]);
+        }
+        for (int i = 0; i < size2; ++i)
+        {
+            handleCommand(commands[start2 + i]);
+        }
+
+        fifo.finishedRead(size1 + size2);
+
+        //after the events, so a scratch started in this block gets its rate straight away
+        for (int i = 0; i < numLatestValues; ++i)
+        {
+            const double value = latestValues[i].load(std::memory_order_relaxed);
+            if (! std::isnan(value) && value != drainedValues[i])
+            {
+                drainedValues[i] = value;
+                handleCommand(DeckCommand { (DeckCommand::Type) i, value });
+            }
+        }
+    }
+
+private:
+    // the continuous settings come first in DeckCommand::Type
+    static const int numLatestValues = (int) DeckCommand::Type::setScratchRate + 1;
+
+    AbstractFifo fifo;
+    HeapBlock<DeckCommand> commands;
+
+    // NaN until first set
+    std::atomic<double> latestValues[numLatestValues];
+    // what drain last handed over (audio thread)
+    double drainedValues[numLatestValues];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckCommandQueue)
+};
@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    DeckEQ.cpp
+    Created: 17 Oct 2026 11:52:19pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DeckEQ.h"
+
+static const float butterworthQ = 0.70710678f;
+
+// the sweep's cutoffs with the knob at the centre and at either end
+static const double lowPassOpen = 20000.0;
+static const double lowPassClosed = 60.0;
+static const double highPassOpen = 20.0;
+static const double highPassClosed = 10000.0;
+// a little resonance, so a sweep can be heard moving
+static const float filterResonance = 1.1f;
+// closer to the centre than this and the filter is off
+static const float filterDeadZone = 0.002f;
+
+// while the filter knob moves, its coefficients are recalculated every this many samples
+static const int coefficientUpdateInterval = 16;
+
+//==============================================================================
+float DeckEQ::decibelsToBandGain(double decibels)
+{
+    return decibels <= killDecibels ? 0.0f : Decibels::decibelsToGain((float) decibels);
+}
+
+DeckEQ::DeckEQ()
+{
+    for (auto& gain : bandGains)
+    {
+        gain.setCurrentAndTargetValue(1.0f);
+    }
+
+    //the sweep's coefficients are assigned in place from then on, so the audio thread never allocates them
+    sweepLowPassCoefficients = Coefficients::makeLowPass(sampleRate, lowPassOpen, filterResonance);
+    sweepHighPassCoefficients = Coefficients::makeHighPass(sampleRate, highPassOpen, filterResonance);
+    sweepLowPass.coefficients = sweepLowPassCoefficients;
+    sweepHighPass.coefficients = sweepHighPassCoefficients;
+}
+
+void DeckEQ::prepare(int _maximumBlockSize, double _sampleRate, int _numChannels)
+{
+    sampleRate = _sampleRate;
+    maximumBlockSize = jmax(1, _maximumBlockSize);
+    numChannels = jmin(_numChannels, (int) Vector::size());
+    jassert(_numChannels <= (int) Vector::size());
+
+    scratch = dsp::AudioBlock<Vector>(scratchMemory, 3, (size_t) maximumBlockSize);
+    //lanes past the last channel are never written, and zero in gives zero out of every filter
+    scratch.clear();
+
+    auto lowSplit = Coefficients::makeLowPass(sampleRate, lowCrossover, butterworthQ);
+    auto lowSplitHigh = Coefficients::makeHighPass(sampleRate, lowCrossover, butterworthQ);
+    auto highSplit = Coefficients::makeLowPass(sampleRate, highCrossover, butterworthQ);
+    auto highSplitHigh = Coefficients::makeHighPass(sampleRate, highCrossover, butterworthQ);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        lowSplitLowPass[i].coefficients = lowSplit;
+        lowSplitHighPass[i].coefficients = lowSplitHigh;
+        highSplitLowPass[i].coefficients = highSplit;
+        highSplitHighPass[i].coefficients = highSplitHigh;
+    }
+    lowBandAllPass.coefficients = Coefficients::makeAllPass(sampleRate, highCrossover, butterworthQ);
+
+    for (auto& gain : bandGains)
+    {
+        gain.reset(sampleRate, 0.02);
+    }
+    filterAmount.reset(sampleRate, 0.05);
+    updateFilterCoefficients(filterAmount.getTargetValue());
+
+    reset();
+}
+
+void DeckEQ::reset()
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        lowSplitLowPass[i].reset();
+        lowSplitHighPass[i].reset();
+        highSplitLowPass[i].reset();
+        highSplitHighPass[i].reset();
+    }
+    lowBandAllPass.reset();
+    sweepLowPass.reset();
+    sweepHighPass.reset();
+}
+
+void DeckEQ::setBandGain(Band band, float gain)
+{
+    bandGains[(int) band].setTargetValue(jmax(0.0f, gain));
+}
+
+void DeckEQ::setFilter(float amount)
+{
+    filterAmount.setTargetValue(jlimit(-1.0f, 1.0f, amount));
+}
+
+void DeckEQ::process(AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    for (int done = 0; done < numSamples; done += maximumBlockSize)
+    {
+        processChunk(buffer, startSample + done, jmin(maximumBlockSize, numSamples - done));
+    }
+}
+
+//==============================================================================
+void DeckEQ::processChunk(AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numLanes = (int) Vector::size();
+    const int numToProcess = jmin(numChannels, buffer.getNumChannels());
+
+    auto input = scratch.getSingleChannelBlock(0).getSubBlock(0, (size_t) numSamples);
+    auto low = scratch.getSingleChannelBlock(1).getSubBlock(0, (size_t) numSamples);
+    auto mid = scratch.getSingleChannelBlock(2).getSubBlock(0, (size_t) numSamples);
+
+    auto* inputData = input.getChannelPointer(0);
+    auto* lowData = low.getChannelPointer(0);
+    auto* midData = mid.getChannelPointer(0);
+
+    //channel n goes in lane n
+    auto* lanes = reinterpret_cast<float*>(inputData);
+    for (int ch = 0; ch < numToProcess; ++ch)
+    {
+        auto* source = buffer.getReadPointer(ch, startSample);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            lanes[i * numLanes + ch] = source[i];
+        }
+    }
+
+    dsp::ProcessContextReplacing<Vector> inputContext(input);
+    dsp::ProcessContextReplacing<Vector> lowContext(low);
+    dsp::ProcessContextReplacing<Vector> midContext(mid);
+
+    //split off the low band, leaving mid and high in the input
+    std::copy(inputData, inputData + numSamples, lowData);
+    lowSplitLowPass[0].process(lowContext);
+    lowSplitLowPass[1].process(lowContext);
+    lowBandAllPass.process(lowContext);
+    lowSplitHighPass[0].process(inputContext);
+    lowSplitHighPass[1].process(inputContext);
+
+    //then the mid band, leaving the high in the input
+    std::copy(inputData, inputData + numSamples, midData);
+    highSplitLowPass[0].process(midContext);
+    highSplitLowPass[1].process(midContext);
+    highSplitHighPass[0].process(inputContext);
+    highSplitHighPass[1].process(inputContext);
+
+    auto& lowGain = bandGains[(int) Band::low];
+    auto& midGain = bandGains[(int) Band::mid];
+    auto& highGain = bandGains[(int) Band::high];
+
+    if (lowGain.isSmoothing() || midGain.isSmoothing() || highGain.isSmoothing())
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            inputData[i] = lowData[i] * lowGain.getNextValue()
+                         + midData[i] * midGain.getNextValue()
+                         + inputData[i] * highGain.getNextValue();
+        }
+    }
+    else
+    {
+        const auto lowVector = Vector::expand(lowGain.getTargetValue());
+        const auto midVector = Vector::expand(midGain.getTargetValue());
+        const auto highVector = Vector::expand(highGain.getTargetValue());
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            inputData[i] = lowData[i] * lowVector + midData[i] * midVector + inputData[i] * highVector;
+        }
+    }
+
+    processFilter(input);
+
+    for (int ch = 0; ch < numToProcess; ++ch)
+    {
+        auto* destination = buffer.getWritePointer(ch, startSample);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            destination[i] = lanes[i * numLanes + ch];
+        }
+    }
+}
+
+void DeckEQ::processFilter(dsp::AudioBlock<Vector>& block)
+{
+    const int numSamples = (int) block.getNumSamples();
+
+    if (! filterAmount.isSmoothing())
+    {
+        if (sweepLowPassActive || sweepHighPassActive)
+        {
+            dsp::ProcessContextReplacing<Vector> context(block);
+            (sweepLowPassActive ? sweepLowPass : sweepHighPass).process(context);
+        }
+        return;
+    }
+
+    for (int start = 0; start < numSamples; start += coefficientUpdateInterval)
+    {
+        const int length = jmin(coefficientUpdateInterval, numSamples - start);
+        updateFilterCoefficients(filterAmount.skip(length));
+
+        if (sweepLowPassActive || sweepHighPassActive)
+        {
+            auto subBlock = block.getSubBlock((size_t) start, (size_t) length);
+            dsp::ProcessContextReplacing<Vector> context(subBlock);
+            (sweepLowPassActive ? sweepLowPass : sweepHighPass).process(context);
+        }
+    }
+}
+
+void DeckEQ::updateFilterCoefficients(float amount)
+{
+    const bool wasLowPass = sweepLowPassActive;
+    const bool wasHighPass = sweepHighPassActive;
+    const double nyquistLimit = sampleRate * 0.45;
+
+    sweepLowPassActive = amount < -filterDeadZone;
+    sweepHighPassActive = amount > filterDeadZone;
+
+    //the cutoff moves exponentially, so the knob sweeps evenly by ear
+    if (sweepLowPassActive)
+    {
+        const double cutoff = jmin(nyquistLimit, lowPassOpen * std::pow(lowPassClosed / lowPassOpen, (double) -amount));
+        *sweepLowPassCoefficients = dsp::IIR::ArrayCoefficients<float>::makeLowPass(sampleRate, (float) cutoff, filterResonance);
+    }
+    if (sweepHighPassActive)
+    {
+        const double cutoff = jmin(nyquistLimit, highPassOpen * std::pow(highPassClosed / highPassOpen, (double) amount));
+        *sweepHighPassCoefficients = dsp::IIR::ArrayCoefficients<float>::makeHighPass(sampleRate, (float) cutoff, filterResonance);
+    }
+
+    //a filter coming back on starts from silence rather than whatever it last heard
+    if (sweepLowPassActive && ! wasLowPass)
+    {
+        sweepLowPass.reset();
+    }
+    if (sweepHighPassActive && ! wasHighPass)
+    {
+        sweepHighPass.reset();
+    }
+}
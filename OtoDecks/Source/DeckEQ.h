@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    DeckEQ.h
+    Created: 17 Oct 2026 11:52:19pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    A deck's 3-band isolator EQ followed by a one-knob filter sweep.
+
+    The bands are split with Linkwitz-Riley crossovers, so with every band at
+    0dB the response is flat (only the phase turns, as on a mixer's isolator),
+    and turning a band right down kills it outright rather than just cutting it
+    by a shelf's worth. The filter is a resonant low
+    pass turning left of centre and a high pass turning right, off in the middle.
+
+    All channels go through the biquads together, one per lane of a juce_dsp
+    SIMDRegister, so a stereo deck costs the same as a mono one. Band gains are
+    ramped per sample and the filter's coefficients every few samples while its
+    knob moves. Nothing is allocated after prepare().
+*/
+class DeckEQ
+{
+public:
+    enum class Band
+    {
+        low,
+        mid,
+        high
+    };
+
+    /** the bottom of a band's knob, which kills the band */
+    static constexpr double killDecibels = -26.0;
+    /** the top of a band's knob */
+    static constexpr double maxBoostDecibels = 6.0;
+    /** where the bands split, in Hz */
+    static constexpr double lowCrossover = 300.0;
+    static constexpr double highCrossover = 3000.0;
+
+    /** linear gain for a band knob in decibels, 0 at killDecibels and below */
+    static float decibelsToBandGain(double decibels);
+
+    DeckEQ();
+
+    /** allocates everything process() will need */
+    void prepare(int maximumBlockSize, double sampleRate, int numChannels);
+    /** clears the filters' history, e.g. after a seek */
+    void reset();
+
+    /** linear gain for a band, ramped from the current one (audio thread) */
+    void setBandGain(Band band, float gain);
+    /** -1 is the low pass fully closed, 0 is off and 1 is the high pass fully closed (audio thread) */
+    void setFilter(float amount);
+
+    /** processes the buffer in place (audio thread) */
+    void process(AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+private:
+    using Vector = dsp::SIMDRegister<float>;
+    using Filter = dsp::IIR::Filter<Vector>;
+    using Coefficients = dsp::IIR::Coefficients<float>;
+
+    /** processes no more than maximumBlockSize samples */
+    void processChunk(AudioBuffer<float>& buffer, int startSample, int numSamples);
+    /** runs the filter sweep over the mixed bands, updating its coefficients while it moves */
+    void processFilter(dsp::AudioBlock<Vector>& block);
+    /** points the sweep's low or high pass at the cutoff for amount, without allocating */
+    void updateFilterCoefficients(float amount);
+
+    double sampleRate = 44100.0;
+    int maximumBlockSize = 0;
+    int numChannels = 0;
+
+    // input, low band and mid band, one channel each with every audio channel in its own lane
+    HeapBlock<char> scratchMemory;
+    dsp::AudioBlock<Vector> scratch;
+
+    // each Linkwitz-Riley split is a pair of Butterworth biquads
+    Filter lowSplitLowPass[2], lowSplitHighPass[2];
+    Filter highSplitLowPass[2], highSplitHighPass[2];
+    // the low band goes through the high split's all pass, so it stays in phase with the others
+    Filter lowBandAllPass;
+
+    Filter sweepLowPass, sweepHighPass;
+    Coefficients::Ptr sweepLowPassCoefficients, sweepHighPassCoefficients;
+    bool sweepLowPassActive = false;
+    bool sweepHighPassActive = false;
+
+    SmoothedValue<float, ValueSmoothingTypes::Linear> bandGains[3];
+    SmoothedValue<float, ValueSmoothingTypes::Linear> filterAmount{0.0f};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckEQ)
+};
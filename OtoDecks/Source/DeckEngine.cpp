@@ -0,0 +1,342 @@
+/*
+  ==============================================================================
+
+    DeckEngine.cpp
+    Created: 17 Oct 2026 6:48:19pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DeckEngine.h"
+#include "CallbackProfiler.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+// the audio thread waits on busy workers this many spins before yielding its core to them
+static const int spinsBeforeYield = 2000;
+// how early workers start spinning for a block: enough to cover a sleep(1) that oversleeps, but
+// never more than a quarter of a block either side, so short blocks don't keep them spinning
+static const double maxSpinLeadSeconds = 0.0015;
+// how much of a block's time the audio thread waits for inputs, leaving the rest for the master bus
+static const double lateInputBlockFraction = 0.75;
+
+/** eases off the core for a moment while spinning, without giving up the time slice */
+static void spinPause()
+{
+   #if JUCE_INTEL
+    _mm_pause();
+   #else
+    std::this_thread::yield();
+   #endif
+}
+
+//==============================================================================
+DeckEngine::Worker::Worker(DeckEngine& _engine, int index)
+                   : Thread("Deck engine " + String(index)),
+                     engine(_engine)
+{
+}
+
+void DeckEngine::Worker::run()
+{
+    auto lastBlock = (uint32) (engine.nextClaim.load() >> 32);
+    int64 spinStart = 0;
+
+    while (! threadShouldExit())
+    {
+        const auto block = (uint32) (engine.nextClaim.load(std::memory_order_acquire) >> 32);
+        const auto now = Time::getHighResolutionTicks();
+
+        if (spinStart != 0 && block != lastBlock)
+        {
+            engine.workerSpinTicks.fetch_add(now - spinStart, std::memory_order_relaxed);
+            spinStart = 0;
+        }
+        if (block != lastBlock)
+        {
+            lastBlock = block;
+            engine.renderClaimedInputs();
+            continue;
+        }
+
+        //spin only around when the next block is due. Before then there's time to sleep, and well
+        //after it the device is late or has stopped, so there's no point burning the core either
+        const auto due = engine.blockStartTicks.load(std::memory_order_relaxed) + engine.blockTicks.load(std::memory_order_relaxed);
+        const auto lead = engine.spinLeadTicks.load(std::memory_order_relaxed);
+        if (now >= due - lead && now < due + lead)
+        {
+            spinStart = spinStart != 0 ? spinStart : now;
+            spinPause();
+        }
+        else
+        {
+            if (spinStart != 0)
+            {
+                engine.workerSpinTicks.fetch_add(now - spinStart, std::memory_order_relaxed);
+                spinStart = 0;
+            }
+            sleep(1);
+        }
+    }
+}
+
+//==============================================================================
+DeckEngine::DeckEngine(int numWorkers)
+{
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.add(new Worker(*this, i + 1));
+    }
+}
+
+DeckEngine::~DeckEngine()
+{
+    releaseResources();
+}
+
+int DeckEngine::getDefaultNumWorkers(int numInputs)
+{
+    //the audio thread renders too, and there's no point in more threads than inputs
+    return jlimit(0, 7, jmin(SystemStats::getNumCpus() - 1, numInputs - 1));
+}
+
+void DeckEngine::addInput(AudioSource* input)
+{
+    jassert(! isPrepared);
+    inputs.add(input);
+    inputGains.add(1.0f);
+    appliedInputGains.add(1.0f);
+}
+
+int DeckEngine::getNumInputs() const
+{
+    return inputs.size();
+}
+
+void DeckEngine::setInputGain(int index, float gain)
+{
+    inputGains.set(index, gain);
+}
+
+int DeckEngine::getNumWorkers() const
+{
+    return workers.size();
+}
+
+DeckEngine::Stats DeckEngine::getStats() const
+{
+    Stats stats;
+    stats.workerSpinSeconds = Time::highResolutionTicksToSeconds(workerSpinTicks.load());
+    stats.lateInputs = lateInputs;
+    return stats;
+}
+
+void DeckEngine::resetStats()
+{
+    workerSpinTicks = 0;
+    lateInputs = 0;
+}
+
+void DeckEngine::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    //a device restart prepares again without releasing first
+    releaseResources();
+
+    blockSize = jmax(1, samplesPerBlockExpected);
+    blockTicks = Time::secondsToHighResolutionTicks(blockSize / sampleRate);
+    spinLeadTicks = Time::secondsToHighResolutionTicks(jmin(maxSpinLeadSeconds, blockSize / sampleRate / 4.0));
+    blockStartTicks = Time::getHighResolutionTicks();
+    lateInputTicks = Time::secondsToHighResolutionTicks(lateInputBlockFraction * blockSize / sampleRate);
+
+    inputBuffers.clear();
+    for (auto* input : inputs)
+    {
+        input->prepareToPlay(blockSize, sampleRate);
+        inputBuffers.add(new AudioBuffer<float>(2, blockSize));
+    }
+
+    //nothing is claimable until the first block is published
+    inputStates.reset(new InputState[(size_t) inputs.size()]);
+    nextClaim = ((uint64) currentBlock << 32) | (uint32) inputs.size();
+
+    for (auto* worker : workers)
+    {
+        //the highest priority JUCE offers, realtime where the platform allows it
+        worker->startThread(10);
+    }
+    isPrepared = true;
+}
+
+void DeckEngine::releaseResources()
+{
+    //workers check the flag at least every millisecond
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+    }
+    for (auto* worker : workers)
+    {
+        worker->stopThread(1000);
+    }
+
+    if (isPrepared)
+    {
+        for (auto* input : inputs)
+        {
+            input->releaseResources();
+        }
+        isPrepared = false;
+    }
+}
+
+void DeckEngine::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    //hosts may hand us more than they promised, so render in prepared-size pieces
+    for (int done = 0; done < bufferToFill.numSamples; done += blockSize)
+    {
+        renderBlock(*bufferToFill.buffer,
+                    bufferToFill.startSample + done,
+                    jmin(blockSize, bufferToFill.numSamples - done));
+    }
+}
+
+//==============================================================================
+void DeckEngine::renderBlock(AudioBuffer<float>& dest, int destStartSample, int numSamples)
+{
+    const int numInputs = inputs.size();
+    const auto blockStart = Time::getHighResolutionTicks();
+    const auto block = ++currentBlock;
+
+    //publish the block. Claims carry the block number, so one left over from the last block fails
+    blockNumSamples.store(numSamples, std::memory_order_relaxed);
+    blockStartTicks.store(blockStart, std::memory_order_relaxed);
+    nextClaim.store((uint64) block << 32, std::memory_order_release);
+
+    //whatever the workers haven't claimed by the time this returns, the audio thread has rendered
+    renderClaimedInputs();
+
+    //so all that's left is at most one input per worker that's already under way. If one was
+    //preempted mid-render, give it the core rather than spin against it, but only until the
+    //block's deadline: after that it's left out of the sum
+    for (int spins = 0; ! allInputsDone(block); ++spins)
+    {
+        if (Time::getHighResolutionTicks() - blockStart > lateInputTicks)
+        {
+            break;
+        }
+
+        if (spins < spinsBeforeYield)
+        {
+            spinPause();
+        }
+        else
+        {
+            Thread::yield();
+        }
+    }
+
+    //decided once, so an input that finishes while we mix doesn't land in one channel only
+    for (int i = 0; i < numInputs; ++i)
+    {
+        auto& state = inputStates[(size_t) i];
+        state.inSum = state.renderedBlock.load(std::memory_order_acquire) == block;
+        if (! state.inSum)
+        {
+            lateInputs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::mix);
+
+    for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+    {
+        dest.clear(ch, destStartSample, numSamples);
+
+        if (ch < 2)
+        {
+            for (int i = 0; i < numInputs; ++i)
+            {
+                if (! inputStates[(size_t) i].inSum)
+                {
+                    continue;
+                }
+
+                const float gain = inputGains.getUnchecked(i);
+                const float appliedGain = appliedInputGains.getUnchecked(i);
+
+                //a moved gain ramps across the block so it doesn't click
+                if (gain != appliedGain)
+                {
+                    dest.addFromWithRamp(ch, destStartSample, inputBuffers.getUnchecked(i)->getReadPointer(ch),
+                                         numSamples, appliedGain, gain);
+                }
+                else if (gain != 0)
+                {
+                    dest.addFrom(ch, destStartSample, *inputBuffers.getUnchecked(i), ch, 0, numSamples, gain);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < numInputs; ++i)
+    {
+        appliedInputGains.set(i, inputGains.getUnchecked(i));
+    }
+}
+
+void DeckEngine::renderClaimedInputs()
+{
+    ScopedNoDenormals noDenormals;
+    const int numInputs = inputs.size();
+
+    for (;;)
+    {
+        auto claim = nextClaim.load(std::memory_order_acquire);
+        int numSamples;
+        do
+        {
+            if ((int) (uint32) claim >= numInputs)
+            {
+                return;
+            }
+            numSamples = blockNumSamples.load(std::memory_order_relaxed);
+        }
+        while (! nextClaim.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        renderInput((uint32) (claim >> 32), (int) (uint32) claim, numSamples);
+    }
+}
+
+void DeckEngine::renderInput(uint32 block, int index, int numSamples)
+{
+    auto& state = inputStates[(size_t) index];
+
+    //still finishing a block it was late for, so it sits this one out too
+    if (state.busy.exchange(true, std::memory_order_acquire))
+    {
+        state.skippedBlock.store(block, std::memory_order_release);
+        return;
+    }
+
+    inputs.getUnchecked(index)->getNextAudioBlock(AudioSourceChannelInfo(inputBuffers.getUnchecked(index), 0, numSamples));
+    state.renderedBlock.store(block, std::memory_order_release);
+    state.busy.store(false, std::memory_order_release);
+}
+
+bool DeckEngine::allInputsDone(uint32 block) const
+{
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        const auto& state = inputStates[(size_t) i];
+        if (state.renderedBlock.load(std::memory_order_acquire) != block
+            && state.skippedBlock.load(std::memory_order_acquire) != block)
+        {
+            return false;
+        }
+    }
+    return true;
+}
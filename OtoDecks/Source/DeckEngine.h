@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    DeckEngine.h
+    Created: 17 Oct 2026 6:48:19pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Renders any number of decks (or sampler channels) in parallel and sums them,
+    in place of MixerAudioSource.
+
+    Every input renders into its own buffer, allocated in prepareToPlay. At the
+    start of each block the audio thread publishes the block number, everyone
+    claims inputs from a shared counter until none are left, and the audio thread
+    sums the buffers once the last one is done. An input still under way when
+    most of the block's time has gone, say stuck on a page fault, is left out of
+    the sum as silence and counted, and sits out blocks until it has caught up.
+    With no workers it all happens on the audio thread, one input after another.
+
+    The audio thread never signals or waits on anything that can block: workers
+    watch the block counter, sleeping a millisecond at a time between blocks and
+    only spinning in a short window around when the next one is due. A worker
+    that's late just finds its inputs already claimed, since the audio thread
+    renders whatever nobody else has.
+*/
+class DeckEngine : public AudioSource
+{
+public:
+    /** numWorkers threads render alongside the audio thread */
+    DeckEngine(int numWorkers);
+    ~DeckEngine();
+
+    /** workers worth having for numInputs inputs on this machine */
+    static int getDefaultNumWorkers(int numInputs);
+
+    /** adds a deck or sampler channel. Call before the audio device starts */
+    void addInput(AudioSource* input);
+    int getNumInputs() const;
+    /** the input's level in the sum, e.g. from the crossfader. Ramped to across the next block (audio thread) */
+    void setInputGain(int index, float gain);
+    int getNumWorkers() const;
+
+    /** what the workers cost, for the benchmarks */
+    struct Stats
+    {
+        /** time all the workers together spent spinning for a block */
+        double workerSpinSeconds = 0;
+        /** inputs left out of a block because they weren't ready by its deadline */
+        int64 lateInputs = 0;
+    };
+    Stats getStats() const;
+    void resetStats();
+
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    class Worker : public Thread
+    {
+    public:
+        Worker(DeckEngine& _engine, int index);
+        void run() override;
+
+    private:
+        DeckEngine& engine;
+    };
+
+    /** renders one block of up to blockSize samples into dest */
+    void renderBlock(AudioBuffer<float>& dest, int destStartSample, int numSamples);
+    /** renders inputs from the shared counter until all of this block's are claimed */
+    void renderClaimedInputs();
+    /** renders the input for block, unless it's still busy with a block it was late for */
+    void renderInput(uint32 block, int index, int numSamples);
+    /** true once every input has rendered block or sat it out (audio thread) */
+    bool allInputsDone(uint32 block) const;
+
+    // each input's progress, so one that misses its block is left out rather than waited for
+    struct InputState
+    {
+        std::atomic<bool> busy{false};
+        std::atomic<uint32> renderedBlock{0};
+        std::atomic<uint32> skippedBlock{0};
+        // whether this block's sum includes it (audio thread)
+        bool inSum = false;
+    };
+
+    Array<AudioSource*> inputs;
+    OwnedArray<AudioBuffer<float>> inputBuffers;
+    // the gain each input was asked for, and the one it was last summed at
+    Array<float> inputGains;
+    Array<float> appliedInputGains;
+    OwnedArray<Worker> workers;
+    std::unique_ptr<InputState[]> inputStates;
+
+    int blockSize = 0;
+    bool isPrepared = false;
+
+    // the block being rendered, published to the workers through nextClaim: the block number in
+    // the top half and the next input to claim in the bottom, so a claim can't cross into a later block
+    std::atomic<int> blockNumSamples{0};
+    std::atomic<uint64> nextClaim{0};
+    // the audio thread's count of blocks, never reset so an old block number can't match a new one
+    uint32 currentBlock = 0;
+    // when the audio thread published the last block, and how far apart blocks come
+    std::atomic<int64> blockStartTicks{0};
+    std::atomic<int64> blockTicks{0};
+    // workers spin from this long before the next block is due until this long after it
+    std::atomic<int64> spinLeadTicks{0};
+    std::atomic<int64> workerSpinTicks{0};
+    // how long the audio thread waits for inputs already under way before leaving them out
+    int64 lateInputTicks = 0;
+    std::atomic<int64> lateInputs{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DeckEngine)
+};
@@ -8,12 +8,13 @@
 //==============================================================================
 DeckGUI::DeckGUI(DJAudioPlayer* _player,
                 PlaylistComponent* _playlistComponent,
-                AudioFormatManager & 	formatManagerToUse,
-                AudioThumbnailCache & 	cacheToUse,
+                WaveformCache & 	cacheToUse,
                 int channelToUse
                 ) : player(_player),
                     playlistComponent(_playlistComponent),
-                    waveformDisplay(formatManagerToUse, cacheToUse),
+                    waveformDisplay(cacheToUse),
+                    scrollingWaveform(cacheToUse, *_player),
+                    levelMeter(_player->getMeter()),
                     channel(channelToUse)
 {
     
@@ -21,11 +22,36 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     addAndMakeVisible(playButton);
     addAndMakeVisible(stopButton);
     addAndMakeVisible(nextButton);
+    addAndMakeVisible(keyLockButton);
+    addAndMakeVisible(syncButton);
+    addAndMakeVisible(masterButton);
     
     //add button listeners for each GUI
     playButton.addListener(this);
     stopButton.addListener(this);
     nextButton.addListener(this);
+    keyLockButton.addListener(this);
+    syncButton.addListener(this);
+    masterButton.addListener(this);
+
+    //hot cue buttons are numbered from 1 and lit once set
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        hotCueButtons[i].setButtonText(String(i + 1));
+        hotCueButtons[i].setColour(TextButton::buttonOnColourId, juce::Colours::darkorange);
+        hotCueButtons[i].addListener(this);
+        addAndMakeVisible(hotCueButtons[i]);
+    }
+    for (auto* button : { &loopInButton, &loopOutButton, &beatLoopButton, &halveLoopButton, &doubleLoopButton })
+    {
+        button->addListener(this);
+        addAndMakeVisible(*button);
+    }
+    beatLoopButton.setColour(TextButton::buttonOnColourId, juce::Colours::mediumspringgreen);
+
+    //sync stays lit while on; master is lit on whichever deck the others follow
+    syncButton.setClickingTogglesState(true);
+    masterButton.setToggleState(player->isSyncMaster(), juce::dontSendNotification);
     
     //add sliders to each GUI
     addAndMakeVisible(volSlider);
@@ -68,8 +94,61 @@ DeckGUI::DeckGUI(DJAudioPlayer* _player,
     speedLabel.attachToComponent(&speedSlider, false);
     speedLabel.setJustificationType(juce::Justification::centred);
 
+    //EQ knobs customisation, all centred at flat and back there on a double-click
+    Slider* eqSliders[] = { &lowSlider, &midSlider, &highSlider, &filterSlider };
+    Label* eqLabels[] = { &lowLabel, &midLabel, &highLabel, &filterLabel };
+    const char* eqNames[] = { "Low", "Mid", "High", "Filter" };
+    for (int i = 0; i < 4; ++i)
+    {
+        eqSliders[i]->setSliderStyle(Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+        eqSliders[i]->setTextBoxStyle(Slider::NoTextBox, false, 0, 0);
+        eqSliders[i]->setPopupDisplayEnabled(true, false, this);
+        eqSliders[i]->addListener(this);
+        addAndMakeVisible(*eqSliders[i]);
+
+        eqLabels[i]->setText(eqNames[i], juce::dontSendNotification);
+        eqLabels[i]->attachToComponent(eqSliders[i], false);
+        eqLabels[i]->setJustificationType(juce::Justification::centred);
+        addAndMakeVisible(*eqLabels[i]);
+    }
+    //fully left kills the band
+    for (auto* slider : { &lowSlider, &midSlider, &highSlider })
+    {
+        slider->setRange(DeckEQ::killDecibels, DeckEQ::maxBoostDecibels, 0.1);
+        slider->setValue(0.0, juce::dontSendNotification);
+        slider->setDoubleClickReturnValue(true, 0.0);
+        slider->setTextValueSuffix(" dB");
+    }
+    //left of centre is the low pass, right is the high pass
+    filterSlider.setRange(-1.0, 1.0, 0.01);
+    filterSlider.setValue(0.0, juce::dontSendNotification);
+    filterSlider.setDoubleClickReturnValue(true, 0.0);
+
+    //qualityBox customisation, ids are the Quality values plus one
+    qualityBox.addItem(VarispeedResampler::getQualityName(VarispeedResampler::Quality::linear), 1);
+    qualityBox.addItem(VarispeedResampler::getQualityName(VarispeedResampler::Quality::cubic), 2);
+    qualityBox.addItem(VarispeedResampler::getQualityName(VarispeedResampler::Quality::sinc), 3);
+    qualityBox.setSelectedId((int) player->getResamplingQuality() + 1, juce::dontSendNotification);
+    qualityBox.addListener(this);
+    addAndMakeVisible(qualityBox);
+
+    //auto advance starts off, with a 4 second crossfade once it's on
+    autoButton.addListener(this);
+    addAndMakeVisible(autoButton);
+    crossfadeBox.addItem("Gapless", 1);
+    for (int i = 1; i < 5; ++i)
+    {
+        crossfadeBox.addItem(String(crossfadeSeconds[i]) + "s fade", i + 1);
+    }
+    crossfadeBox.addListener(this);
+    crossfadeBox.setSelectedId(3);
+    addAndMakeVisible(crossfadeBox);
+
     //adding a waveform to each track on GUI
     addAndMakeVisible(waveformDisplay);
+    waveformDisplay.addMouseListener(this, false);
+    addAndMakeVisible(scrollingWaveform);
+    addAndMakeVisible(levelMeter);
 
     //set colour scheme for sliders 
     getLookAndFeel().setColour(juce::Slider::thumbColourId, juce::Colours::mediumspringgreen); //dial
@@ -113,13 +192,45 @@ void DeckGUI::resized()
     double rowH = getHeight() / 6;
     double colW = getWidth() / 4;
 
-    waveformDisplay.setBounds(0, 0, getWidth(), rowH * 2);
+    //the scrolling view gets most of the height, the whole track's overview the rest
+    double waveH = rowH * 2 - 28;
+    scrollingWaveform.setBounds(0, 0, getWidth(), waveH * 0.6);
+    waveformDisplay.setBounds(0, waveH * 0.6, getWidth(), waveH * 0.4);
+
+    //hot cues along the left half under the waveform, loop controls along the right
+    double cueW = colW * 2 / DJAudioPlayer::numHotCues;
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        hotCueButtons[i].setBounds(cueW * i + 2, rowH * 2 - 26, cueW - 4, 24);
+    }
+    double loopW = colW * 2 / 5;
+    TextButton* loopButtons[] = { &loopInButton, &loopOutButton, &beatLoopButton, &halveLoopButton, &doubleLoopButton };
+    for (int i = 0; i < 5; ++i)
+    {
+        loopButtons[i]->setBounds(colW * 2 + loopW * i + 2, rowH * 2 - 26, loopW - 4, 24);
+    }
 
     posSlider.setBounds(0, rowH * 2, getWidth(), rowH);
 
-    volSlider.setBounds(0, rowH * 3 +20, colW, rowH*3 -30);    
-    speedSlider.setBounds(colW, rowH * 3 +20, colW*1.5, rowH*2 - 30);
-    upNext.setBounds(colW * 2.5, rowH * 3, colW * 1.5 - 20, rowH * 2);
+    volSlider.setBounds(0, rowH * 3 +20, colW * 0.25, rowH*3 -30);
+    levelMeter.setBounds(colW * 0.26, rowH * 3 + 20, colW * 0.13, rowH * 3 - 30);
+
+    //the EQ knobs in a square next to the volume, each with its label above it
+    double eqW = colW * 0.3;
+    double eqH = (rowH * 3 - 30) / 2;
+    lowSlider.setBounds(colW * 0.4, rowH * 3 + 34, eqW, eqH - 16);
+    midSlider.setBounds(colW * 0.7, rowH * 3 + 34, eqW, eqH - 16);
+    highSlider.setBounds(colW * 0.4, rowH * 3 + 34 + eqH, eqW, eqH - 16);
+    filterSlider.setBounds(colW * 0.7, rowH * 3 + 34 + eqH, eqW, eqH - 16);
+    speedSlider.setBounds(colW, rowH * 3 +20, colW*1.5, rowH*2 - 54);
+    keyLockButton.setBounds(colW + 5, rowH * 5 - 32, colW*0.75 - 5, 24);
+    qualityBox.setBounds(colW*1.75, rowH * 5 - 32, colW*0.75 - 5, 24);
+    double syncW = (colW * 1.5 - 24) / 2;
+    syncButton.setBounds(colW * 2.5, rowH * 3, syncW, 24);
+    masterButton.setBounds(colW * 2.5 + syncW + 4, rowH * 3, syncW, 24);
+    upNext.setBounds(colW * 2.5, rowH * 3 + 28, colW * 1.5 - 20, rowH * 2 - 60);
+    autoButton.setBounds(colW * 2.5, rowH * 5 - 28, syncW, 24);
+    crossfadeBox.setBounds(colW * 2.5 + syncW + 4, rowH * 5 - 28, syncW, 24);
 
     playButton.setBounds(colW+10, rowH * 5 + 10, colW-20, rowH-20);
     stopButton.setBounds(colW*2+10, rowH * 5 + 10, colW-20, rowH-20);
@@ -137,10 +248,78 @@ void DeckGUI::buttonClicked(Button* button)
     {
         player->stop();
     }
+    if (button == &keyLockButton)
+    {
+        //keep the pitch while the speed slider changes the tempo
+        player->setKeyLock(keyLockButton.getToggleState());
+    }
+    if (button == &syncButton)
+    {
+        //follow the master deck's tempo and beats, ignoring the speed slider
+        player->setSync(syncButton.getToggleState());
+    }
+    if (button == &masterButton)
+    {
+        player->makeSyncMaster();
+        masterButton.setToggleState(true, juce::dontSendNotification);
+    }
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        if (button == &hotCueButtons[i])
+        {
+            if (ModifierKeys::currentModifiers.isShiftDown())
+            {
+                player->clearHotCue(i);
+            }
+            else if (player->hasHotCue(i))
+            {
+                player->triggerHotCue(i);
+            }
+            else
+            {
+                player->setHotCue(i);
+            }
+        }
+    }
+    if (button == &loopInButton)
+    {
+        player->setLoopIn();
+    }
+    if (button == &loopOutButton)
+    {
+        player->setLoopOut();
+    }
+    if (button == &beatLoopButton)
+    {
+        if (player->isLooping())
+        {
+            player->exitLoop();
+        }
+        else
+        {
+            player->setBeatLoop(4.0);
+        }
+    }
+    if (button == &halveLoopButton)
+    {
+        player->halveLoop();
+    }
+    if (button == &doubleLoopButton)
+    {
+        player->doubleLoop();
+    }
+    if (button == &autoButton)
+    {
+        player->setAutoAdvance(autoButton.getToggleState());
+    }
     if (button == &nextButton)
     {
+        //with auto advance on the next song is usually waiting on the audio thread already, so NEXT
+        //crossfades into it and the list moves on once the player has
+        const bool skipped = nextButton.getButtonText() == "NEXT" && player->skipToNext();
+
        //handling next button for left channel
-        if (channel == 0 && playlistComponent->playListLeft.size() > 0) //handle only if there are songs added 
+        if (! skipped && channel == 0 && playlistComponent->playListLeft.size() > 0) //handle only if there are songs added 
         {
             //get URL to first song of Left playlist
             URL fileURL = URL{ File{playlistComponent->playListLeft[0]} }; 
@@ -149,11 +328,11 @@ void DeckGUI::buttonClicked(Button* button)
             //display the waveforms
             waveformDisplay.loadURL(fileURL);
             //pop the first URL of the Left playlist so it doesn't replay
-            playlistComponent->playListLeft.erase(playlistComponent->playListLeft.begin()); 
+            playlistComponent->playListLeft.pop_front();
         }
 
         //handling next button for right channel
-        if (channel == 1 && playlistComponent->playListRight.size() > 0)
+        if (! skipped && channel == 1 && playlistComponent->playListRight.size() > 0)
         {
             //get URL to first song of playlist
             URL fileURL = URL{ File{playlistComponent->playListRight[0]} }; 
@@ -162,7 +341,7 @@ void DeckGUI::buttonClicked(Button* button)
             //display the waveforms
             waveformDisplay.loadURL(fileURL);
             //pop the first URL of the Right playlist so it doesn't replay
-            playlistComponent->playListRight.erase(playlistComponent->playListRight.begin()); //remove first element
+            playlistComponent->playListRight.pop_front(); //remove first element
         }
 
         //Buttons starts with indicating load. Once first songs have been loaded, we can change it to next 
@@ -178,6 +357,9 @@ void DeckGUI::buttonClicked(Button* button)
 
     //refresh up next table whenever a button is clicked
     upNext.updateContent();
+    updateCueButtons();
+
+    preloadUpNext();
 }
 
 void DeckGUI::sliderValueChanged (Slider *slider)
@@ -196,9 +378,42 @@ void DeckGUI::sliderValueChanged (Slider *slider)
     {
         player->setPositionRelative(slider->getValue());
     }
+
+    if (slider == &lowSlider)
+    {
+        player->setEqBand(DeckEQ::Band::low, slider->getValue());
+    }
+
+    if (slider == &midSlider)
+    {
+        player->setEqBand(DeckEQ::Band::mid, slider->getValue());
+    }
+
+    if (slider == &highSlider)
+    {
+        player->setEqBand(DeckEQ::Band::high, slider->getValue());
+    }
+
+    if (slider == &filterSlider)
+    {
+        player->setFilter(slider->getValue());
+    }
     
 }
 
+void DeckGUI::comboBoxChanged(ComboBox* comboBox)
+{
+    if (comboBox == &qualityBox)
+    {
+        player->setResamplingQuality((VarispeedResampler::Quality) (qualityBox.getSelectedId() - 1));
+    }
+
+    if (comboBox == &crossfadeBox)
+    {
+        player->setAdvanceCrossfade(crossfadeSeconds[crossfadeBox.getSelectedId() - 1]);
+    }
+}
+
 int DeckGUI::getNumRows()
 {
     //number of rows in the table depends on the number of songs loaded to the respective channels
@@ -210,6 +425,8 @@ int DeckGUI::getNumRows()
     {
         return playlistComponent->playListRight.size();
     }
+    //the other decks have no list of their own
+    return 0;
 }
 
 void DeckGUI::paintRowBackground(Graphics & g,
@@ -256,25 +473,148 @@ void DeckGUI::paintCell(Graphics & g,
 
 }
 
-    // bool DeckGUI::isInterestedInFileDrag (const StringArray &files)
-    // {
-    // std::cout << "DeckGUI::isInterestedInFileDrag" << std::endl;
-    // return true; 
-    // }
-
-    // void DeckGUI::filesDropped (const StringArray &files, int x, int y)
-    // {
-    // std::cout << "DeckGUI::filesDropped" << std::endl;
-    // if (files.size() == 1)
-    // {
-    //     player->loadURL(URL{File{files[0]}});
-    // }
-    // }
+bool DeckGUI::isInterestedInFileDrag (const StringArray &files)
+{
+    return true; 
+}
+
+void DeckGUI::filesDropped (const StringArray &files, int x, int y)
+{
+    if (files.size() == 1)
+    {
+        URL fileURL = URL{File{files[0]}};
+        player->loadURL(fileURL);
+        waveformDisplay.loadURL(fileURL);
+    }
+}
 
 void DeckGUI::timerCallback()
 {
     waveformDisplay.setPositionRelative(
             player->getPositionRelative());
+
+    //while scratching the timer runs fast, just for the scratch
+    if (player->isScratching())
+    {
+        updateScratch();
+        return;
+    }
+
+    //the player moved on to the head of the list by itself. A song it had queued before the
+    //list changed doesn't come off it
+    if (player->getNumAdvances() != numAdvances)
+    {
+        numAdvances = player->getNumAdvances();
+        auto* list = getUpNextList();
+        if (list != nullptr && ! list->empty() && URL{ File{list->front()} } == player->getURL())
+        {
+            list->pop_front();
+            upNext.updateContent();
+        }
+        waveformDisplay.loadURL(player->getURL());
+    }
+
+    //tracks can be queued from the library at any time, so keep checking the head of the list
+    preloadUpNext();
+
+    //another deck may have taken over as master
+    masterButton.setToggleState(player->isSyncMaster(), juce::dontSendNotification);
+
+    //loading a track clears its cues and loop
+    updateCueButtons();
+
+    //the tempo once the track's beatgrid is known
+    const double tempo = player->getTempo();
+    speedLabel.setText(tempo > 0 ? "Speed X  " + String(tempo, 1) + " BPM" : "Speed X", juce::dontSendNotification);
+}
+
+void DeckGUI::mouseDown (const MouseEvent& event)
+{
+    if (event.eventComponent != &waveformDisplay)
+    {
+        return;
+    }
+
+    player->startScratch();
+    if (player->isScratching())
+    {
+        scratchX = lastScratchX = event.position.x;
+        lastScratchTime = Time::getMillisecondCounterHiRes();
+        scratchRate = 0;
+        player->setScratchRate(0);
+        startTimerHz(60);
+    }
+}
+
+void DeckGUI::mouseDrag (const MouseEvent& event)
+{
+    if (event.eventComponent == &waveformDisplay)
+    {
+        scratchX = event.position.x;
+    }
+}
+
+void DeckGUI::mouseUp (const MouseEvent& event)
+{
+    if (event.eventComponent == &waveformDisplay && player->isScratching())
+    {
+        player->stopScratch();
+        startTimer(500);
+    }
+}
+
+void DeckGUI::updateScratch()
+{
+    //how far the track moves per pixel dragged, about a record's feel at this size
+    const double secondsPerPixel = 0.005;
+
+    const double now = Time::getMillisecondCounterHiRes();
+    const double elapsed = jmax(1.0, now - lastScratchTime) / 1000.0;
+
+    //a little smoothing, since mouse moves arrive in uneven steps; holding still stops the track
+    const double rate = (scratchX - lastScratchX) * secondsPerPixel / elapsed;
+    scratchRate = 0.5 * scratchRate + 0.5 * rate;
+    player->setScratchRate(scratchRate);
+
+    lastScratchX = scratchX;
+    lastScratchTime = now;
+}
+
+void DeckGUI::preloadUpNext()
+{
+    auto* list = getUpNextList();
+    if (list != nullptr)
+    {
+        player->queueNext(list->empty() ? URL() : URL{ File{list->front()} });
+    }
+}
+
+std::deque<std::string>* DeckGUI::getUpNextList()
+{
+    if (channel == 0)
+    {
+        return &playlistComponent->playListLeft;
+    }
+    if (channel == 1)
+    {
+        return &playlistComponent->playListRight;
+    }
+    return nullptr;
+}
+
+void DeckGUI::updateCueButtons()
+{
+    //a cue or loop is lit dimly while its audio is still being decoded
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        const bool pending = player->isHotCuePending(i);
+        hotCueButtons[i].setColour(TextButton::buttonOnColourId,
+                                   pending ? juce::Colours::darkorange.withAlpha(0.4f) : juce::Colours::darkorange);
+        hotCueButtons[i].setToggleState(player->hasHotCue(i) || pending, juce::dontSendNotification);
+    }
+    beatLoopButton.setColour(TextButton::buttonOnColourId, player->isLoopPending()
+                                 ? juce::Colours::mediumspringgreen.withAlpha(0.4f) : juce::Colours::mediumspringgreen);
+    beatLoopButton.setToggleState(player->isLooping(), juce::dontSendNotification);
 }
 
 
@@ -5,6 +5,8 @@
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
 #include "WaveformDisplay.h"
+#include "ScrollingWaveform.h"
+#include "LevelMeterComponent.h"
 #include "PlaylistComponent.h"
 
 //==============================================================================
@@ -13,14 +15,15 @@
 class DeckGUI    : public Component,
                    public Button::Listener, 
                    public Slider::Listener,
+                   public ComboBox::Listener,
                    public TableListBoxModel, 
+                   public FileDragAndDropTarget,
                    public Timer
 {
 public:
     DeckGUI(DJAudioPlayer* player,
            PlaylistComponent* playlistComponent, 
-           AudioFormatManager & formatManagerToUse,
-           AudioThumbnailCache & cacheToUse,
+           WaveformCache & cacheToUse,
            int channeToUse );
 
     ~DeckGUI();
@@ -38,6 +41,10 @@ public:
     //called upon when the slider's value is changed, interacting with the volume, speed and playback sliders, with the player
     void sliderValueChanged (Slider *slider) override;
 
+    /** implement ComboBox::Listener */
+    //called upon when a different resampling quality is picked for the player
+    void comboBoxChanged (ComboBox* comboBox) override;
+
     //returns the number of rows currently in the table
     int getNumRows() override;
 
@@ -58,24 +65,77 @@ public:
         int height,
         bool rowIsSelected) override;
 
+    /** implement FileDragAndDropTarget */
+    //decks past the first two have no up next list, so a track is dropped straight onto them
+    bool isInterestedInFileDrag (const StringArray &files) override;
+    void filesDropped (const StringArray &files, int x, int y) override;
+
     //to allow callback for updating the waveform's visuals
     void timerCallback() override; 
 
+    /** implement MouseListener, for the waveform */
+    //dragging the waveform scratches the track, left to right being forwards
+    void mouseDown (const MouseEvent& event) override;
+    void mouseDrag (const MouseEvent& event) override;
+    void mouseUp (const MouseEvent& event) override;
+
 private:
 
+    //queues the first track of this deck's up next list on the player, so NEXT is instant
+    void preloadUpNext();
+
+    //this deck's up next list, nullptr for the decks without one
+    std::deque<std::string>* getUpNextList();
+
+    //lights the hot cues that are set and the loop button while looping, dimly until their audio is decoded
+    void updateCueButtons();
+
+    //turns the mouse's movement since the last tick into a scratch rate
+    void updateScratch();
+
     //creating the buttons
     TextButton playButton{"PLAY"};
     TextButton stopButton{"STOP"};
     TextButton nextButton{"LOAD"};
+    ToggleButton keyLockButton{"KEY LOCK"};
+    TextButton syncButton{"SYNC"};
+    TextButton masterButton{"MASTER"};
+    //hot cues: click to set, click again to jump there, shift-click to clear
+    TextButton hotCueButtons[DJAudioPlayer::numHotCues];
+    //loop controls; LOOP toggles a 4 beat loop
+    TextButton loopInButton{"IN"};
+    TextButton loopOutButton{"OUT"};
+    TextButton beatLoopButton{"LOOP"};
+    TextButton halveLoopButton{"1/2"};
+    TextButton doubleLoopButton{"x2"};
+
+    //picking the player's resampling quality
+    ComboBox qualityBox;
+
+    //moving on to the next track in the list by itself, and how long the tracks overlap when it does
+    ToggleButton autoButton{"AUTO"};
+    ComboBox crossfadeBox;
+    const double crossfadeSeconds[5] = { 0, 2, 4, 8, 16 };
+    //the player's advances this deck has taken off the list
+    int numAdvances = 0;
     
     //creating the sliders
     Slider volSlider; 
     Slider speedSlider;
     Slider posSlider;
+    //the deck's EQ bands and filter sweep
+    Slider lowSlider;
+    Slider midSlider;
+    Slider highSlider;
+    Slider filterSlider;
 
     //adding labels to the sliders
     Label volLabel;
     Label speedLabel;
+    Label lowLabel;
+    Label midLabel;
+    Label highLabel;
+    Label filterLabel;
 
     //controlling the visual theme
     LookAndFeel_V4 lookAndFeel;
@@ -85,10 +145,21 @@ private:
 
     //creating the waveform display (visual)
     WaveformDisplay waveformDisplay;
+    //the few seconds around the playhead, above the whole track's waveform
+    ScrollingWaveform scrollingWaveform;
+
+    //the deck's output levels, next to its volume
+    LevelMeterComponent levelMeter;
 
     //creating a table containing a list of upcoming songs in the playlist
     TableListBox upNext;
 
+    //where the mouse is while scratching, and where it was at the last tick
+    float scratchX = 0;
+    float lastScratchX = 0;
+    double lastScratchTime = 0;
+    double scratchRate = 0;
+
     //variable indicating the channel that's associated with the GUI (Left & Right)
     int channel;
 
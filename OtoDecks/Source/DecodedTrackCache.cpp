@@ -0,0 +1,679 @@
+/*
+  ==============================================================================
+
+    DecodedTrackCache.cpp
+    Created: 17 Oct 2026 1:41:05pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DecodedTrackCache.h"
+#include "SampleRateConverter.h"
+
+namespace
+{
+    // planar PCM file: magic, version, channels, format, sample rate, length, bpm, first beat,
+    // the size of the key and padding, then the cache key of the track it was decoded from,
+    // padded so the samples stay aligned, then each channel in turn
+    const char* const pcmFileMagic = "OTPC";
+    const int pcmFileVersion = 3;
+    const int pcmFileHeaderSize = 56;
+
+    /** where the samples start in a file whose key takes keyBytes */
+    int64 getPcmDataOffset(int64 keyBytes)
+    {
+        return pcmFileHeaderSize + ((keyBytes + 7) & ~(int64) 7);
+    }
+    const int formatFloat = 0;
+    const int formatInt16 = 1;
+}
+
+//==============================================================================
+DecodedTrack::DecodedTrack(AudioBuffer<float>&& _samples, double _sampleRate, const Beatgrid& _beatgrid)
+            : samples(std::move(_samples)),
+              numChannels(samples.getNumChannels()),
+              lengthInSamples(samples.getNumSamples()),
+              sampleRate(_sampleRate),
+              beatgrid(_beatgrid)
+{
+}
+
+DecodedTrack::Ptr DecodedTrack::openMapped(const File& file, const String& key)
+{
+    if (! file.existsAsFile())
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<MemoryMappedFile> mapped (new MemoryMappedFile(file, MemoryMappedFile::readOnly));
+    if (mapped->getData() == nullptr || mapped->getSize() < (size_t) pcmFileHeaderSize)
+    {
+        return nullptr;
+    }
+
+    auto* data = static_cast<const char*>(mapped->getData());
+    if (std::memcmp(data, pcmFileMagic, 4) != 0)
+    {
+        return nullptr;
+    }
+
+    int32 version, channels, format, keyBytes;
+    double rate, bpm, firstBeat;
+    int64 length;
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&channels, data + 8, 4);
+    std::memcpy(&format, data + 12, 4);
+    std::memcpy(&rate, data + 16, 8);
+    std::memcpy(&length, data + 24, 8);
+    std::memcpy(&bpm, data + 32, 8);
+    std::memcpy(&firstBeat, data + 40, 8);
+    std::memcpy(&keyBytes, data + 48, 4);
+
+    auto bytesPerSample = format == formatInt16 ? 2 : 4;
+    auto dataOffset = getPcmDataOffset(keyBytes);
+    if (version != pcmFileVersion || channels < 1 || channels > 2 || length <= 0 || keyBytes < 0
+        || (format != formatFloat && format != formatInt16)
+        || mapped->getSize() != (size_t) (dataOffset + channels * length * bytesPerSample))
+    {
+        //half written or from an older build, the caller will decode it again
+        return nullptr;
+    }
+
+    //files are named by a hash of the key, so two tracks can land on the same name
+    if (String::fromUTF8(data + pcmFileHeaderSize, keyBytes) != key)
+    {
+        return nullptr;
+    }
+
+    Ptr track (new DecodedTrack());
+    track->numChannels = channels;
+    track->lengthInSamples = length;
+    track->sampleRate = rate;
+    track->beatgrid = { bpm, firstBeat };
+
+    for (int chan = 0; chan < channels; ++chan)
+    {
+        auto* channelData = data + dataOffset + chan * length * bytesPerSample;
+        if (format == formatInt16)
+        {
+            track->mappedInt16[chan] = reinterpret_cast<const int16*>(channelData);
+        }
+        else
+        {
+            track->mappedFloat[chan] = reinterpret_cast<const float*>(channelData);
+        }
+    }
+
+    track->mappedFile = std::move(mapped);
+    return track;
+}
+
+bool DecodedTrack::writeToFile(const File& file, const String& key, bool asInt16) const
+{
+    //only RAM tracks are ever spilled
+    jassert(isInMemory());
+
+    //write next to the target and move it into place, so a reader never maps half a file
+    auto tempFile = file.getSiblingFile(file.getFileName() + ".part");
+    {
+        FileOutputStream out(tempFile);
+        if (! out.openedOk())
+        {
+            return false;
+        }
+        out.truncate();
+
+        out.write(pcmFileMagic, 4);
+        out.writeInt(pcmFileVersion);
+        out.writeInt(numChannels);
+        out.writeInt(asInt16 ? formatInt16 : formatFloat);
+        out.writeDouble(sampleRate);
+        out.writeInt64(lengthInSamples);
+        out.writeDouble(beatgrid.bpm);
+        out.writeDouble(beatgrid.firstBeat);
+
+        const auto keyBytes = (int) key.getNumBytesAsUTF8();
+        out.writeInt(keyBytes);
+        out.writeInt(0);
+        out.write(key.toRawUTF8(), (size_t) keyBytes);
+        out.writeRepeatedByte(0, (size_t) (getPcmDataOffset(keyBytes) - pcmFileHeaderSize - keyBytes));
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            auto* channelData = samples.getReadPointer(chan);
+
+            if (! asInt16)
+            {
+                out.write(channelData, (size_t) lengthInSamples * sizeof(float));
+                continue;
+            }
+
+            const int chunkSize = 8192;
+            HeapBlock<int16> chunk(chunkSize);
+            for (int64 pos = 0; pos < lengthInSamples; pos += chunkSize)
+            {
+                auto numThisTime = (int) jmin((int64) chunkSize, lengthInSamples - pos);
+                for (int i = 0; i < numThisTime; ++i)
+                {
+                    chunk[i] = (int16) roundToInt(jlimit(-1.0f, 1.0f, channelData[pos + i]) * 32767.0f);
+                }
+                out.write(chunk.getData(), (size_t) numThisTime * sizeof(int16));
+            }
+        }
+
+        out.flush();
+    }
+
+    return tempFile.moveFileTo(file);
+}
+
+void DecodedTrack::read(AudioBuffer<float>& dest, int destStartSample, int64 startSample, int numSamples) const
+{
+    auto validStart = (int) jlimit((int64) 0, (int64) numSamples, -startSample);
+    auto validEnd = (int) jlimit((int64) 0, (int64) numSamples, lengthInSamples - startSample);
+
+    for (int chan = 0; chan < dest.getNumChannels(); ++chan)
+    {
+        auto* out = dest.getWritePointer(chan, destStartSample);
+
+        if (validStart >= validEnd || numChannels == 0)
+        {
+            FloatVectorOperations::clear(out, numSamples);
+            continue;
+        }
+
+        FloatVectorOperations::clear(out, validStart);
+        FloatVectorOperations::clear(out + validEnd, numSamples - validEnd);
+
+        auto sourceChannel = jmin(chan, numChannels - 1);
+        auto sourceStart = startSample + validStart;
+        auto count = validEnd - validStart;
+
+        if (mappedFile == nullptr)
+        {
+            FloatVectorOperations::copy(out + validStart, samples.getReadPointer(sourceChannel, (int) sourceStart), count);
+        }
+        else if (mappedFloat[sourceChannel] != nullptr)
+        {
+            FloatVectorOperations::copy(out + validStart, mappedFloat[sourceChannel] + sourceStart, count);
+        }
+        else
+        {
+            auto* in = mappedInt16[sourceChannel] + sourceStart;
+            const float scale = 1.0f / 32767.0f;
+            for (int i = 0; i < count; ++i)
+            {
+                out[validStart + i] = in[i] * scale;
+            }
+        }
+    }
+}
+
+int DecodedTrack::getNumChannels() const
+{
+    return numChannels;
+}
+
+int64 DecodedTrack::getLengthInSamples() const
+{
+    return lengthInSamples;
+}
+
+double DecodedTrack::getSampleRate() const
+{
+    return sampleRate;
+}
+
+double DecodedTrack::getLengthInSeconds() const
+{
+    return sampleRate > 0 ? lengthInSamples / sampleRate : 0.0;
+}
+
+const Beatgrid& DecodedTrack::getBeatgrid() const
+{
+    return beatgrid;
+}
+
+bool DecodedTrack::isInMemory() const
+{
+    return mappedFile == nullptr;
+}
+
+int64 DecodedTrack::getMemoryUsage() const
+{
+    return isInMemory() ? (int64) numChannels * lengthInSamples * (int64) sizeof(float) : 0;
+}
+
+//==============================================================================
+DecodedTrackSource::DecodedTrackSource(DecodedTrack::Ptr _track)
+                  : track(_track)
+{
+}
+
+void DecodedTrackSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+}
+
+void DecodedTrackSource::releaseResources()
+{
+}
+
+void DecodedTrackSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    auto pos = position.load();
+    track->read(*bufferToFill.buffer, bufferToFill.startSample, pos, bufferToFill.numSamples);
+
+    //the track is in RAM, so a seek can only land mid-copy if the transport moved; its position wins
+    position.compare_exchange_strong(pos, pos + bufferToFill.numSamples);
+}
+
+void DecodedTrackSource::setNextReadPosition(int64 newPosition)
+{
+    position = newPosition;
+}
+
+int64 DecodedTrackSource::getNextReadPosition() const
+{
+    return position;
+}
+
+int64 DecodedTrackSource::getTotalLength() const
+{
+    return track->getLengthInSamples();
+}
+
+bool DecodedTrackSource::isLooping() const
+{
+    return false;
+}
+
+//==============================================================================
+double DecodedTrackCache::Stats::getHitRate() const
+{
+    return hits + misses > 0 ? hits / (double) (hits + misses) : 0.0;
+}
+
+DecodedTrackCache::DecodedTrackCache(AudioFormatManager& _formatManager,
+                                     int64 memoryBudgetBytes,
+                                     File _cacheDirectory)
+                 : formatManager(_formatManager),
+                   cacheDirectory(_cacheDirectory),
+                   memoryBudget(memoryBudgetBytes)
+{
+    if (cacheDirectory == File())
+    {
+        cacheDirectory = File::getSpecialLocation(File::userApplicationDataDirectory)
+                             .getChildFile("OtoDecks")
+                             .getChildFile("PCM Cache");
+    }
+    cacheDirectory.createDirectory();
+}
+
+DecodedTrackCache::~DecodedTrackCache()
+{
+    decodePool.removeAllJobs(true, 10000);
+}
+
+void DecodedTrackCache::setMemoryBudget(int64 numBytes)
+{
+    memoryBudget = numBytes;
+}
+
+void DecodedTrackCache::setDiskBudget(int64 numBytes)
+{
+    diskBudget = numBytes;
+}
+
+void DecodedTrackCache::setDiskSampleFormat(bool useInt16)
+{
+    diskAsInt16 = useInt16;
+}
+
+void DecodedTrackCache::setSampleRate(double newSampleRate)
+{
+    //every deck passes the device's rate on when it's prepared, so most calls change nothing
+    if (sampleRate.exchange(newSampleRate) == newSampleRate || newSampleRate <= 0)
+    {
+        return;
+    }
+
+    Array<File> filesToConvert;
+    {
+        const ScopedLock sl(lock);
+        for (auto& item : entries)
+        {
+            if (item.second.track != nullptr && item.second.track->isInMemory() && ! isAtSampleRate(*item.second.track))
+            {
+                filesToConvert.add(item.second.file);
+            }
+        }
+    }
+
+    //decks keep playing their copies at the old rate, resampled on the fly, until they load the new ones
+    for (auto& file : filesToConvert)
+    {
+        decodeInBackground(file);
+    }
+}
+
+DecodedTrack::Ptr DecodedTrackCache::getTrack(const File& file)
+{
+    auto key = getKeyFor(file);
+    const double targetRate = sampleRate;
+    {
+        const ScopedLock sl(lock);
+
+        auto found = entries.find(key);
+        if (found != entries.end() && found->second.track != nullptr && isAtSampleRate(*found->second.track))
+        {
+            ++hits;
+            found->second.lastUsed = ++useCounter;
+            found->second.file = file;
+            return found->second.track;
+        }
+    }
+
+    //not in RAM, try the disk tier. That's a stat, an open and a map, so it's done outside the
+    //lock, where it can't hold up the other decks
+    DecodedTrack::Ptr mapped;
+    if (targetRate > 0)
+    {
+        mapped = DecodedTrack::openMapped(getDiskFileFor(key, targetRate), key);
+    }
+
+    const ScopedLock sl(lock);
+
+    //a copy converted for another device is replaced, decks can have this one once it's converted
+    //again. One that arrived from another thread meanwhile is kept
+    auto& entry = entries[key];
+    if (entry.track == nullptr || ! isAtSampleRate(*entry.track))
+    {
+        entry.track = mapped;
+    }
+
+    if (entry.track == nullptr)
+    {
+        entries.erase(key);
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    entry.lastUsed = ++useCounter;
+    entry.file = file;
+    return entry.track;
+}
+
+DecodedTrack::Ptr DecodedTrackCache::decodeNow(const File& file)
+{
+    auto key = getKeyFor(file);
+    const double targetRate = sampleRate;
+    {
+        const ScopedLock sl(lock);
+
+        auto found = entries.find(key);
+        if (found != entries.end() && found->second.track != nullptr && isAtSampleRate(*found->second.track))
+        {
+            return found->second.track;
+        }
+    }
+
+    //the disk tier is looked up outside the lock, as in getTrack
+    if (targetRate > 0)
+    {
+        auto mapped = DecodedTrack::openMapped(getDiskFileFor(key, targetRate), key);
+        if (mapped != nullptr)
+        {
+            const ScopedLock sl(lock);
+
+            auto& entry = entries[key];
+            if (entry.track == nullptr || ! isAtSampleRate(*entry.track))
+            {
+                entry = { mapped, ++useCounter, file };
+            }
+            return entry.track;
+        }
+    }
+
+    std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0)
+    {
+        return nullptr;
+    }
+
+    auto numChannels = jmin(2, (int) reader->numChannels);
+    AudioBuffer<float> samples(numChannels, (int) reader->lengthInSamples);
+    reader->read(&samples, 0, samples.getNumSamples(), 0, true, numChannels > 1);
+
+    //analysed once here, then carried with the track into the disk tier
+    auto beatgrid = Beatgrid::analyse(samples, reader->sampleRate);
+
+    //converted once to the device's rate, so the decks only resample to change the tempo
+    if (targetRate > 0 && targetRate != reader->sampleRate)
+    {
+        samples = SampleRateConverter::convert(samples, reader->sampleRate, targetRate);
+    }
+    DecodedTrack::Ptr track (new DecodedTrack(std::move(samples), targetRate > 0 ? targetRate : reader->sampleRate, beatgrid));
+    {
+        const ScopedLock sl(lock);
+        entries[key] = { track, ++useCounter, file };
+    }
+
+    spillToBudget();
+    return track;
+}
+
+void DecodedTrackCache::decodeInBackground(const File& file)
+{
+    auto key = getKeyFor(file);
+    {
+        const ScopedLock sl(lock);
+
+        auto found = entries.find(key);
+        if ((found != entries.end() && found->second.track != nullptr && isAtSampleRate(*found->second.track))
+            || keysBeingDecoded.contains(key))
+        {
+            return;
+        }
+        keysBeingDecoded.add(key);
+    }
+
+    decodePool.addJob([this, file, key]
+    {
+        auto track = decodeNow(file);
+        if (track != nullptr && ! isAtSampleRate(*track))
+        {
+            //the device's rate changed while this one was being converted
+            decodeNow(file);
+        }
+        {
+            const ScopedLock sl(lock);
+            keysBeingDecoded.removeString(key);
+        }
+        sendChangeMessage();
+    });
+}
+
+double DecodedTrackCache::getLengthInSeconds(const File& file)
+{
+    auto key = getKeyFor(file);
+    {
+        const ScopedLock sl(lock);
+
+        auto found = entries.find(key);
+        if (found != entries.end() && found->second.track != nullptr)
+        {
+            return found->second.track->getLengthInSeconds();
+        }
+    }
+
+    //the reader only parses the header here, nothing gets decoded
+    std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0)
+    {
+        return 0.0;
+    }
+    return reader->lengthInSamples / reader->sampleRate;
+}
+
+Beatgrid DecodedTrackCache::getBeatgrid(const File& file)
+{
+    auto key = getKeyFor(file);
+    const ScopedLock sl(lock);
+
+    //no hit or miss counted, this isn't a load
+    auto found = entries.find(key);
+    if (found != entries.end() && found->second.track != nullptr)
+    {
+        return found->second.track->getBeatgrid();
+    }
+    return {};
+}
+
+DecodedTrackCache::Stats DecodedTrackCache::getStats() const
+{
+    Stats stats;
+    const ScopedLock sl(lock);
+
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.memoryBudget = memoryBudget;
+
+    for (auto& item : entries)
+    {
+        if (item.second.track == nullptr)
+        {
+            continue;
+        }
+        if (item.second.track->isInMemory())
+        {
+            ++stats.tracksInMemory;
+            stats.memoryUsage += item.second.track->getMemoryUsage();
+        }
+        else
+        {
+            ++stats.tracksOnDisk;
+        }
+    }
+
+    for (auto& cacheFile : cacheDirectory.findChildFiles(File::findFiles, false, "*.pcm"))
+    {
+        stats.diskUsage += cacheFile.getSize();
+    }
+    return stats;
+}
+
+String DecodedTrackCache::getKeyFor(const File& file)
+{
+    return file.getFullPathName()
+         + "|" + String(file.getSize())
+         + "|" + String(file.getLastModificationTime().toMilliseconds());
+}
+
+bool DecodedTrackCache::isAtSampleRate(const DecodedTrack& track) const
+{
+    const double rate = sampleRate;
+    return rate <= 0 || track.getSampleRate() == rate;
+}
+
+File DecodedTrackCache::getDiskFileFor(const String& key, double rate) const
+{
+    return cacheDirectory.getChildFile(String::toHexString(key.hashCode64()) + "-" + String(roundToInt(rate)) + ".pcm");
+}
+
+void DecodedTrackCache::spillToBudget()
+{
+    while (true)
+    {
+        String victimKey;
+        DecodedTrack::Ptr victim;
+        {
+            const ScopedLock sl(lock);
+
+            int64 memoryUsage = 0;
+            uint64 oldest = std::numeric_limits<uint64>::max();
+
+            for (auto& item : entries)
+            {
+                if (item.second.track == nullptr || ! item.second.track->isInMemory())
+                {
+                    continue;
+                }
+                memoryUsage += item.second.track->getMemoryUsage();
+
+                //never spill the track that was just used, it is about to be played
+                if (item.second.lastUsed < oldest && item.second.lastUsed != useCounter)
+                {
+                    oldest = item.second.lastUsed;
+                    victimKey = item.first;
+                    victim = item.second.track;
+                }
+            }
+
+            if (memoryUsage <= memoryBudget || victim == nullptr)
+            {
+                return;
+            }
+        }
+
+        //the slow write happens outside the lock; the RAM copy stays valid until it's done
+        auto diskFile = getDiskFileFor(victimKey, victim->getSampleRate());
+        auto written = victim->writeToFile(diskFile, victimKey, diskAsInt16);
+        if (! written)
+        {
+            std::cout << "DecodedTrackCache::spillToBudget could not write " << diskFile.getFullPathName() << std::endl;
+        }
+
+        {
+            const ScopedLock sl(lock);
+
+            //decks still playing the RAM copy keep it alive through their own reference
+            auto found = entries.find(victimKey);
+            if (found != entries.end() && found->second.track == victim)
+            {
+                if (written)
+                {
+                    found->second.track = nullptr;
+                }
+                else
+                {
+                    entries.erase(found);
+                }
+            }
+        }
+
+        trimDiskTier();
+    }
+}
+
+void DecodedTrackCache::trimDiskTier()
+{
+    auto cacheFiles = cacheDirectory.findChildFiles(File::findFiles, false, "*.pcm");
+
+    int64 diskUsage = 0;
+    for (auto& cacheFile : cacheFiles)
+    {
+        diskUsage += cacheFile.getSize();
+    }
+
+    //oldest files go first; a file that is still mapped survives until it's unmapped
+    std::sort(cacheFiles.begin(), cacheFiles.end(), [] (const File& a, const File& b)
+    {
+        return a.getLastModificationTime().toMilliseconds() < b.getLastModificationTime().toMilliseconds();
+    });
+
+    for (auto& cacheFile : cacheFiles)
+    {
+        if (diskUsage <= diskBudget)
+        {
+            break;
+        }
+        auto size = cacheFile.getSize();
+        if (cacheFile.deleteFile())
+        {
+            diskUsage -= size;
+        }
+    }
+}
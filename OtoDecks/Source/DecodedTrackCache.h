@@ -0,0 +1,193 @@
+/*
+  ==============================================================================
+
+    DecodedTrackCache.h
+    Created: 17 Oct 2026 1:41:05pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include "Beatgrid.h"
+
+//==============================================================================
+/*
+    A whole track decoded to PCM. The samples either live in RAM or in a
+    memory-mapped file from the cache's disk tier; both are read the same way.
+    Immutable once built, so decks and the cache can share it freely.
+*/
+class DecodedTrack : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<DecodedTrack>;
+
+    /** keeps the decoded samples in RAM */
+    DecodedTrack(AudioBuffer<float>&& _samples, double _sampleRate, const Beatgrid& _beatgrid = {});
+
+    /** maps a PCM file written by writeToFile() for the same key, returns nullptr if it isn't one */
+    static Ptr openMapped(const File& file, const String& key);
+
+    /** writes the samples as planar float or int16 PCM for the disk tier. key names the track
+        they were decoded from, so a file can't be mapped for a different one */
+    bool writeToFile(const File& file, const String& key, bool asInt16) const;
+
+    /** copies samples into dest, repeating mono into every channel. Anything outside the track is silence */
+    void read(AudioBuffer<float>& dest, int destStartSample, int64 startSample, int numSamples) const;
+
+    int getNumChannels() const;
+    int64 getLengthInSamples() const;
+    double getSampleRate() const;
+    double getLengthInSeconds() const;
+    /** analysed when the track was decoded; invalid if it has no steady beat */
+    const Beatgrid& getBeatgrid() const;
+
+    /** true for the RAM tier, false when backed by a mapped file */
+    bool isInMemory() const;
+    /** RAM held by the samples, 0 for mapped tracks */
+    int64 getMemoryUsage() const;
+
+private:
+    DecodedTrack() = default;
+
+    AudioBuffer<float> samples;
+
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    const float* mappedFloat[2] = {};
+    const int16* mappedInt16[2] = {};
+
+    int numChannels = 0;
+    int64 lengthInSamples = 0;
+    double sampleRate = 0;
+    Beatgrid beatgrid;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedTrack)
+};
+
+//==============================================================================
+/*
+    Plays a DecodedTrack. No decoding or file access happens here, only copying
+    (or converting from int16 for the disk tier).
+*/
+class DecodedTrackSource : public PositionableAudioSource
+{
+public:
+    DecodedTrackSource(DecodedTrack::Ptr _track);
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(int64 newPosition) override;
+    int64 getNextReadPosition() const override;
+    int64 getTotalLength() const override;
+    bool isLooping() const override;
+
+private:
+    DecodedTrack::Ptr track;
+    std::atomic<int64> position{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedTrackSource)
+};
+
+//==============================================================================
+/*
+    Decoded-audio cache keyed by file identity (path, size and modification time).
+    Tracks are converted to the device's sample rate as they are decoded, and stay
+    in RAM up to a byte budget; the least recently used ones are then spilled to
+    PCM files on disk and memory-mapped when asked for again.
+    Sends a change message whenever a background decode finishes.
+*/
+class DecodedTrackCache : public ChangeBroadcaster
+{
+public:
+    struct Stats
+    {
+        int hits = 0;
+        int misses = 0;
+        int tracksInMemory = 0;
+        int tracksOnDisk = 0;
+        int64 memoryUsage = 0;
+        int64 memoryBudget = 0;
+        int64 diskUsage = 0;
+
+        double getHitRate() const;
+    };
+
+    DecodedTrackCache(AudioFormatManager& _formatManager,
+                      int64 memoryBudgetBytes = 512 * 1024 * 1024,
+                      File _cacheDirectory = File());
+    ~DecodedTrackCache();
+
+    void setMemoryBudget(int64 numBytes);
+    /** how much the disk tier may hold, 8GB unless set; applied the next time a track is written to it */
+    void setDiskBudget(int64 numBytes);
+    /** int16 halves the disk tier's size; float keeps it bit exact */
+    void setDiskSampleFormat(bool useInt16);
+
+    /** the rate tracks are converted to as they're decoded, normally the device's; 0 keeps
+        each track's own. Tracks in RAM at another rate are converted again in the background,
+        and the ones on disk the next time they're loaded */
+    void setSampleRate(double newSampleRate);
+
+    /** returns the track from RAM or disk, or nullptr on a miss; a track at the wrong rate is a miss */
+    DecodedTrack::Ptr getTrack(const File& file);
+
+    /** decodes the file into the cache on the calling thread, or returns the cached copy */
+    DecodedTrack::Ptr decodeNow(const File& file);
+
+    /** decodes the file into the cache on the cache's own thread */
+    void decodeInBackground(const File& file);
+
+    /** length of a track, read from the cache when possible so nothing is decoded */
+    double getLengthInSeconds(const File& file);
+
+    /** the beatgrid of a track already decoded into RAM or disk, invalid otherwise */
+    Beatgrid getBeatgrid(const File& file);
+
+    Stats getStats() const;
+
+    /** identity of a file's contents as far as the cache is concerned */
+    static String getKeyFor(const File& file);
+
+private:
+    struct Entry
+    {
+        DecodedTrack::Ptr track;
+        uint64 lastUsed = 0;
+        //kept to decode it again if the sample rate changes
+        File file;
+    };
+
+    /** true if the track is at the rate tracks are being converted to */
+    bool isAtSampleRate(const DecodedTrack& track) const;
+    /** a track's PCM file holds it at one rate, so each rate has its own */
+    File getDiskFileFor(const String& key, double rate) const;
+    /** moves least recently used tracks from RAM to the disk tier until RAM is within budget */
+    void spillToBudget();
+    /** deletes the oldest PCM files once the disk tier outgrows its budget */
+    void trimDiskTier();
+
+    AudioFormatManager& formatManager;
+    File cacheDirectory;
+
+    CriticalSection lock;
+    std::map<String, Entry> entries;
+    StringArray keysBeingDecoded;
+    uint64 useCounter = 0;
+
+    std::atomic<int64> memoryBudget;
+    std::atomic<int64> diskBudget{(int64) 8 * 1024 * 1024 * 1024};
+    std::atomic<bool> diskAsInt16{false};
+    std::atomic<double> sampleRate{0};
+
+    int hits = 0;
+    int misses = 0;
+
+    ThreadPool decodePool{1};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedTrackCache)
+};
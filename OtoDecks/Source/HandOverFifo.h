@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    HandOverFifo.h
+    Created: 18 Oct 2026 1:12:47pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Passes heap objects from the message thread to the audio thread without
+    either side locking or allocating. Each object goes with a tag, such as the
+    slot it's meant for. Whatever is never picked up is deleted with the fifo,
+    by which time both threads must have let go of it.
+*/
+template <typename Object, int capacity>
+class HandOverFifo
+{
+public:
+    HandOverFifo() = default;
+
+    ~HandOverFifo()
+    {
+        take([] (Object* object, int) { delete object; });
+    }
+
+    /** queues object, which may be nullptr, and takes ownership of it. False, leaving it
+        with the caller, if the audio thread hasn't picked up the last ones yet (message thread) */
+    bool push(Object* object, int tag = 0)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 + size2 == 0)
+        {
+            return false;
+        }
+
+        const int index = size1 > 0 ? start1 : start2;
+        objects[index] = object;
+        tags[index] = tag;
+        fifo.finishedWrite(1);
+        return true;
+    }
+
+    /** calls taker with each waiting object and its tag, oldest first (audio thread) */
+    template <typename Taker>
+    void take(Taker&& taker)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1 + size2; ++i)
+        {
+            const int index = i < size1 ? start1 + i : start2 + i - size1;
+            taker(objects[index], tags[index]);
+        }
+        fifo.finishedRead(size1 + size2);
+    }
+
+private:
+    AbstractFifo fifo{capacity};
+    Object* objects[capacity] = {};
+    int tags[capacity] = {};
+
+    JUCE_DECLARE_NON_COPYABLE (HandOverFifo)
+};
+
+//==============================================================================
+/*
+    Passes objects the audio thread has finished with back to the message
+    thread to delete, since freeing them could block the callback.
+
+    If the message thread falls behind and the fifo fills, objects are held
+    back on the audio thread and moved in by a later retire() or flush(), so
+    they're still deleted in the order they were retired. Anything left over
+    is deleted with the fifo.
+*/
+template <typename Object, int capacity, int overflowCapacity = 8>
+class RetireFifo
+{
+public:
+    RetireFifo() = default;
+
+    ~RetireFifo()
+    {
+        for (int i = 0; i < numOverflow; ++i)
+        {
+            delete overflow[i];
+        }
+        deleteRetired();
+    }
+
+    /** hands object over to be deleted; nullptr is ignored (audio thread) */
+    void retire(Object* object)
+    {
+        if (object == nullptr)
+        {
+            return;
+        }
+
+        //anything held back goes first, so objects are deleted in the order they were retired
+        flush();
+        if (numOverflow == 0 && push(object))
+        {
+            return;
+        }
+
+        if (numOverflow < overflowCapacity)
+        {
+            overflow[numOverflow++] = object;
+            return;
+        }
+
+        //the message thread has stopped deleting altogether. Leaking the object is
+        //the lesser evil than freeing it on the audio thread
+        jassertfalse;
+    }
+
+    /** moves objects held back by a full fifo into it, as far as there's room (audio thread) */
+    void flush()
+    {
+        int numMoved = 0;
+        while (numMoved < numOverflow && push(overflow[numMoved]))
+        {
+            ++numMoved;
+        }
+
+        std::copy(overflow + numMoved, overflow + numOverflow, overflow);
+        numOverflow -= numMoved;
+    }
+
+    /** deletes every retired object, calling aboutToDelete on each first (message thread) */
+    template <typename Callback>
+    void deleteRetired(Callback&& aboutToDelete)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1 + size2; ++i)
+        {
+            std::unique_ptr<Object> object (objects[i < size1 ? start1 + i : start2 + i - size1]);
+            aboutToDelete(*object);
+        }
+        fifo.finishedRead(size1 + size2);
+    }
+
+    void deleteRetired()
+    {
+        deleteRetired([] (Object&) {});
+    }
+
+private:
+    bool push(Object* object)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 + size2 == 0)
+        {
+            return false;
+        }
+
+        objects[size1 > 0 ? start1 : start2] = object;
+        fifo.finishedWrite(1);
+        return true;
+    }
+
+    AbstractFifo fifo{capacity};
+    Object* objects[capacity] = {};
+
+    // owned by the audio thread
+    Object* overflow[overflowCapacity] = {};
+    int numOverflow = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (RetireFifo)
+};
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    IntegratedLoudness.cpp
+    Created: 18 Oct 2026 3:48:20am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "IntegratedLoudness.h"
+#include "VectorKernels.h"
+
+// blocks are 400ms long and start every 100ms
+static const double stepSeconds = 0.1;
+// blocks this far under the ungated loudness are left out of the second pass
+static const double relativeGate = 0.1;
+// -60 dBFS, quiet enough that a fade out counts as sound until it has all but finished
+static const float silenceThreshold = 0.001f;
+
+//==============================================================================
+IntegratedLoudness::IntegratedLoudness(double sampleRate)
+                   : samplesPerStep(jmax(1, roundToInt(stepSeconds * sampleRate)))
+{
+    history.setSize(2, historySize + samplesPerStep);
+    scratch.setSize(1, samplesPerStep);
+    history.clear();
+
+    IIRCoefficients shelf, highPass;
+    LevelMeter::makeKWeighting(sampleRate, shelf, highPass);
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        shelfFilters[ch].setCoefficients(shelf);
+        highPassFilters[ch].setCoefficients(highPass);
+    }
+
+    MasterLimiter::makeInterpolator(interpolator);
+
+    //a five minute track is about 3000 blocks
+    blockMeanSquares.reserve(4096);
+}
+
+void IntegratedLoudness::process(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int done = 0;
+    while (done < numSamples)
+    {
+        const int length = jmin(numSamples - done, samplesPerStep - stepFill);
+        processPiece(buffer, startSample + done, length);
+        done += length;
+
+        stepFill += length;
+        if (stepFill < samplesPerStep)
+        {
+            continue;
+        }
+
+        //the step is done; once there are four of them they make a block
+        recentSteps[numSteps % stepsPerBlock] = stepSquares / samplesPerStep;
+        ++numSteps;
+        stepSquares = 0;
+        stepFill = 0;
+
+        if (numSteps >= stepsPerBlock)
+        {
+            double sum = 0;
+            for (double step : recentSteps)
+            {
+                sum += step;
+            }
+            blockMeanSquares.push_back(sum / stepsPerBlock);
+        }
+    }
+}
+
+float IntegratedLoudness::getLoudness() const
+{
+    //the absolute gate, then the relative one from what passed it
+    const double absoluteGate = std::pow(10.0, (LevelMeter::minimumLoudness + 0.691) / 10.0);
+
+    double sum = 0;
+    int count = 0;
+    for (double block : blockMeanSquares)
+    {
+        if (block > absoluteGate)
+        {
+            sum += block;
+            ++count;
+        }
+    }
+    if (count == 0)
+    {
+        return LevelMeter::minimumLoudness;
+    }
+
+    const double gate = sum / count * relativeGate;
+    sum = 0;
+    count = 0;
+    for (double block : blockMeanSquares)
+    {
+        if (block > absoluteGate && block > gate)
+        {
+            sum += block;
+            ++count;
+        }
+    }
+    return LevelMeter::meanSquareToLoudness(sum / count);
+}
+
+float IntegratedLoudness::getTruePeak() const
+{
+    return Decibels::gainToDecibels(truePeak);
+}
+
+int64 IntegratedLoudness::getSoundStart() const
+{
+    return jmax((int64) 0, soundStart);
+}
+
+int64 IntegratedLoudness::getSoundEnd() const
+{
+    return soundEnd;
+}
+
+//==============================================================================
+void IntegratedLoudness::processPiece(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const auto* samples = buffer.getReadPointer(jmin(ch, buffer.getNumChannels() - 1), startSample);
+
+        FloatVectorOperations::copy(history.getWritePointer(ch, historySize), samples, numSamples);
+        truePeak = jmax(truePeak, findTruePeak(history.getReadPointer(ch, historySize), numSamples));
+        auto* historyData = history.getWritePointer(ch);
+        std::memmove(historyData, historyData + numSamples, sizeof(float) * (size_t) historySize);
+
+        auto* weighted = scratch.getWritePointer(0);
+        FloatVectorOperations::copy(weighted, samples, numSamples);
+        shelfFilters[ch].processSamples(weighted, numSamples);
+        highPassFilters[ch].processSamples(weighted, numSamples);
+        stepSquares += VectorKernels::dotProduct(weighted, weighted, numSamples);
+
+        //pieces are all sound or all silence for most of a track, so the scans are short
+        const auto range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+        if (jmax(-range.getStart(), range.getEnd()) > silenceThreshold)
+        {
+            int first = 0;
+            while (std::abs(samples[first]) <= silenceThreshold)
+            {
+                ++first;
+            }
+            int last = numSamples;
+            while (std::abs(samples[last - 1]) <= silenceThreshold)
+            {
+                --last;
+            }
+
+            if (soundStart < 0 || samplesProcessed + first < soundStart)
+            {
+                soundStart = samplesProcessed + first;
+            }
+            soundEnd = jmax(soundEnd, samplesProcessed + last);
+        }
+    }
+    samplesProcessed += numSamples;
+}
+
+float IntegratedLoudness::findTruePeak(const float* samples, int numSamples)
+{
+    const auto range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+    float peak = jmax(-range.getStart(), range.getEnd());
+
+    //as in the limiter: each phase is a sum of the taps, each tap a shifted copy of the samples
+    auto* interpolated = scratch.getWritePointer(0);
+    for (auto& phase : interpolator)
+    {
+        FloatVectorOperations::clear(interpolated, numSamples);
+        for (int tap = 0; tap < MasterLimiter::numTaps; ++tap)
+        {
+            FloatVectorOperations::addWithMultiply(interpolated, samples - tap, phase[tap], numSamples);
+        }
+
+        const auto phaseRange = FloatVectorOperations::findMinAndMax(interpolated, numSamples);
+        peak = jmax(peak, -phaseRange.getStart(), phaseRange.getEnd());
+    }
+    return peak;
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    IntegratedLoudness.h
+    Created: 18 Oct 2026 3:48:20am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LevelMeter.h"
+#include "MasterLimiter.h"
+
+//==============================================================================
+/*
+    Measures a whole track's integrated loudness and true peak, as EBU R128
+    defines them, for loudness normalisation.
+
+    The audio goes through LevelMeter's K-weighting and is measured in 400ms
+    blocks, one every 100ms. Blocks below -70 LUFS are ignored, and so are
+    blocks more than 10 LU quieter than the rest, which keeps breakdowns and
+    silence from dragging a track's figure down. True peak uses the limiter's
+    four times interpolator.
+
+    Used on the analysis threads, a chunk at a time as the file is decoded.
+*/
+class IntegratedLoudness
+{
+public:
+    IntegratedLoudness(double sampleRate);
+
+    /** measures the first two channels of the next chunk of the track; a mono buffer counts as both */
+    void process(const AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /** in LUFS, LevelMeter::minimumLoudness if the track was silent */
+    float getLoudness() const;
+    /** the highest true peak, in dBTP */
+    float getTruePeak() const;
+    /** the first sample above -60 dBFS and one past the last, counted from the first sample
+        processed, so a track's silent lead-in and tail can be skipped. Both 0 if it was silent */
+    int64 getSoundStart() const;
+    int64 getSoundEnd() const;
+
+private:
+    static constexpr int stepsPerBlock = 4;
+    static constexpr int historySize = MasterLimiter::numTaps - 1;
+
+    /** measures no more than one step's worth of samples, all within the step */
+    void processPiece(const AudioBuffer<float>& buffer, int startSample, int numSamples);
+    /** the highest true peak of a channel's samples, each sample preceded by historySize from before */
+    float findTruePeak(const float* samples, int numSamples);
+
+    int samplesPerStep;
+
+    IIRFilter shelfFilters[2], highPassFilters[2];
+    float interpolator[MasterLimiter::numPhases - 1][MasterLimiter::numTaps];
+
+    // each channel's last historySize samples, then the piece
+    AudioBuffer<float> history;
+    AudioBuffer<float> scratch;
+    float truePeak = 0;
+    // where the sound starts and ends, -1 for a start not found yet
+    int64 samplesProcessed = 0;
+    int64 soundStart = -1;
+    int64 soundEnd = 0;
+
+    // the step being measured, and the mean squares of the last few
+    int stepFill = 0;
+    double stepSquares = 0;
+    double recentSteps[stepsPerBlock] = {};
+    int numSteps = 0;
+
+    std::vector<double> blockMeanSquares;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IntegratedLoudness)
+};
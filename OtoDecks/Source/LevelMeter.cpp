@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+    Created: 18 Oct 2026 3:05:12am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LevelMeter.h"
+#include "VectorKernels.h"
+
+// short enough for meters to move smoothly, and the hop BS.1770 steps its windows by is a multiple of it
+static const double chunkSeconds = 0.05;
+
+/** raises peak to at least newPeak */
+static void updatePeak(std::atomic<float>& peak, float newPeak)
+{
+    auto previous = peak.load(std::memory_order_relaxed);
+    while (newPeak > previous && ! peak.compare_exchange_weak(previous, newPeak, std::memory_order_relaxed))
+    {
+    }
+}
+
+//==============================================================================
+void LevelMeter::makeKWeighting(double sampleRate, IIRCoefficients& shelf, IIRCoefficients& highPass)
+{
+    //BS.1770's filters are given at 48kHz; these are their analogue prototypes, as in libebur128,
+    //so the response is the same at any rate
+    {
+        const double f0 = 1681.974450955533;
+        const double gain = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k = std::tan(MathConstants<double>::pi * f0 / sampleRate);
+        const double vh = std::pow(10.0, gain / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+
+        shelf = IIRCoefficients(vh + vb * k / q + k * k, 2.0 * (k * k - vh), vh - vb * k / q + k * k,
+                                1.0 + k / q + k * k, 2.0 * (k * k - 1.0), 1.0 - k / q + k * k);
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k = std::tan(MathConstants<double>::pi * f0 / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        //the standard's numerator is 1, -2, 1 after normalising, which leaves the pass band a hair above unity
+        highPass = IIRCoefficients(a0, -2.0 * a0, a0, a0, 2.0 * (k * k - 1.0), 1.0 - k / q + k * k);
+    }
+}
+
+float LevelMeter::meanSquareToLoudness(double meanSquare)
+{
+    if (meanSquare <= 0)
+    {
+        return minimumLoudness;
+    }
+    return jmax(minimumLoudness, (float) (-0.691 + 10.0 * std::log10(meanSquare)));
+}
+
+LevelMeter::LevelMeter()
+{
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        peaks[ch] = 0;
+        rms[ch] = 0;
+    }
+}
+
+void LevelMeter::prepare(int _maximumBlockSize, double sampleRate)
+{
+    maximumBlockSize = jmax(1, _maximumBlockSize);
+    samplesPerChunk = jmax(1, roundToInt(chunkSeconds * sampleRate));
+    weighted.setSize(1, maximumBlockSize);
+
+    IIRCoefficients shelf, highPass;
+    makeKWeighting(sampleRate, shelf, highPass);
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        shelfFilters[ch].setCoefficients(shelf);
+        highPassFilters[ch].setCoefficients(highPass);
+    }
+
+    reset();
+}
+
+void LevelMeter::reset()
+{
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        shelfFilters[ch].reset();
+        highPassFilters[ch].reset();
+        chunkSquares[ch] = 0;
+        std::fill(std::begin(squaresHistory[ch]), std::end(squaresHistory[ch]), 0.0);
+        rms[ch] = 0;
+    }
+
+    chunkFill = 0;
+    chunkWeightedSquares = 0;
+    std::fill(std::begin(weightedHistory), std::end(weightedHistory), 0.0);
+    historyPosition = 0;
+    historyFill = 0;
+
+    momentary = minimumLoudness;
+    shortTerm = minimumLoudness;
+}
+
+void LevelMeter::process(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    int done = 0;
+    while (done < numSamples)
+    {
+        const int length = jmin(numSamples - done, samplesPerChunk - chunkFill, maximumBlockSize);
+        processPiece(buffer, startSample + done, length);
+        done += length;
+
+        chunkFill += length;
+        if (chunkFill == samplesPerChunk)
+        {
+            finishChunk();
+        }
+    }
+}
+
+LevelMeter::Levels LevelMeter::getLevels()
+{
+    Levels levels;
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        levels.peak[ch] = peaks[ch].exchange(0.0f, std::memory_order_relaxed);
+        levels.rms[ch] = rms[ch].load(std::memory_order_relaxed);
+    }
+    levels.momentary = momentary.load(std::memory_order_relaxed);
+    levels.shortTerm = shortTerm.load(std::memory_order_relaxed);
+    return levels;
+}
+
+//==============================================================================
+void LevelMeter::processPiece(const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    //a mono buffer is measured as the same signal on both sides
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const auto* samples = buffer.getReadPointer(jmin(ch, buffer.getNumChannels() - 1), startSample);
+
+        const auto range = FloatVectorOperations::findMinAndMax(samples, numSamples);
+        updatePeak(peaks[ch], jmax(-range.getStart(), range.getEnd()));
+        chunkSquares[ch] += VectorKernels::dotProduct(samples, samples, numSamples);
+
+        auto* weightedSamples = weighted.getWritePointer(0);
+        FloatVectorOperations::copy(weightedSamples, samples, numSamples);
+        shelfFilters[ch].processSamples(weightedSamples, numSamples);
+        highPassFilters[ch].processSamples(weightedSamples, numSamples);
+        chunkWeightedSquares += VectorKernels::dotProduct(weightedSamples, weightedSamples, numSamples);
+    }
+}
+
+void LevelMeter::finishChunk()
+{
+    weightedHistory[historyPosition] = chunkWeightedSquares / samplesPerChunk;
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        squaresHistory[ch][historyPosition] = chunkSquares[ch] / samplesPerChunk;
+        chunkSquares[ch] = 0;
+    }
+    chunkWeightedSquares = 0;
+    chunkFill = 0;
+
+    historyPosition = (historyPosition + 1) % shortTermChunks;
+    historyFill = jmin(historyFill + 1, shortTermChunks);
+
+    //walk back from the newest chunk; until there's 3s of history, short-term covers what there is
+    double momentarySum = 0, shortTermSum = 0;
+    double rmsSums[2] = {};
+    for (int i = 0; i < historyFill; ++i)
+    {
+        const int index = (historyPosition - 1 - i + shortTermChunks) % shortTermChunks;
+        shortTermSum += weightedHistory[index];
+
+        if (i < momentaryChunks)
+        {
+            momentarySum += weightedHistory[index];
+        }
+        if (i < rmsChunks)
+        {
+            rmsSums[0] += squaresHistory[0][index];
+            rmsSums[1] += squaresHistory[1][index];
+        }
+    }
+
+    momentary.store(meanSquareToLoudness(momentarySum / jmin(historyFill, momentaryChunks)), std::memory_order_relaxed);
+    shortTerm.store(meanSquareToLoudness(shortTermSum / historyFill), std::memory_order_relaxed);
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        rms[ch].store((float) std::sqrt(rmsSums[ch] / jmin(historyFill, rmsChunks)), std::memory_order_relaxed);
+    }
+}
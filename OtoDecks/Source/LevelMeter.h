@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+    Created: 18 Oct 2026 3:05:12am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Measures a stereo signal on the audio thread for the meters: sample peak
+    and RMS per channel, and momentary (400ms) and short-term (3s) loudness in
+    LUFS as ITU-R BS.1770 defines it, through its K-weighting filter.
+
+    The audio is measured in 50ms chunks. Squares are summed with
+    VectorKernels and peaks found with FloatVectorOperations, so the filters
+    are the only per-sample work. At the end of each chunk the results are
+    stored in atomics, and the UI reads them from there without locking
+    anything or touching the filters. Nothing is allocated after prepare().
+*/
+class LevelMeter
+{
+public:
+    /** peaks and RMS as linear gains, loudness in LUFS */
+    struct Levels
+    {
+        float peak[2] = {};
+        float rms[2] = {};
+        float momentary = minimumLoudness;
+        float shortTerm = minimumLoudness;
+    };
+
+    /** quieter than this reads as silence, as in BS.1770's absolute gate */
+    static constexpr float minimumLoudness = -70.0f;
+
+    /** sets the two biquads of BS.1770's K-weighting, a high shelf then a high pass, for a sample rate */
+    static void makeKWeighting(double sampleRate, IIRCoefficients& shelf, IIRCoefficients& highPass);
+    /** loudness in LUFS of a K-weighted mean square summed over the channels */
+    static float meanSquareToLoudness(double meanSquare);
+
+    LevelMeter();
+
+    /** allocates everything process() will need */
+    void prepare(int maximumBlockSize, double sampleRate);
+    /** clears the filters and the history, e.g. when the device restarts */
+    void reset();
+
+    /** measures the first two channels of a block (audio thread) */
+    void process(const AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /** the latest levels. Peaks are the highest since the last call, so one reader only, normally the meter's timer */
+    Levels getLevels();
+
+private:
+    static constexpr int momentaryChunks = 8;
+    static constexpr int shortTermChunks = 60;
+    static constexpr int rmsChunks = 6;
+
+    /** measures no more than maximumBlockSize samples, all within one chunk */
+    void processPiece(const AudioBuffer<float>& buffer, int startSample, int numSamples);
+    /** turns a finished chunk into levels and publishes them */
+    void finishChunk();
+
+    int maximumBlockSize = 0;
+    int samplesPerChunk = 2205;
+
+    IIRFilter shelfFilters[2], highPassFilters[2];
+    AudioBuffer<float> weighted;
+
+    // the chunk being measured
+    int chunkFill = 0;
+    double chunkWeightedSquares = 0;
+    double chunkSquares[2] = {};
+
+    // the mean squares of the last few seconds' chunks, oldest overwritten first
+    double weightedHistory[shortTermChunks] = {};
+    double squaresHistory[2][shortTermChunks] = {};
+    int historyPosition = 0;
+    int historyFill = 0;
+
+    std::atomic<float> peaks[2];
+    std::atomic<float> rms[2];
+    std::atomic<float> momentary{minimumLoudness};
+    std::atomic<float> shortTerm{minimumLoudness};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    LevelMeterComponent.cpp
+    Created: 18 Oct 2026 3:05:12am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "LevelMeterComponent.h"
+
+// the bottom and top of the scale
+static const float minimumDecibels = -60.0f;
+static const float maximumDecibels = 3.0f;
+// frames at 60Hz: peaks hold for a second, then fall at 20dB a second; the clip light stays on for two
+static const int refreshRate = 60;
+static const int peakHoldTime = 60;
+static const float peakFallPerFrame = 20.0f / refreshRate;
+static const int clipHoldTime = 120;
+
+//==============================================================================
+LevelMeterComponent::LevelMeterComponent(LevelMeter& _meter)
+                    : meter(_meter)
+{
+    setOpaque(true);
+    startTimerHz(refreshRate);
+}
+
+LevelMeterComponent::~LevelMeterComponent()
+{
+    stopTimer();
+}
+
+float LevelMeterComponent::getProportion(float decibels)
+{
+    return jlimit(0.0f, 1.0f, (decibels - minimumDecibels) / (maximumDecibels - minimumDecibels));
+}
+
+void LevelMeterComponent::timerCallback()
+{
+    const auto levels = meter.getLevels();
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        rms[ch] = levels.rms[ch];
+
+        //a new peak above the held one takes over, otherwise the held one waits and then falls
+        const float peak = Decibels::gainToDecibels(levels.peak[ch], -100.0f);
+        if (peak >= peakHold[ch])
+        {
+            peakHold[ch] = peak;
+            peakHoldFrames[ch] = peakHoldTime;
+        }
+        else if (peakHoldFrames[ch] > 0)
+        {
+            --peakHoldFrames[ch];
+        }
+        else
+        {
+            peakHold[ch] = jmax(-100.0f, peakHold[ch] - peakFallPerFrame);
+        }
+
+        if (levels.peak[ch] >= 1.0f)
+        {
+            clipFrames = clipHoldTime;
+        }
+    }
+
+    clipFrames = jmax(0, clipFrames - 1);
+    momentary = levels.momentary;
+    shortTerm = levels.shortTerm;
+    repaint();
+}
+
+void LevelMeterComponent::paint (Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    const bool vertical = getHeight() > getWidth();
+    auto bounds = getLocalBounds().toFloat().reduced(1.0f);
+
+    //the loudness readout takes the end of the meter, the clip light the far end of the bars
+    auto textArea = vertical ? bounds.removeFromBottom(28.0f) : bounds.removeFromRight(56.0f);
+    auto clipArea = vertical ? bounds.removeFromTop(6.0f) : bounds.removeFromRight(6.0f);
+
+    g.setColour(clipFrames > 0 ? juce::Colours::red : juce::Colours::darkred.darker());
+    g.fillRect(clipArea.reduced(1.0f));
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        auto bar = vertical ? bounds.withWidth(bounds.getWidth() / 2).translated(ch * bounds.getWidth() / 2, 0).reduced(1.0f, 0)
+                            : bounds.withHeight(bounds.getHeight() / 2).translated(0, ch * bounds.getHeight() / 2).reduced(0, 1.0f);
+
+        const float rmsDecibels = Decibels::gainToDecibels(rms[ch], -100.0f);
+        const float level = getProportion(rmsDecibels);
+        auto filled = vertical ? bar.withTop(bar.getBottom() - bar.getHeight() * level)
+                               : bar.withWidth(bar.getWidth() * level);
+
+        g.setColour(rmsDecibels > -6.0f ? juce::Colours::orange : juce::Colours::mediumspringgreen);
+        g.fillRect(filled);
+
+        //the held peak, as a line across the bar
+        const float peak = getProportion(peakHold[ch]);
+        g.setColour(peakHold[ch] > -0.1f ? juce::Colours::red : juce::Colours::whitesmoke);
+        if (vertical)
+        {
+            g.fillRect(bar.getX(), bar.getBottom() - bar.getHeight() * peak - 1.0f, bar.getWidth(), 2.0f);
+        }
+        else
+        {
+            g.fillRect(bar.getX() + bar.getWidth() * peak - 1.0f, bar.getY(), 2.0f, bar.getHeight());
+        }
+    }
+
+    //momentary loudness over short-term, in LUFS
+    g.setColour(juce::Colours::whitesmoke);
+    g.setFont(11.0f);
+    auto formatLoudness = [] (float lufs) { return lufs <= LevelMeter::minimumLoudness ? String("-inf") : String(lufs, 1); };
+    g.drawText("M " + formatLoudness(momentary), textArea.removeFromTop(textArea.getHeight() / 2), Justification::centred, false);
+    g.drawText("S " + formatLoudness(shortTerm), textArea, Justification::centred, false);
+}
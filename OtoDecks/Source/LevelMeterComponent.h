@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    LevelMeterComponent.h
+    Created: 18 Oct 2026 3:05:12am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LevelMeter.h"
+
+//==============================================================================
+/*
+    Draws a LevelMeter: a bar per channel showing RMS, a line at the peak that
+    holds and then falls back, a clip light, and the momentary and short-term
+    loudness. Vertical when taller than it is wide, horizontal otherwise.
+
+    Reads the meter's levels at 60Hz from its own timer; only the meter's
+    atomics are touched, never anything the audio thread is using.
+*/
+class LevelMeterComponent : public Component,
+                            public Timer
+{
+public:
+    LevelMeterComponent(LevelMeter& _meter);
+    ~LevelMeterComponent();
+
+    void paint (Graphics& g) override;
+
+    /** implement Timer, picks up the latest levels and repaints */
+    void timerCallback() override;
+
+private:
+    /** where a level in decibels falls along the bar, from 0 at the bottom of the scale to 1 at the top */
+    static float getProportion(float decibels);
+
+    LevelMeter& meter;
+
+    float rms[2] = {};
+    // the held peaks, in decibels
+    float peakHold[2] = { -100.0f, -100.0f };
+    int peakHoldFrames[2] = {};
+    int clipFrames = 0;
+    float momentary = LevelMeter::minimumLoudness;
+    float shortTerm = LevelMeter::minimumLoudness;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterComponent)
+};
@@ -2,6 +2,8 @@
 
 #include <JuceHeader.h>
 #include "MainComponent.h"
+#include "PerformanceBenchmarks.h"
+#include "OfflineRenderer.h"
 
 //==============================================================================
 class OtoDecksApplication  : public JUCEApplication
@@ -18,7 +20,25 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
-        mainWindow.reset (new MainWindow (getApplicationName()));
+        //benchmark runs print their results and quit without opening the window
+        if (PerformanceBenchmarks::isRequested(commandLine))
+        {
+            PerformanceBenchmarks::run(commandLine);
+            quit();
+            return;
+        }
+
+        //so do offline renders, which exit non-zero if the session fails or the checksum differs
+        if (OfflineRenderer::isRequested(commandLine))
+        {
+            setApplicationReturnValue(OfflineRenderer::run(commandLine));
+            quit();
+            return;
+        }
+
+        //--decks=4 opens four decks instead of two
+        auto numDecks = commandLine.fromFirstOccurrenceOf("--decks=", false, false).getIntValue();
+        mainWindow.reset (new MainWindow (getApplicationName(), numDecks > 0 ? jmin(numDecks, 8) : 2));
     }
 
     void shutdown() override
@@ -48,13 +68,13 @@ public:
     class MainWindow    : public DocumentWindow
     {
     public:
-        MainWindow (String name)  : DocumentWindow (name,
+        MainWindow (String name, int numDecks)  : DocumentWindow (name,
                                                     Desktop::getInstance().getDefaultLookAndFeel()
                                                                           .findColour (ResizableWindow::backgroundColourId),
                                                     DocumentWindow::allButtons)
         {
             setUsingNativeTitleBar (true);
-            setContentOwned (new MainComponent(), true);
+            setContentOwned (new MainComponent(numDecks), true);
 
            #if JUCE_IOS || JUCE_ANDROID
             setFullScreen (true);
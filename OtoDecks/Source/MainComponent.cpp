@@ -3,8 +3,17 @@
 #include "MainComponent.h"
 
 //==============================================================================
-MainComponent::MainComponent()
+MainComponent::MainComponent(int numDecks)
+    : deckEngine(DeckEngine::getDefaultNumWorkers(numDecks))
 {
+    // the decks have to be in the engine before the audio device starts
+    for (int i = 0; i < numDecks; ++i)
+    {
+        auto* player = players.add(new DJAudioPlayer(formatManager, readAheadPool, decodedTrackCache, trackAnalyser, beatSync, recorder, i));
+        deckGUIs.add(new DeckGUI(player, &playlistComponent, waveformCache, i));
+        deckEngine.addInput(player);
+    }
+
     // Make sure you set the size of the component after
     // you add any child components.
     setSize (800, 600);
@@ -23,9 +32,60 @@ MainComponent::MainComponent()
     }  
 
     // add application components and make them visible
-    addAndMakeVisible(deckGUILeft); 
-    addAndMakeVisible(deckGUIRight);  
+    for (auto* deckGUI : deckGUIs)
+    {
+        addAndMakeVisible(deckGUI);
+    }
     addAndMakeVisible(playlistComponent);
+
+    //crossfader customisation, centred and back there on a double-click
+    crossfaderSlider.setSliderStyle(Slider::SliderStyle::LinearHorizontal);
+    crossfaderSlider.setTextBoxStyle(Slider::NoTextBox, false, 0, 0);
+    crossfaderSlider.setRange(0.0, 1.0);
+    crossfaderSlider.setValue(masterBus.getCrossfader(), juce::dontSendNotification);
+    crossfaderSlider.setDoubleClickReturnValue(true, 0.5);
+    crossfaderSlider.addListener(this);
+    addAndMakeVisible(crossfaderSlider);
+
+    //curveBox customisation, ids are the Curve values plus one
+    curveBox.addItem(MasterBus::getCurveName(MasterBus::Curve::constantPower), 1);
+    curveBox.addItem(MasterBus::getCurveName(MasterBus::Curve::linear), 2);
+    curveBox.addItem(MasterBus::getCurveName(MasterBus::Curve::cut), 3);
+    curveBox.setSelectedId((int) masterBus.getCurve() + 1, juce::dontSendNotification);
+    curveBox.addListener(this);
+    addAndMakeVisible(curveBox);
+    addAndMakeVisible(masterMeter);
+
+    //autoGainBox customisation, id 1 is off and the rest are target loudnesses. Tracks play at
+    //their own level until auto gain is picked
+    autoGainBox.addItem("Auto gain off", 1);
+    for (int i = 0; i < numElementsInArray(targetLoudnesses); ++i)
+    {
+        autoGainBox.addItem("Auto gain " + String(targetLoudnesses[i]) + " LUFS", i + 2);
+    }
+    autoGainBox.setSelectedId(1, juce::dontSendNotification);
+    autoGainBox.addListener(this);
+    addAndMakeVisible(autoGainBox);
+
+    //the profiler panel sits over the library, hidden (and not profiling) until asked for
+    profilerButton.setClickingTogglesState(true);
+    profilerButton.addListener(this);
+    addAndMakeVisible(profilerButton);
+    addChildComponent(profilerPanel);
+
+    //recording controls, ids 1 and 2 being the master alone and 3 and 4 the master and every deck
+    recordButton.setClickingTogglesState(true);
+    recordButton.addListener(this);
+    addAndMakeVisible(recordButton);
+    recordBox.addItem("Master " + AudioRecorder::getFormatName(AudioRecorder::Format::wav), 1);
+    recordBox.addItem("Master " + AudioRecorder::getFormatName(AudioRecorder::Format::flac), 2);
+    recordBox.addItem("Stems " + AudioRecorder::getFormatName(AudioRecorder::Format::wav), 3);
+    recordBox.addItem("Stems " + AudioRecorder::getFormatName(AudioRecorder::Format::flac), 4);
+    recordBox.setSelectedId(1, juce::dontSendNotification);
+    addAndMakeVisible(recordBox);
+    recordLabel.setColour(juce::Label::textColourId, juce::Colours::whitesmoke);
+    recordLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(recordLabel);
     
 
     // Add Labels and customize visuals for labels 
@@ -61,18 +121,14 @@ void MainComponent::prepareToPlay (int samplesPerBlockExpected, double sampleRat
 {
     playlistComponent.prepareToPlay(samplesPerBlockExpected, sampleRate);
 
-    playerLeft.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    playerRight.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    
-    mixerSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-
-    mixerSource.addInputSource(&playerLeft, false);
-    mixerSource.addInputSource(&playerRight, false);
-
+    //prepares the deck engine, and with it every deck, which were added once in the constructor
+    masterBus.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    currentSampleRate = sampleRate;
  }
 void MainComponent::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
 {
-    mixerSource.getNextAudioBlock(bufferToFill);
+    CallbackProfiler::ScopedStage callback(bufferToFill.numSamples, currentSampleRate);
+    masterBus.getNextAudioBlock(bufferToFill);
 }
 
 void MainComponent::releaseResources()
@@ -81,8 +137,7 @@ void MainComponent::releaseResources()
     // restarted due to a setting change.
     playlistComponent.releaseResources();
 
-    playerLeft.releaseResources();
-    playerRight.releaseResources();
+    masterBus.releaseResources();
 
 }
 
@@ -101,13 +156,108 @@ void MainComponent::resized()
     waveformLabel.setBounds(0, 0, colW, rowH*2);
     posLabel.setBounds(0, rowH*2, colW, rowH);
     widgetLabel.setBounds(0, rowH*3, colW, rowH*3);
-    playlistLabel.setBounds(0, rowH*6, colW, rowH*3);
+    playlistLabel.setBounds(0, rowH*6, colW, rowH);
+
+    //add GUIs, two decks side by side per row
+    int numRows = (deckGUIs.size() + 1) / 2;
+    for (int i = 0; i < deckGUIs.size(); ++i)
+    {
+        deckGUIs[i]->setBounds(colW + (i % 2) * colW * 3, (i / 2) * rowH * 6 / numRows, colW * 3, rowH * 6 / numRows);
+    }
 
-    //add GUIs
-    deckGUILeft.setBounds(colW, 0, colW * 3, rowH*6);
-    deckGUIRight.setBounds(colW * 4, 0, colW * 3, rowH * 6);
+    //crossfader under the decks, centred between the two sides
+    crossfaderSlider.setBounds(colW * 2.5, rowH * 6, colW * 2, rowH * 0.5);
+    curveBox.setBounds(colW * 4.6, rowH * 6 + 4, colW * 1.2, rowH * 0.5 - 8);
+    masterMeter.setBounds(colW * 1.1, rowH * 6 + 4, colW * 1.3, rowH * 0.5 - 8);
 
     //add playlistComponent
-    playlistComponent.setBounds(colW, rowH *6, colW * 6, rowH * 4);
+    playlistComponent.setBounds(colW, rowH * 6.5, colW * 6, rowH * 3.5);
+    profilerPanel.setBounds(colW, rowH * 6.5, colW * 6, rowH * 3.5);
+    profilerButton.setBounds(4, rowH * 9 + 8, colW - 8, rowH - 16);
+    recordButton.setBounds(4, rowH * 7 + 4, colW * 0.4, rowH * 0.5 - 6);
+    recordBox.setBounds(colW * 0.4 + 8, rowH * 7 + 4, colW * 0.6 - 12, rowH * 0.5 - 6);
+    recordLabel.setBounds(4, rowH * 7.5, colW - 8, rowH * 0.5);
+    autoGainBox.setBounds(4, rowH * 8 + 8, colW - 8, rowH - 16);
+}
+
+void MainComponent::buttonClicked (Button* button)
+{
+    if (button == &profilerButton)
+    {
+        profilerPanel.setVisible(profilerButton.getToggleState());
+    }
+    if (button == &recordButton)
+    {
+        if (! recordButton.getToggleState())
+        {
+            recorder.stop();
+            timerCallback();
+            return;
+        }
+
+        //a new folder per recording, named after when it started
+        auto folder = File::getSpecialLocation(File::userMusicDirectory)
+                          .getChildFile("OtoDecks Recordings")
+                          .getChildFile(Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S"));
+        const int id = recordBox.getSelectedId();
+        const auto format = id % 2 == 0 ? AudioRecorder::Format::flac : AudioRecorder::Format::wav;
+
+        if (recorder.start(folder, format, players.size(), id > 2))
+        {
+            startTimerHz(4);
+        }
+        else
+        {
+            recordButton.setToggleState(false, juce::dontSendNotification);
+        }
+        recordBox.setEnabled(! recorder.isRecording());
+    }
+}
+
+void MainComponent::timerCallback()
+{
+    //minutes and seconds, and how many blocks the disk didn't take in time
+    const auto stats = recorder.getStats();
+    const auto seconds = (int) stats.secondsRecorded;
+    recordLabel.setText(String(seconds / 60) + ":" + String(seconds % 60).paddedLeft('0', 2)
+                        + ", " + String(stats.droppedBlocks) + " dropped",
+                        juce::dontSendNotification);
+    recordLabel.setColour(juce::Label::textColourId, stats.droppedBlocks > 0 ? juce::Colours::orange : juce::Colours::whitesmoke);
+
+    //stopped by a device restart at another rate as well as by the button
+    if (! recorder.isRecording())
+    {
+        stopTimer();
+        recordButton.setToggleState(false, juce::dontSendNotification);
+        recordBox.setEnabled(true);
+    }
+}
+
+void MainComponent::sliderValueChanged (Slider* slider)
+{
+    if (slider == &crossfaderSlider)
+    {
+        masterBus.setCrossfader((float) crossfaderSlider.getValue());
+    }
+}
+
+void MainComponent::comboBoxChanged (ComboBox* comboBox)
+{
+    if (comboBox == &curveBox)
+    {
+        masterBus.setCurve((MasterBus::Curve) (curveBox.getSelectedId() - 1));
+    }
+    if (comboBox == &autoGainBox)
+    {
+        const int index = autoGainBox.getSelectedId() - 2;
+        for (auto* player : players)
+        {
+            if (index >= 0)
+            {
+                player->setTargetLoudness(targetLoudnesses[index]);
+            }
+            player->setAutoGain(index >= 0);
+        }
+    }
 }
 
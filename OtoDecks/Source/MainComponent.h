@@ -10,19 +10,34 @@
 
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
+#include "ReadAheadPool.h"
+#include "DecodedTrackCache.h"
+#include "DeckEngine.h"
+#include "MasterBus.h"
+#include "BeatSync.h"
 #include "DeckGUI.h"
 #include "PlaylistComponent.h"
+#include "TrackAnalyser.h"
+#include "CallbackProfiler.h"
+#include "ProfilerPanel.h"
+#include "AudioRecorder.h"
+#include "WaveformCache.h"
 
 //==============================================================================
 /*
     This component lives inside our window, and this is where you should put all
     your controls and content.
 */
-class MainComponent   : public AudioAppComponent
+class MainComponent   : public AudioAppComponent,
+                        public Button::Listener,
+                        public Slider::Listener,
+                        public ComboBox::Listener,
+                        private Timer
 {
 public:
     //==============================================================================
-    MainComponent();
+    /** the first two decks take their tracks from the library's left and right lists */
+    MainComponent(int numDecks = 2);
     ~MainComponent();
 
     //==============================================================================
@@ -34,30 +49,75 @@ public:
     void paint (Graphics& g) override;
     void resized() override;
 
+    /** implement Button::Listener, shows and hides the profiler and starts and stops recording */
+    void buttonClicked (Button* button) override;
+    /** implement Slider::Listener, for the crossfader */
+    void sliderValueChanged (Slider* slider) override;
+    /** implement ComboBox::Listener, for the crossfader curve and auto gain */
+    void comboBoxChanged (ComboBox* comboBox) override;
+
+    /** implement Timer, shows how long the recording is and whether the disk keeps up */
+    void timerCallback() override;
+
 private:
     //==============================================================================
     // Your private member variables go here...
      
     AudioFormatManager formatManager;
-    AudioThumbnailCache thumbCache{100}; 
+    //waveforms for the decks, built once per track at every zoom
+    WaveformCache waveformCache{formatManager};
 
-    int channelLeft = 0;
-    int channelRight = 1;
+    //background workers decoding ahead of the playhead for every deck
+    ReadAheadPool readAheadPool{2, 32768};
 
-    PlaylistComponent playlistComponent{formatManager};
-    
-    DJAudioPlayer playerLeft{formatManager};
-    DeckGUI deckGUILeft{&playerLeft, &playlistComponent, formatManager, thumbCache, channelLeft}; 
+    //decoded tracks shared by the decks and the library, 512MB in RAM before spilling to disk
+    DecodedTrackCache decodedTrackCache{formatManager, 512 * 1024 * 1024};
+
+    //tempo, key and loudness analysis for the library, on every core at low priority
+    TrackAnalyser trackAnalyser{formatManager};
+
+    PlaylistComponent playlistComponent{formatManager, decodedTrackCache, trackAnalyser};
+
+    //where each deck's beats are, for the decks in sync to follow
+    BeatSync beatSync;
 
-    DJAudioPlayer playerRight{formatManager};
-    DeckGUI deckGUIRight{&playerRight, &playlistComponent, formatManager, thumbCache, channelRight}; 
+    //writes the master, and each deck before its fader if asked, to disk
+    AudioRecorder recorder;
+    
+    //one player and GUI per deck, the GUI's channel being the deck's index
+    OwnedArray<DJAudioPlayer> players;
+    OwnedArray<DeckGUI> deckGUIs;
 
     Label waveformLabel;
     Label posLabel;
     Label widgetLabel;
     Label playlistLabel;
 
-    MixerAudioSource mixerSource; 
+    //the crossfader, left being side A (the even decks) and right side B
+    Slider crossfaderSlider;
+    ComboBox curveBox;
+
+    //the loudness every deck levels its tracks to, or off
+    ComboBox autoGainBox;
+    const int targetLoudnesses[4] = { -9, -14, -18, -23 };
+
+    //renders the decks in parallel and sums them
+    DeckEngine deckEngine;
+
+    //crossfades the decks and limits the mix on its way to the device
+    MasterBus masterBus{deckEngine, recorder};
+    //what's going to the device, left of the crossfader
+    LevelMeterComponent masterMeter{masterBus.getMeter()};
+
+    //where the callback's time goes, shown over the library while profiling
+    TextButton profilerButton{"PROFILER"};
+    ProfilerPanel profilerPanel{deviceManager};
+
+    //recording the set; stems adds a file per deck to the master's
+    TextButton recordButton{"REC"};
+    ComboBox recordBox;
+    Label recordLabel;
+    double currentSampleRate = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MainComponent)
 };
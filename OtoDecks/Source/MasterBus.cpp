@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    MasterBus.cpp
+    Created: 18 Oct 2026 12:41:07am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "MasterBus.h"
+#include "CallbackProfiler.h"
+
+// how far from either end the cut curve has finished fading
+static const float cutLength = 0.04f;
+// the limiter stops the mix 1dB short of full scale, as broadcast limiters do
+static const float limiterCeiling = -1.0f;
+
+//==============================================================================
+String MasterBus::getCurveName(Curve curve)
+{
+    switch (curve)
+    {
+        case Curve::constantPower:  return "Constant power";
+        case Curve::linear:         return "Linear";
+        case Curve::cut:            return "Cut";
+    }
+    return {};
+}
+
+void MasterBus::getCrossfaderGains(float position, Curve curve, float& gainA, float& gainB)
+{
+    position = jlimit(0.0f, 1.0f, position);
+
+    switch (curve)
+    {
+        case Curve::constantPower:
+            //the sum of the powers stays the same, so a blend of two tracks doesn't dip in the middle
+            gainA = std::cos(position * MathConstants<float>::halfPi);
+            gainB = std::sin(position * MathConstants<float>::halfPi);
+            break;
+
+        case Curve::linear:
+            gainA = 1.0f - position;
+            gainB = position;
+            break;
+
+        case Curve::cut:
+            //both sides at full level until the very ends, for scratching
+            gainA = jmin(1.0f, (1.0f - position) / cutLength);
+            gainB = jmin(1.0f, position / cutLength);
+            break;
+    }
+}
+
+MasterBus::MasterBus(DeckEngine& _deckEngine, AudioRecorder& _recorder)
+          : deckEngine(_deckEngine),
+            recorder(_recorder)
+{
+    for (int i = 0; i < maxDecks; ++i)
+    {
+        sides[i] = (int) (i % 2 == 0 ? Side::a : Side::b);
+    }
+    limiter.setCeiling(limiterCeiling);
+}
+
+void MasterBus::setCrossfader(float position)
+{
+    crossfader = jlimit(0.0f, 1.0f, position);
+}
+
+float MasterBus::getCrossfader() const
+{
+    return crossfader;
+}
+
+void MasterBus::setCurve(Curve _curve)
+{
+    curve = (int) _curve;
+}
+
+MasterBus::Curve MasterBus::getCurve() const
+{
+    return (Curve) curve.load();
+}
+
+void MasterBus::setSide(int deckIndex, Side side)
+{
+    if (! isPositiveAndBelow(deckIndex, maxDecks))
+    {
+        std::cout << "MasterBus::setSide deckIndex should be between 0 and " << maxDecks - 1 << std::endl;
+        return;
+    }
+    sides[deckIndex] = (int) side;
+}
+
+float MasterBus::getGainReduction() const
+{
+    return limiter.getGainReduction();
+}
+
+LevelMeter& MasterBus::getMeter()
+{
+    return meter;
+}
+
+void MasterBus::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    deckEngine.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    limiter.prepare(samplesPerBlockExpected, sampleRate, 2);
+    meter.prepare(samplesPerBlockExpected, sampleRate);
+    recorder.prepare(sampleRate);
+}
+
+void MasterBus::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    float gainA, gainB;
+    getCrossfaderGains(crossfader.load(std::memory_order_relaxed), (Curve) curve.load(std::memory_order_relaxed), gainA, gainB);
+
+    for (int i = 0; i < jmin(maxDecks, deckEngine.getNumInputs()); ++i)
+    {
+        const auto side = (Side) sides[i].load(std::memory_order_relaxed);
+        deckEngine.setInputGain(i, side == Side::a ? gainA : side == Side::b ? gainB : 1.0f);
+    }
+
+    deckEngine.getNextAudioBlock(bufferToFill);
+
+    {
+        CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::limiter);
+        limiter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+    meter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    recorder.pushMaster(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+}
+
+void MasterBus::releaseResources()
+{
+    deckEngine.releaseResources();
+}
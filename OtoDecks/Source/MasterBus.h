@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    MasterBus.h
+    Created: 18 Oct 2026 12:41:07am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DeckEngine.h"
+#include "MasterLimiter.h"
+#include "LevelMeter.h"
+#include "AudioRecorder.h"
+
+//==============================================================================
+/*
+    What sits between the decks and the device: the crossfader, which sets
+    each deck's level in DeckEngine's sum, then the master limiter, which is
+    always on so nothing the decks do can clip the output. What leaves the
+    limiter is also what the recorder's master file gets.
+
+    Decks are on side A or B of the crossfader, or thru, ignoring it. By
+    default even decks are on A and odd ones on B, so the first two are
+    left and right. The setters can be called from any thread.
+*/
+class MasterBus : public AudioSource
+{
+public:
+    enum class Curve
+    {
+        constantPower,
+        linear,
+        cut
+    };
+
+    enum class Side
+    {
+        a,
+        b,
+        thru
+    };
+
+    static constexpr int maxDecks = 8;
+
+    /** e.g. "Constant power", for menus */
+    static String getCurveName(Curve curve);
+    /** side A and B levels for a crossfader position from 0 (all A) to 1 (all B) */
+    static void getCrossfaderGains(float position, Curve curve, float& gainA, float& gainB);
+
+    MasterBus(DeckEngine& _deckEngine, AudioRecorder& _recorder);
+
+    /** 0 is all side A, 1 is all side B */
+    void setCrossfader(float position);
+    float getCrossfader() const;
+    void setCurve(Curve curve);
+    Curve getCurve() const;
+    void setSide(int deckIndex, Side side);
+
+    /** how much the limiter is turning the mix down, in decibels */
+    float getGainReduction() const;
+    /** the levels going to the device, after the limiter */
+    LevelMeter& getMeter();
+
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    DeckEngine& deckEngine;
+    AudioRecorder& recorder;
+    MasterLimiter limiter;
+    LevelMeter meter;
+
+    std::atomic<float> crossfader{0.5f};
+    std::atomic<int> curve{(int) Curve::constantPower};
+    std::atomic<int> sides[maxDecks];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MasterBus)
+};
@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    MasterLimiter.cpp
+    Created: 18 Oct 2026 12:41:07am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "MasterLimiter.h"
+
+// long enough to ease the gain down over a few cycles of treble, short enough not to be heard as latency
+static const double lookaheadSeconds = 0.002;
+static const double releaseSeconds = 0.08;
+
+//==============================================================================
+void MasterLimiter::makeInterpolator(float (&coefficients)[numPhases - 1][numTaps])
+{
+    //windowed sinc for each fractional phase
+    for (int phase = 1; phase < numPhases; ++phase)
+    {
+        float sum = 0;
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            const double t = tap - interpolatorDelay - (double) phase / numPhases;
+            const double sinc = std::sin(MathConstants<double>::pi * t) / (MathConstants<double>::pi * t);
+            const double window = 0.5 + 0.5 * std::cos(MathConstants<double>::pi * t / (numTaps / 2));
+            coefficients[phase - 1][tap] = (float) (sinc * window);
+            sum += coefficients[phase - 1][tap];
+        }
+
+        //unity gain at DC
+        for (auto& coefficient : coefficients[phase - 1])
+        {
+            coefficient /= sum;
+        }
+    }
+}
+
+MasterLimiter::MasterLimiter()
+{
+    makeInterpolator(interpolator);
+}
+
+void MasterLimiter::prepare(int _maximumBlockSize, double _sampleRate, int _numChannels)
+{
+    sampleRate = _sampleRate;
+    maximumBlockSize = jmax(1, _maximumBlockSize);
+    numChannels = jmax(1, _numChannels);
+
+    lookahead = jmax(1, roundToInt(lookaheadSeconds * sampleRate));
+    //the gain worked out for a peak lands on the sample one after the interpolator's delay
+    delay = lookahead + interpolatorDelay;
+    releaseCoefficient = (float) (1.0 - std::exp(-1.0 / (releaseSeconds * sampleRate)));
+
+    history.setSize(numChannels, historySize + maximumBlockSize);
+    delayLine.setSize(numChannels, delay + maximumBlockSize);
+    peaks.allocate((size_t) maximumBlockSize, true);
+    interpolated.allocate((size_t) maximumBlockSize, true);
+    gains.allocate((size_t) maximumBlockSize, true);
+    windowGains.allocate((size_t) lookahead, true);
+    windowIndices.allocate((size_t) lookahead, true);
+    averageHistory.allocate((size_t) lookahead, true);
+
+    reset();
+}
+
+void MasterLimiter::reset()
+{
+    history.clear();
+    delayLine.clear();
+    lastRawPeak = 0;
+
+    windowStart = 0;
+    windowSize = 0;
+    sampleIndex = 0;
+
+    envelope = 1.0f;
+    for (int i = 0; i < lookahead; ++i)
+    {
+        averageHistory[i] = 1.0f;
+    }
+    averagePosition = 0;
+    averageSum = lookahead;
+
+    gainReduction = 0;
+}
+
+void MasterLimiter::setCeiling(float decibels)
+{
+    ceiling = Decibels::decibelsToGain(jmin(0.0f, decibels));
+}
+
+int MasterLimiter::getLatencySamples() const
+{
+    return delay;
+}
+
+float MasterLimiter::getGainReduction() const
+{
+    return gainReduction;
+}
+
+void MasterLimiter::process(AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    float reduction = 0;
+    for (int done = 0; done < numSamples; done += maximumBlockSize)
+    {
+        processChunk(buffer, startSample + done, jmin(maximumBlockSize, numSamples - done));
+        reduction = jmin(reduction, gainReduction.load(std::memory_order_relaxed));
+    }
+    gainReduction = reduction;
+}
+
+//==============================================================================
+void MasterLimiter::processChunk(AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numToProcess = jmin(numChannels, buffer.getNumChannels());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        //a channel the buffer doesn't have is silence
+        if (ch < numToProcess)
+        {
+            FloatVectorOperations::copy(history.getWritePointer(ch, historySize), buffer.getReadPointer(ch, startSample), numSamples);
+        }
+        else
+        {
+            FloatVectorOperations::clear(history.getWritePointer(ch, historySize), numSamples);
+        }
+        FloatVectorOperations::copy(delayLine.getWritePointer(ch, delay), history.getReadPointer(ch, historySize), numSamples);
+    }
+
+    detectPeaks(numSamples);
+    calculateGains(numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (ch < numToProcess)
+        {
+            FloatVectorOperations::multiply(buffer.getWritePointer(ch, startSample), delayLine.getReadPointer(ch), gains, numSamples);
+        }
+
+        //keep the tails for the next chunk
+        auto* historyData = history.getWritePointer(ch);
+        std::memmove(historyData, historyData + numSamples, sizeof(float) * (size_t) historySize);
+        auto* delayData = delayLine.getWritePointer(ch);
+        std::memmove(delayData, delayData + numSamples, sizeof(float) * (size_t) delay);
+    }
+}
+
+void MasterLimiter::detectPeaks(int numSamples)
+{
+    FloatVectorOperations::clear(peaks, numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        //x[n - k] for the chunk's sample n
+        auto* input = history.getReadPointer(ch, historySize);
+
+        FloatVectorOperations::abs(interpolated, input - interpolatorDelay, numSamples);
+        FloatVectorOperations::max(peaks, peaks, interpolated, numSamples);
+
+        for (auto& phase : interpolator)
+        {
+            FloatVectorOperations::clear(interpolated, numSamples);
+            for (int tap = 0; tap < numTaps; ++tap)
+            {
+                FloatVectorOperations::addWithMultiply(interpolated, input - tap, phase[tap], numSamples);
+            }
+            FloatVectorOperations::abs(interpolated, interpolated, numSamples);
+            FloatVectorOperations::max(peaks, peaks, interpolated, numSamples);
+        }
+    }
+
+    //each raw peak covers the three quarters of a sample before x[n - interpolatorDelay], so
+    //pairing it with the one before covers both sides of x[n - interpolatorDelay - 1]
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float rawPeak = peaks[i];
+        peaks[i] = jmax(rawPeak, lastRawPeak);
+        lastRawPeak = rawPeak;
+    }
+}
+
+void MasterLimiter::calculateGains(int numSamples)
+{
+    const float limit = ceiling.load(std::memory_order_relaxed);
+    float lowestGain = 1.0f;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float required = peaks[i] > limit ? limit / peaks[i] : 1.0f;
+
+        //sliding minimum: drop the oldest once it leaves the window, and the larger values behind the new one
+        if (windowSize > 0 && windowIndices[windowStart] <= sampleIndex - lookahead)
+        {
+            windowStart = (windowStart + 1) % lookahead;
+            --windowSize;
+        }
+        while (windowSize > 0 && windowGains[(windowStart + windowSize - 1) % lookahead] >= required)
+        {
+            --windowSize;
+        }
+        windowGains[(windowStart + windowSize) % lookahead] = required;
+        windowIndices[(windowStart + windowSize) % lookahead] = sampleIndex;
+        ++windowSize;
+
+        const float held = windowGains[windowStart];
+
+        envelope = held < envelope ? held : envelope + (held - envelope) * releaseCoefficient;
+
+        //averaging the held gain over the look-ahead reaches each peak's gain just as the peak comes out
+        averageSum += envelope - averageHistory[averagePosition];
+        averageHistory[averagePosition] = envelope;
+        averagePosition = (averagePosition + 1) % lookahead;
+
+        gains[i] = jmin(1.0f, (float) (averageSum / lookahead));
+        lowestGain = jmin(lowestGain, gains[i]);
+        ++sampleIndex;
+    }
+
+    gainReduction.store(Decibels::gainToDecibels(lowestGain, -100.0f), std::memory_order_relaxed);
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    MasterLimiter.h
+    Created: 18 Oct 2026 12:41:07am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Look-ahead brickwall limiter for the master output, so a hot mix never
+    clips the device.
+
+    Peaks are measured on the true-peak waveform: each channel is interpolated
+    four times over with a short windowed-sinc filter, as in ITU-R BS.1770, so
+    inter-sample overs are caught as well as the samples themselves. The audio
+    is delayed by the look-ahead, which lets the gain come down smoothly before
+    a peak arrives instead of slamming down on it.
+
+    Everything is allocated in prepare(). Detection and gain are applied with
+    FloatVectorOperations; only the gain envelope runs sample by sample.
+*/
+class MasterLimiter
+{
+public:
+    // the true-peak interpolator: four phases of a twelve tap windowed sinc
+    static constexpr int numPhases = 4;
+    static constexpr int numTaps = 12;
+    // the interpolator's output lags its input by about half its length
+    static constexpr int interpolatorDelay = numTaps / 2 - 1;
+
+    /** the coefficients of the fractional phases, phase p landing p/4 of a sample before x[n - interpolatorDelay].
+        Phase 0, the samples themselves, needs none */
+    static void makeInterpolator(float (&coefficients)[numPhases - 1][numTaps]);
+
+    MasterLimiter();
+
+    /** allocates everything process() will need */
+    void prepare(int maximumBlockSize, double sampleRate, int numChannels);
+    /** clears the delay line and lets the gain go back to unity */
+    void reset();
+
+    /** the highest true peak let through, in dBTP */
+    void setCeiling(float decibels);
+    /** how far the output lags the input, in samples */
+    int getLatencySamples() const;
+    /** the most the gain was turned down during the last block, in decibels (any thread) */
+    float getGainReduction() const;
+
+    /** limits the buffer in place (audio thread) */
+    void process(AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+private:
+    static constexpr int historySize = numTaps - 1;
+
+    /** processes no more than maximumBlockSize samples */
+    void processChunk(AudioBuffer<float>& buffer, int startSample, int numSamples);
+    /** the highest true peak of all channels around each of the chunk's samples, into peaks */
+    void detectPeaks(int numSamples);
+    /** turns peaks into the gain for each sample, into gains */
+    void calculateGains(int numSamples);
+
+    double sampleRate = 44100.0;
+    int maximumBlockSize = 0;
+    int numChannels = 0;
+    int lookahead = 1;
+    int delay = 1;
+
+    // the fractional-sample phases of the interpolator
+    float interpolator[numPhases - 1][numTaps];
+
+    // each channel's last historySize input samples, then the chunk
+    AudioBuffer<float> history;
+    // each channel's last delay input samples, then the chunk
+    AudioBuffer<float> delayLine;
+    HeapBlock<float> peaks, interpolated, gains;
+    float lastRawPeak = 0;
+
+    // minimum of the required gain over the look-ahead window, as a queue of ascending values
+    HeapBlock<float> windowGains;
+    HeapBlock<int64> windowIndices;
+    int windowStart = 0;
+    int windowSize = 0;
+    int64 sampleIndex = 0;
+
+    // instant attack, smooth release, then a moving average the length of the look-ahead
+    float envelope = 1.0f;
+    float releaseCoefficient = 0;
+    HeapBlock<float> averageHistory;
+    int averagePosition = 0;
+    double averageSum = 0;
+
+    std::atomic<float> ceiling{0.891f};
+    std::atomic<float> gainReduction{0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MasterLimiter)
+};
@@ -0,0 +1,364 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 17 Oct 2026 11:18:06pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "OfflineRenderer.h"
+
+// how long a load may take before the render gives up on it
+static const int loadTimeoutMs = 60000;
+
+//==============================================================================
+bool OfflineRenderer::isRequested(const String& commandLine)
+{
+    return commandLine.contains("--render");
+}
+
+int OfflineRenderer::run(const String& commandLine)
+{
+    auto tokens = StringArray::fromTokens(commandLine.fromFirstOccurrenceOf("--render", false, false), true);
+    tokens.removeEmptyStrings();
+
+    StringArray paths;
+    double rate = 44100.0;
+    int block = 512;
+    int bits = 32;
+    String expectedChecksum;
+    String profilePath;
+
+    for (auto& token : tokens)
+    {
+        const auto value = token.fromFirstOccurrenceOf("=", false, false);
+
+        if (token.startsWith("--rate="))            rate = value.getDoubleValue();
+        else if (token.startsWith("--block="))      block = value.getIntValue();
+        else if (token.startsWith("--bits="))       bits = value.getIntValue();
+        else if (token.startsWith("--expect="))     expectedChecksum = value;
+        else if (token.startsWith("--profile="))    profilePath = value.unquoted();
+        else if (! token.startsWith("--"))          paths.add(token.unquoted());
+    }
+
+    if (paths.size() < 2 || rate <= 0 || block <= 0 || (bits != 16 && bits != 24 && bits != 32))
+    {
+        std::cout << "usage: OtoDecks --render session.txt mix.wav [--rate=44100] [--block=512] "
+                  << "[--bits=16|24|32] [--expect=<checksum>] [--profile=report.txt]" << std::endl;
+        return 1;
+    }
+
+    OfflineRenderer renderer(rate, block);
+    const auto workingDirectory = File::getCurrentWorkingDirectory();
+    CallbackProfiler::getInstance().setEnabled(profilePath.isNotEmpty());
+
+    if (! renderer.loadSession(workingDirectory.getChildFile(paths[0]))
+        || ! renderer.render(workingDirectory.getChildFile(paths[1]), bits))
+    {
+        return 1;
+    }
+
+    //a deadline miss here is a block that rendered slower than real time
+    if (profilePath.isNotEmpty())
+    {
+        CallbackProfiler::getInstance().writeReport(workingDirectory.getChildFile(profilePath));
+    }
+
+    const auto checksum = String::toHexString((int64) renderer.getChecksum());
+    std::cout << "checksum " << checksum << std::endl;
+
+    if (expectedChecksum.isNotEmpty() && expectedChecksum != checksum)
+    {
+        std::cout << "OfflineRenderer::run render does not match the expected checksum " << expectedChecksum << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer(double _sampleRate, int _blockSize)
+                : sampleRate(_sampleRate),
+                  blockSize(_blockSize)
+{
+    formatManager.registerBasicFormats();
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    //the engine still points at the players
+    masterBus = nullptr;
+    deckEngine = nullptr;
+    players.clear();
+}
+
+bool OfflineRenderer::loadSession(const File& sessionFile)
+{
+    if (! sessionFile.existsAsFile())
+    {
+        std::cout << "OfflineRenderer::loadSession cannot find " << sessionFile.getFullPathName() << std::endl;
+        return false;
+    }
+
+    const StringArray actionsWithValues { "load", "gain", "speed", "position", "keylock", "sync", "quality", "setcue", "cue", "loop" };
+    const StringArray actionsWithoutValues { "play", "stop", "master", "loopin", "loopout", "halve", "double", "exitloop" };
+    const StringArray mixerActions { "crossfader", "curve" };
+
+    StringArray lines;
+    lines.addLines(sessionFile.loadFileAsString());
+
+    events.clear();
+    sessionDirectory = sessionFile.getParentDirectory();
+    lengthInSamples = 0;
+    numDecks = 0;
+
+    for (int i = 0; i < lines.size(); ++i)
+    {
+        const auto line = lines[i].trim();
+        if (line.isEmpty() || line.startsWith("#"))
+        {
+            continue;
+        }
+
+        auto fields = StringArray::fromTokens(line, true);
+        fields.removeEmptyStrings();
+
+        const auto sample = (int64) std::llround(fields[0].getDoubleValue() * sampleRate);
+        if (fields[1] == "end")
+        {
+            lengthInSamples = sample;
+            continue;
+        }
+
+        Event event;
+        event.sample = sample;
+        event.deck = fields[1] == "mixer" ? -1 : fields[1].getIntValue();
+        event.action = fields[2];
+        event.lineNumber = i + 1;
+
+        //the value is the rest of the line, so paths may have spaces in them
+        event.value = line.fromFirstOccurrenceOf(fields[2], false, false).trim().unquoted();
+
+        if (event.deck < 0)
+        {
+            if (! mixerActions.contains(event.action) || event.value.isEmpty())
+            {
+                std::cout << "OfflineRenderer::loadSession line " << event.lineNumber
+                          << ": the mixer takes crossfader <0 to 1> or curve <power|linear|cut>" << std::endl;
+                return false;
+            }
+            events.add(event);
+            continue;
+        }
+
+        const bool needsValue = actionsWithValues.contains(event.action);
+        if (! needsValue && ! actionsWithoutValues.contains(event.action))
+        {
+            std::cout << "OfflineRenderer::loadSession line " << event.lineNumber << ": unknown action '"
+                      << event.action << "'" << std::endl;
+            return false;
+        }
+        if (needsValue && event.value.isEmpty())
+        {
+            std::cout << "OfflineRenderer::loadSession line " << event.lineNumber << ": " << event.action
+                      << " needs a value" << std::endl;
+            return false;
+        }
+        if (! isPositiveAndBelow(event.deck, BeatSync::maxDecks) || ! fields[1].containsOnly("0123456789"))
+        {
+            std::cout << "OfflineRenderer::loadSession line " << event.lineNumber << ": decks are numbered 0 to "
+                      << BeatSync::maxDecks - 1 << std::endl;
+            return false;
+        }
+
+        numDecks = jmax(numDecks, event.deck + 1);
+        events.add(event);
+    }
+
+    if (lengthInSamples <= 0)
+    {
+        std::cout << "OfflineRenderer::loadSession the session needs an end, e.g. \"120 end\"" << std::endl;
+        return false;
+    }
+
+    //events at the same time keep their order in the file, so a load can come before its play
+    std::stable_sort(events.begin(), events.end(),
+                     [] (const Event& a, const Event& b) { return a.sample < b.sample; });
+    return true;
+}
+
+bool OfflineRenderer::render(const File& outputFile, int bitsPerSample)
+{
+    //the same graph as MainComponent, minus the audio device
+    masterBus = nullptr;
+    deckEngine = nullptr;
+    players.clear();
+    //no workers: decks render one after another on this thread, so a synced deck always reads
+    //the master's clock from the same point and two renders of a set come out identical
+    deckEngine.reset(new DeckEngine(0));
+    masterBus.reset(new MasterBus(*deckEngine, recorder));
+
+    for (int i = 0; i < numDecks; ++i)
+    {
+        auto* player = players.add(new DJAudioPlayer(formatManager, readAheadPool, decodedTrackCache, trackAnalyser, beatSync, recorder, i));
+        player->setOfflineRendering(true);
+        player->setAutoGain(false);
+        deckEngine->addInput(player);
+    }
+
+    outputFile.deleteFile();
+    std::unique_ptr<FileOutputStream> stream (new FileOutputStream(outputFile));
+    if (! stream->openedOk())
+    {
+        std::cout << "OfflineRenderer::render cannot write to " << outputFile.getFullPathName() << std::endl;
+        return false;
+    }
+
+    WavAudioFormat wav;
+    std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor(stream.get(), sampleRate, 2, bitsPerSample, {}, 0));
+    if (writer == nullptr)
+    {
+        std::cout << "OfflineRenderer::render cannot write " << bitsPerSample << "-bit WAV at " << sampleRate << "Hz" << std::endl;
+        return false;
+    }
+    //the writer owns the stream now
+    stream.release();
+
+    masterBus->prepareToPlay(blockSize, sampleRate);
+
+    AudioBuffer<float> buffer(2, blockSize);
+    checksum = 14695981039346656037ull;
+    int nextEvent = 0;
+    int64 position = 0;
+    bool succeeded = true;
+
+    const auto startTicks = Time::getHighResolutionTicks();
+
+    while (position < lengthInSamples && succeeded)
+    {
+        while (succeeded && nextEvent < events.size() && events.getReference(nextEvent).sample <= position)
+        {
+            succeeded = perform(events.getReference(nextEvent++));
+        }
+
+        //stop short of the next event, so it lands on its exact sample
+        auto end = jmin(position + blockSize, lengthInSamples);
+        if (nextEvent < events.size())
+        {
+            end = jmin(end, events.getReference(nextEvent).sample);
+        }
+        const int numSamples = (int) (end - position);
+
+        {
+            CallbackProfiler::ScopedStage callback(numSamples, sampleRate);
+            masterBus->getNextAudioBlock(AudioSourceChannelInfo(&buffer, 0, numSamples));
+        }
+        writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* bytes = reinterpret_cast<const uint8*>(buffer.getReadPointer(ch));
+            for (size_t i = 0; i < (size_t) numSamples * sizeof(float); ++i)
+            {
+                checksum = (checksum ^ bytes[i]) * 1099511628211ull;
+            }
+        }
+
+        position = end;
+    }
+
+    const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    masterBus->releaseResources();
+    writer = nullptr;
+
+    const double renderedSeconds = position / sampleRate;
+    std::cout << "Rendered " << String(renderedSeconds, 1) << "s from " << numDecks << " decks in "
+              << String(seconds, 2) << "s (" << String(renderedSeconds / jmax(seconds, 1.0e-6), 1)
+              << "x real time, loads included) to " << outputFile.getFullPathName() << std::endl;
+    return succeeded;
+}
+
+uint64 OfflineRenderer::getChecksum() const
+{
+    return checksum;
+}
+
+//==============================================================================
+bool OfflineRenderer::perform(const Event& event)
+{
+    if (event.deck < 0)
+    {
+        if (event.action == "crossfader")
+        {
+            masterBus->setCrossfader(event.value.getFloatValue());
+            return true;
+        }
+
+        const MasterBus::Curve curves[] = { MasterBus::Curve::constantPower, MasterBus::Curve::linear, MasterBus::Curve::cut };
+        for (auto curve : curves)
+        {
+            //"power" will do for "Constant power"
+            if (MasterBus::getCurveName(curve).endsWithIgnoreCase(event.value))
+            {
+                masterBus->setCurve(curve);
+                return true;
+            }
+        }
+        std::cout << "OfflineRenderer::perform line " << event.lineNumber << ": curve is power, linear or cut" << std::endl;
+        return false;
+    }
+
+    auto* player = players[event.deck];
+    const auto& action = event.action;
+    const bool isOn = event.value == "on";
+
+    if (action == "load")
+    {
+        const auto file = sessionDirectory.getChildFile(event.value);
+        if (! file.existsAsFile())
+        {
+            std::cout << "OfflineRenderer::perform line " << event.lineNumber << ": cannot find " << file.getFullPathName() << std::endl;
+            return false;
+        }
+
+        //rendering waits for the track, so it is in place on the event's sample however long decoding takes
+        player->loadURL(URL{file});
+        if (! player->waitForLoad(loadTimeoutMs))
+        {
+            std::cout << "OfflineRenderer::perform line " << event.lineNumber << ": could not load " << file.getFullPathName() << std::endl;
+            return false;
+        }
+    }
+    else if (action == "play")          player->start();
+    else if (action == "stop")          player->stop();
+    else if (action == "gain")          player->setGain(event.value.getDoubleValue());
+    else if (action == "speed")         player->setSpeed(event.value.getDoubleValue());
+    else if (action == "position")      player->setPosition(event.value.getDoubleValue());
+    else if (action == "keylock")       player->setKeyLock(isOn);
+    else if (action == "sync")          player->setSync(isOn);
+    else if (action == "master")        player->makeSyncMaster();
+    else if (action == "setcue")        player->setHotCue(event.value.getIntValue() - 1);
+    else if (action == "cue")           player->triggerHotCue(event.value.getIntValue() - 1);
+    else if (action == "loop")          player->setBeatLoop(event.value.getDoubleValue());
+    else if (action == "loopin")        player->setLoopIn();
+    else if (action == "loopout")       player->setLoopOut();
+    else if (action == "halve")         player->halveLoop();
+    else if (action == "double")        player->doubleLoop();
+    else if (action == "exitloop")      player->exitLoop();
+    else if (action == "quality")
+    {
+        for (auto quality : { VarispeedResampler::Quality::linear, VarispeedResampler::Quality::cubic, VarispeedResampler::Quality::sinc })
+        {
+            if (event.value.equalsIgnoreCase(VarispeedResampler::getQualityName(quality)))
+            {
+                player->setResamplingQuality(quality);
+                return true;
+            }
+        }
+        std::cout << "OfflineRenderer::perform line " << event.lineNumber << ": quality is linear, cubic or sinc" << std::endl;
+        return false;
+    }
+    return true;
+}
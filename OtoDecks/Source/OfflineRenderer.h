@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 17 Oct 2026 11:18:06pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DJAudioPlayer.h"
+#include "ReadAheadPool.h"
+#include "DecodedTrackCache.h"
+#include "DeckEngine.h"
+#include "MasterBus.h"
+#include "BeatSync.h"
+#include "TrackAnalyser.h"
+#include "CallbackProfiler.h"
+
+//==============================================================================
+/*
+    Renders a scripted session through the decks, DeckEngine and MasterBus, with
+    no audio device, as fast as the CPU allows, and writes the mix to a WAV file:
+
+        OtoDecks --render session.txt mix.wav [--rate=44100] [--block=512] [--bits=32] [--expect=<checksum>]
+                                              [--profile=report.txt]
+
+    The session has one event per line, "<seconds> <deck> <action> [value]", with
+    "mixer" in place of the deck for the crossfader, and ends with "<seconds> end". Blank lines and lines starting with # are skipped.
+
+        0     0 load   tracks/intro.mp3     paths are relative to the session file
+        0     0 play
+        0     0 gain   0.8
+        30    1 load   tracks/second.wav
+        32    1 sync   on                   also: keylock on/off, master, quality linear/cubic/sinc
+        32    1 play
+        45.5  0 speed  1.04
+        60    0 position 90                 seconds into the track
+        62    0 setcue 1                    hot cues 1 to 8; cue 1 jumps back
+        64    0 loop   0.125                beats; also: loopin, loopout, halve, double, exitloop
+        80    mixer crossfader 0.75         0 is all side A (even decks), 1 all side B
+        80    mixer curve cut               also: linear, power
+        90    0 stop
+        120   end
+
+    Events land on their exact sample, and loads finish before rendering goes on,
+    so the same session always renders the same samples. The checksum printed at
+    the end can be passed back with --expect to use a session as a regression test.
+    --profile writes CallbackProfiler's report on the render's blocks.
+*/
+class OfflineRenderer
+{
+public:
+    /** true if the command line asks for a render */
+    static bool isRequested(const String& commandLine);
+
+    /** renders the session named on the command line. Returns the process exit code */
+    static int run(const String& commandLine);
+
+    OfflineRenderer(double _sampleRate, int _blockSize);
+    ~OfflineRenderer();
+
+    /** parses a session file, printing the first problem found */
+    bool loadSession(const File& sessionFile);
+
+    /** renders the loaded session into a WAV file, 32 bits being float */
+    bool render(const File& outputFile, int bitsPerSample);
+
+    /** FNV-1a hash of the samples last rendered, for comparing against a known good render */
+    uint64 getChecksum() const;
+
+private:
+    struct Event
+    {
+        int64 sample = 0;
+        // -1 for the mixer
+        int deck = 0;
+        String action;
+        String value;
+        int lineNumber = 0;
+    };
+
+    /** carries out one event on its deck. False if it failed */
+    bool perform(const Event& event);
+
+    const double sampleRate;
+    const int blockSize;
+
+    Array<Event> events;
+    File sessionDirectory;
+    int64 lengthInSamples = 0;
+    int numDecks = 0;
+    uint64 checksum = 0;
+
+    AudioFormatManager formatManager;
+    ReadAheadPool readAheadPool;
+    // a generous budget so a whole session's tracks normally stay in RAM
+    DecodedTrackCache decodedTrackCache{formatManager, (int64) 2048 * 1024 * 1024};
+    // the players need one, but nothing is analysed: auto gain is off so renders don't depend on it
+    TrackAnalyser trackAnalyser{formatManager, 1};
+    BeatSync beatSync;
+    // the decks and master bus need one, but the render is the recording so it's never started
+    AudioRecorder recorder;
+    OwnedArray<DJAudioPlayer> players;
+    std::unique_ptr<DeckEngine> deckEngine;
+    std::unique_ptr<MasterBus> masterBus;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
@@ -0,0 +1,512 @@
+/*
+  ==============================================================================
+
+    PerformanceBenchmarks.cpp
+    Created: 17 Oct 2026 4:05:12pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PerformanceBenchmarks.h"
+#include "TimeStretcher.h"
+#include "VarispeedResampler.h"
+#include "VectorKernels.h"
+#include "DeckEngine.h"
+#include "DeckEQ.h"
+#include "TrackAnalyser.h"
+
+//==============================================================================
+/*
+    Stand-in for a track: a few detuned partials and some noise, so the
+    stretcher's similarity search has something realistic to chew on.
+*/
+class BenchmarkToneSource : public AudioSource
+{
+public:
+    void prepareToPlay (int samplesPerBlockExpected, double _sampleRate) override
+    {
+        sampleRate = _sampleRate;
+    }
+
+    void releaseResources() override {}
+
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override
+    {
+        for (int i = 0; i < bufferToFill.numSamples; ++i)
+        {
+            const double t = (double) position++ / sampleRate;
+            const float sample = (float) (0.3 * std::sin(MathConstants<double>::twoPi * 110.0 * t)
+                                        + 0.2 * std::sin(MathConstants<double>::twoPi * 331.0 * t)
+                                        + 0.1 * std::sin(MathConstants<double>::twoPi * 1247.0 * t))
+                                 + 0.05f * (random.nextFloat() - 0.5f);
+
+            for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+            {
+                bufferToFill.buffer->setSample(ch, bufferToFill.startSample + i, sample);
+            }
+        }
+    }
+
+private:
+    double sampleRate = 44100.0;
+    int64 position = 0;
+    Random random{42};
+};
+
+/*
+    A single sine, for measuring what a stage does to one frequency.
+*/
+class BenchmarkSineSource : public AudioSource
+{
+public:
+    BenchmarkSineSource(double _frequency) : frequency(_frequency) {}
+
+    void prepareToPlay (int samplesPerBlockExpected, double _sampleRate) override
+    {
+        sampleRate = _sampleRate;
+    }
+
+    void releaseResources() override {}
+
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override
+    {
+        for (int i = 0; i < bufferToFill.numSamples; ++i)
+        {
+            const auto sample = (float) (0.5 * std::sin(MathConstants<double>::twoPi * frequency * (double) position++ / sampleRate));
+
+            for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+            {
+                bufferToFill.buffer->setSample(ch, bufferToFill.startSample + i, sample);
+            }
+        }
+    }
+
+private:
+    double frequency;
+    double sampleRate = 44100.0;
+    int64 position = 0;
+};
+
+/*
+    A busy deck: the tone through key lock, the sinc resampler and the EQ.
+*/
+class BenchmarkDeck : public AudioSource
+{
+public:
+    BenchmarkDeck()
+    {
+        timeStretcher.setKeyLock(true);
+        timeStretcher.setStretchRatio(1.06);
+        resampler.setQuality(VarispeedResampler::Quality::sinc);
+        resampler.setResamplingRatio(1.03);
+        eq.setBandGain(DeckEQ::Band::low, 0.0f);
+        eq.setFilter(0.3f);
+    }
+
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override
+    {
+        resampler.prepareToPlay(samplesPerBlockExpected, sampleRate);
+        eq.prepare(samplesPerBlockExpected, sampleRate, 2);
+    }
+
+    void releaseResources() override
+    {
+        resampler.releaseResources();
+    }
+
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override
+    {
+        resampler.getNextAudioBlock(bufferToFill);
+        eq.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+
+private:
+    BenchmarkToneSource tone;
+    TimeStretcher timeStretcher{&tone, 2};
+    VarispeedResampler resampler{&timeStretcher, 2};
+    DeckEQ eq;
+};
+
+//==============================================================================
+//tier 0 is JUCE's ResamplingAudioSource, 1 - 3 are the VarispeedResampler qualities
+static const int numResamplerTiers = 4;
+
+static String getResamplerTierName(int tier)
+{
+    if (tier == 0)
+    {
+        return "ResamplingAudioSource";
+    }
+    return VarispeedResampler::getQualityName((VarispeedResampler::Quality) (tier - 1));
+}
+
+static std::unique_ptr<AudioSource> createResampler(int tier, AudioSource* input, double ratio)
+{
+    if (tier == 0)
+    {
+        auto resampler = std::make_unique<ResamplingAudioSource>(input, false, 2);
+        resampler->setResamplingRatio(ratio);
+        return resampler;
+    }
+
+    auto resampler = std::make_unique<VarispeedResampler>(input, 2);
+    resampler->setQuality((VarispeedResampler::Quality) (tier - 1));
+    resampler->setResamplingRatio(ratio);
+    return resampler;
+}
+
+//output level of a resampled 0.5 amplitude sine, relative to the input's
+static double measureResamplerGain(int tier, double frequency, double ratio)
+{
+    const double sampleRate = 44100.0;
+    const int blockSize = 512;
+
+    BenchmarkSineSource sine(frequency);
+    auto resampler = createResampler(tier, &sine, ratio);
+    resampler->prepareToPlay(blockSize, sampleRate);
+
+    AudioBuffer<float> buffer(2, blockSize);
+    double sumOfSquares = 0;
+    int numSamples = 0;
+
+    for (int i = 0; i < 200; ++i)
+    {
+        resampler->getNextAudioBlock(AudioSourceChannelInfo(buffer));
+
+        //skip the filters' start-up
+        if (i >= 10)
+        {
+            for (int j = 0; j < blockSize; ++j)
+            {
+                sumOfSquares += buffer.getSample(0, j) * buffer.getSample(0, j);
+            }
+            numSamples += blockSize;
+        }
+    }
+
+    resampler->releaseResources();
+    return Decibels::gainToDecibels(std::sqrt(sumOfSquares / numSamples) / (0.5 / MathConstants<double>::sqrt2), -200.0);
+}
+
+//==============================================================================
+bool PerformanceBenchmarks::isRequested(const String& commandLine)
+{
+    return commandLine.contains("--benchmark");
+}
+
+void PerformanceBenchmarks::run(const String& commandLine)
+{
+    auto names = StringArray::fromTokens(commandLine.fromFirstOccurrenceOf("--benchmark", false, false), true);
+    names.removeEmptyStrings();
+
+    if (names.isEmpty() || names.contains("timestretch"))
+    {
+        timeStretch();
+    }
+    if (names.isEmpty() || names.contains("resampling"))
+    {
+        resampling();
+    }
+    if (names.isEmpty() || names.contains("decks"))
+    {
+        deckScaling();
+    }
+    if (names.isEmpty() || names.contains("eq"))
+    {
+        deckEq();
+    }
+    if (names.isEmpty() || names.contains("analysis"))
+    {
+        trackAnalysis();
+    }
+}
+
+void PerformanceBenchmarks::timeStretch()
+{
+    const double sampleRate = 44100.0;
+    const int blockSize = 512;
+    const int secondsPerRun = 60;
+    const int numBlocks = (int) (sampleRate * secondsPerRun) / blockSize;
+    const double ratios[] = { 0.5, 0.8, 0.94, 1.0, 1.06, 1.25, 1.5, 2.0 };
+
+    std::cout << "Time-stretch (key lock): " << secondsPerRun << "s of stereo audio per ratio, "
+              << blockSize << "-sample blocks at " << sampleRate << "Hz" << std::endl;
+    std::cout << "ratio   us/block   CPU per deck   decks per core" << std::endl;
+
+    AudioBuffer<float> buffer(2, blockSize);
+
+    for (auto ratio : ratios)
+    {
+        BenchmarkToneSource tone;
+        TimeStretcher stretcher(&tone, 2);
+        stretcher.setKeyLock(true);
+        stretcher.setStretchRatio(ratio);
+        stretcher.prepareToPlay(blockSize, sampleRate);
+
+        //one second to settle before timing
+        for (int i = 0; i < (int) sampleRate / blockSize; ++i)
+        {
+            stretcher.getNextAudioBlock(AudioSourceChannelInfo(buffer));
+        }
+
+        const auto startTicks = Time::getHighResolutionTicks();
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            stretcher.getNextAudioBlock(AudioSourceChannelInfo(buffer));
+        }
+        const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+        stretcher.releaseResources();
+
+        //the fraction of one core a key-locked deck keeps busy in real time
+        const double cpuPerDeck = seconds / ((double) numBlocks * blockSize / sampleRate);
+        std::cout << String(ratio, 2).paddedRight(' ', 8)
+                  << String(seconds * 1.0e6 / numBlocks, 1).paddedRight(' ', 11)
+                  << (String(cpuPerDeck * 100.0, 3) + "%").paddedRight(' ', 15)
+                  << (int) (1.0 / jmax(cpuPerDeck, 1.0e-9)) << std::endl;
+    }
+}
+
+void PerformanceBenchmarks::resampling()
+{
+    const double sampleRate = 44100.0;
+    const int blockSize = 512;
+    const int secondsPerRun = 60;
+    const int numBlocks = (int) (sampleRate * secondsPerRun) / blockSize;
+
+    //a typical pitch-bend ratio for throughput, and a 1.5x speed-up for the filters
+    const double throughputRatio = 1.06;
+    const double filterRatio = 1.5;
+
+    std::cout << std::endl << "Resampling (" << VectorKernels::getInstructionSetName() << " kernels): "
+              << secondsPerRun << "s of stereo at " << throughputRatio << "x per quality" << std::endl;
+    std::cout << "At " << filterRatio << "x, passband is the level of an 8kHz tone (0dB is perfect) and "
+              << "alias is what is left of a 20kHz tone that no longer fits below Nyquist (lower is better)" << std::endl;
+    std::cout << "quality                Msamples/s   CPU per deck   passband   alias" << std::endl;
+
+    AudioBuffer<float> buffer(2, blockSize);
+
+    for (int tier = 0; tier < numResamplerTiers; ++tier)
+    {
+        BenchmarkToneSource tone;
+        auto resampler = createResampler(tier, &tone, throughputRatio);
+        resampler->prepareToPlay(blockSize, sampleRate);
+
+        const auto startTicks = Time::getHighResolutionTicks();
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            resampler->getNextAudioBlock(AudioSourceChannelInfo(buffer));
+        }
+        const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+        resampler->releaseResources();
+
+        const double cpuPerDeck = seconds / ((double) numBlocks * blockSize / sampleRate);
+        const double passband = measureResamplerGain(tier, 8000.0, filterRatio);
+        const double alias = measureResamplerGain(tier, 20000.0, filterRatio);
+
+        std::cout << getResamplerTierName(tier).paddedRight(' ', 23)
+                  << String((double) numBlocks * blockSize / seconds / 1.0e6, 1).paddedRight(' ', 13)
+                  << (String(cpuPerDeck * 100.0, 3) + "%").paddedRight(' ', 15)
+                  << (String(passband, 1) + "dB").paddedRight(' ', 11)
+                  << String(alias, 1) << "dB" << std::endl;
+    }
+}
+
+void PerformanceBenchmarks::deckScaling()
+{
+    const double sampleRate = 44100.0;
+    const int blockSize = 256;
+    const int numDecks = 8;
+    const int numBlocks = (int) (sampleRate * 20) / blockSize;
+    const double blockDuration = blockSize / sampleRate;
+
+    std::cout << std::endl << "Deck engine: " << numDecks << " key-locked decks with sinc resampling and EQ, "
+              << blockSize << "-sample blocks, " << SystemStats::getNumCpus() << " CPUs" << std::endl;
+    std::cout << "workers   us/block   speed-up   of the block's time budget" << std::endl;
+
+    AudioBuffer<float> buffer(2, blockSize);
+    double serialSeconds = 0;
+
+    for (int numWorkers = 0; numWorkers <= DeckEngine::getDefaultNumWorkers(numDecks); ++numWorkers)
+    {
+        OwnedArray<BenchmarkDeck> decks;
+        DeckEngine engine(numWorkers);
+        for (int i = 0; i < numDecks; ++i)
+        {
+            engine.addInput(decks.add(new BenchmarkDeck()));
+        }
+        engine.prepareToPlay(blockSize, sampleRate);
+
+        //let the workers spin up before timing
+        for (int i = 0; i < 100; ++i)
+        {
+            engine.getNextAudioBlock(AudioSourceChannelInfo(buffer));
+        }
+
+        const auto startTicks = Time::getHighResolutionTicks();
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            engine.getNextAudioBlock(AudioSourceChannelInfo(buffer));
+        }
+        const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+        engine.releaseResources();
+
+        if (numWorkers == 0)
+        {
+            serialSeconds = seconds;
+        }
+
+        std::cout << String(numWorkers).paddedRight(' ', 10)
+                  << String(seconds * 1.0e6 / numBlocks, 1).paddedRight(' ', 11)
+                  << (String(serialSeconds / seconds, 2) + "x").paddedRight(' ', 11)
+                  << String(seconds / numBlocks / blockDuration * 100.0, 1) << "%" << std::endl;
+    }
+
+    //the same engine called at the pace of a device, to see what the workers cost while they wait
+    const int numPacedBlocks = (int) (sampleRate * 5) / blockSize;
+    std::cout << std::endl << "Paced like a device, " << numPacedBlocks * blockDuration << "s" << std::endl;
+    std::cout << "workers   spinning per worker   of the block's time budget   late inputs" << std::endl;
+
+    for (int numWorkers = 1; numWorkers <= DeckEngine::getDefaultNumWorkers(numDecks); ++numWorkers)
+    {
+        OwnedArray<BenchmarkDeck> decks;
+        DeckEngine engine(numWorkers);
+        for (int i = 0; i < numDecks; ++i)
+        {
+            engine.addInput(decks.add(new BenchmarkDeck()));
+        }
+        engine.prepareToPlay(blockSize, sampleRate);
+        engine.resetStats();
+
+        double renderSeconds = 0;
+        const auto startTicks = Time::getHighResolutionTicks();
+        for (int i = 0; i < numPacedBlocks; ++i)
+        {
+            //sleep most of the way to when the block is due, then yield the rest
+            const auto due = startTicks + Time::secondsToHighResolutionTicks(i * blockDuration);
+            for (auto now = Time::getHighResolutionTicks(); now < due; now = Time::getHighResolutionTicks())
+            {
+                if (Time::highResolutionTicksToSeconds(due - now) > 0.002)
+                {
+                    Thread::sleep(1);
+                }
+                else
+                {
+                    Thread::yield();
+                }
+            }
+
+            const auto blockStart = Time::getHighResolutionTicks();
+            engine.getNextAudioBlock(AudioSourceChannelInfo(buffer));
+            renderSeconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - blockStart);
+        }
+        const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+
+        engine.releaseResources();
+
+        const auto stats = engine.getStats();
+        std::cout << String(numWorkers).paddedRight(' ', 10)
+                  << (String(stats.workerSpinSeconds / numWorkers / seconds * 100.0, 1) + "%").paddedRight(' ', 22)
+                  << (String(renderSeconds / numPacedBlocks / blockDuration * 100.0, 1) + "%").paddedRight(' ', 29)
+                  << stats.lateInputs << std::endl;
+    }
+}
+
+void PerformanceBenchmarks::deckEq()
+{
+    const double sampleRate = 44100.0;
+    const int blockSize = 256;
+    const int numDecks = 8;
+    const int secondsPerRun = 60;
+    const int numBlocks = (int) (sampleRate * secondsPerRun) / blockSize;
+    const double blockDuration = blockSize / sampleRate;
+    const char* settings[] = { "flat", "low and high killed", "filter sweeping" };
+
+    std::cout << std::endl << "Deck EQ: " << secondsPerRun << "s of stereo per setting, " << blockSize << "-sample blocks, "
+              << dsp::SIMDRegister<float>::size() << " float lanes" << std::endl;
+    std::cout << "setting                us/block   CPU per deck   " << numDecks << " decks of the block's time budget" << std::endl;
+
+    //the same block of tone every time, so only the EQ is timed
+    BenchmarkToneSource tone;
+    tone.prepareToPlay(blockSize, sampleRate);
+    AudioBuffer<float> input(2, blockSize);
+    tone.getNextAudioBlock(AudioSourceChannelInfo(input));
+    AudioBuffer<float> buffer(2, blockSize);
+
+    ScopedNoDenormals noDenormals;
+
+    for (int setting = 0; setting < 3; ++setting)
+    {
+        DeckEQ eq;
+        eq.prepare(blockSize, sampleRate, 2);
+        if (setting == 1)
+        {
+            eq.setBandGain(DeckEQ::Band::low, 0.0f);
+            eq.setBandGain(DeckEQ::Band::high, 0.0f);
+        }
+
+        double seconds = 0;
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            buffer.makeCopyOf(input, true);
+
+            //a new target every block keeps the filter recalculating its coefficients, the worst case
+            if (setting == 2)
+            {
+                eq.setFilter((float) std::sin(i * 0.01) * 0.9f);
+            }
+
+            const auto startTicks = Time::getHighResolutionTicks();
+            eq.process(buffer, 0, blockSize);
+            seconds += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+        }
+
+        const double cpuPerDeck = seconds / ((double) numBlocks * blockDuration);
+        std::cout << String(settings[setting]).paddedRight(' ', 23)
+                  << String(seconds * 1.0e6 / numBlocks, 2).paddedRight(' ', 11)
+                  << (String(cpuPerDeck * 100.0, 3) + "%").paddedRight(' ', 15)
+                  << String(cpuPerDeck * numDecks * 100.0, 2) << "%" << std::endl;
+    }
+}
+
+void PerformanceBenchmarks::trackAnalysis()
+{
+    //what the analyser is left with after decoding: a minute of mono at about 22kHz
+    const double sampleRate = 22050.0;
+    const double bpm = 126.0;
+    const int numRuns = 5;
+    const int crateSize = 10000;
+
+    //a kick on every beat over an A minor chord
+    AudioBuffer<float> mono(1, (int) (sampleRate * 60.0));
+    Random random{42};
+    for (int i = 0; i < mono.getNumSamples(); ++i)
+    {
+        const double t = i / sampleRate;
+        const double sinceBeat = std::fmod(t, 60.0 / bpm);
+        double sample = 0.6 * std::exp(-sinceBeat * 30.0) * std::sin(MathConstants<double>::twoPi * 55.0 * sinceBeat);
+        for (auto frequency : { 220.0, 261.63, 329.63 })
+        {
+            sample += 0.1 * std::sin(MathConstants<double>::twoPi * frequency * t);
+        }
+        mono.setSample(0, i, (float) sample + 0.02f * (random.nextFloat() - 0.5f));
+    }
+
+    TrackAnalyser::Result result;
+    const auto startTicks = Time::getHighResolutionTicks();
+    for (int run = 0; run < numRuns; ++run)
+    {
+        result = TrackAnalyser::analyseSamples(mono, sampleRate);
+    }
+    const auto seconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks) / numRuns;
+
+    std::cout << std::endl << "Track analysis: 60s of mono at " << sampleRate << "Hz, " << bpm << " BPM in A minor" << std::endl;
+    std::cout << "found " << String(result.beatgrid.bpm, 2) << " BPM, key " << result.key << std::endl;
+    std::cout << String(seconds * 1000.0, 1) << "ms per track on one core, "
+              << String(seconds * crateSize / SystemStats::getNumCpus() / 60.0, 1) << " minutes for "
+              << crateSize << " tracks on " << SystemStats::getNumCpus() << " cores, not counting decoding" << std::endl;
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    PerformanceBenchmarks.h
+    Created: 17 Oct 2026 4:05:12pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Benchmarks run from the command line instead of opening the window:
+
+        OtoDecks --benchmark              runs all of them
+        OtoDecks --benchmark timestretch  runs the ones named (timestretch, resampling, decks, eq, analysis)
+
+    Each one pushes synthetic audio through part of the deck chain as fast as it
+    can and prints the cost as a fraction of real time.
+*/
+class PerformanceBenchmarks
+{
+public:
+    /** true if the command line asks for benchmarks */
+    static bool isRequested(const String& commandLine);
+
+    /** runs the benchmarks named on the command line (all of them if none are) */
+    static void run(const String& commandLine);
+
+    /** CPU per deck with key lock on, at a range of stretch ratios */
+    static void timeStretch();
+
+    /** throughput and aliasing of each VarispeedResampler quality against ResamplingAudioSource */
+    static void resampling();
+
+    /** DeckEngine with eight key-locked decks, from the audio thread alone up to every core, then
+        called at a device's pace to show how much of each worker's core goes on waiting */
+    static void deckScaling();
+
+    /** DeckEQ per deck: flat, with kills, and with the filter sweeping, against an eight-deck block budget */
+    static void deckEq();
+
+    /** TrackAnalyser's tempo and key analysis per track, and what that means for a 10k-track crate */
+    static void trackAnalysis();
+};
@@ -13,14 +13,20 @@
 
 
 //==============================================================================
-PlaylistComponent::PlaylistComponent(AudioFormatManager& _formatManager)
-                  : formatManager(_formatManager)
+PlaylistComponent::PlaylistComponent(AudioFormatManager& _formatManager,
+                                     DecodedTrackCache& _decodedTrackCache,
+                                     TrackAnalyser& _trackAnalyser)
+                  : formatManager(_formatManager),
+                    decodedTrackCache(_decodedTrackCache),
+                    trackAnalyser(_trackAnalyser)
 {
     // In your constructor, you should add any child components, and
 
     //set up playlist library
     tableComponent.getHeader().addColumn("Track Title", 1, 250);
     tableComponent.getHeader().addColumn("Duration", 2, 100);
+    tableComponent.getHeader().addColumn("BPM", 6, 60);
+    tableComponent.getHeader().addColumn("Key", 7, 50);
     tableComponent.getHeader().addColumn("Add file to Left Channel", 3, 250);
     tableComponent.getHeader().addColumn("Add file to Right channel", 4, 250);
     tableComponent.getHeader().addColumn("Delete file", 5, 100);
@@ -31,6 +37,10 @@ PlaylistComponent::PlaylistComponent(AudioFormatManager& _formatManager)
     addAndMakeVisible(saveLibButton);
     saveLibButton.addListener(this);
 
+    //results from earlier sessions, then anything in the library they don't cover is queued
+    trackAnalyser.loadResults(getAnalysisFile());
+    trackAnalyser.addChangeListener(this);
+
     readingFile();
 
     //add search bar and listener
@@ -45,6 +55,7 @@ PlaylistComponent::PlaylistComponent(AudioFormatManager& _formatManager)
 
 PlaylistComponent::~PlaylistComponent()
 {
+    trackAnalyser.removeChangeListener(this);
 }
 
 void PlaylistComponent::paint (juce::Graphics& g)
@@ -124,6 +135,29 @@ void PlaylistComponent::paintCell (Graphics & g,
             Justification::centredLeft,
             true);       
     }
+    //Draw the analysed tempo and key, or dots while the track is still being analysed
+    if ((columnId == 6 || columnId == 7) && rowNumber < (int) interestedFiles.size())
+    {
+        TrackAnalyser::Result result;
+        String text = "...";
+        if (trackAnalyser.getResult(File{ interestedFiles[rowNumber] }, result))
+        {
+            if (columnId == 6)
+            {
+                text = result.beatgrid.isValid() ? String(result.beatgrid.bpm, 1) : "-";
+            }
+            else
+            {
+                text = result.key.isEmpty() ? "-" : result.key;
+            }
+        }
+
+        g.drawText (text,
+            1, rowNumber,
+            width - 4, height,
+            Justification::centredLeft,
+            true);
+    }
 }
 
 //==============================================================================
@@ -250,10 +284,14 @@ void PlaylistComponent::filesDropped(const StringArray& files, int x, int y)
         //update vectors for file details
         inputFiles.push_back(filepath);
         trackTitles.push_back(file);
+        path.push_back(URL{ File{filepath} });
 
         //compute adudio length of the file and update vectors for file details 
         getAudioLength(URL{ File{filepath} });
 
+        //tempo and key are worked out in the background, the table fills them in as they arrive
+        trackAnalyser.analyse(File{filepath});
+
     }
     //Initialise interested titles as the full list. 
     //This will be updated when text is entered in the search bar
@@ -294,6 +332,18 @@ void PlaylistComponent::textEditorTextChanged(TextEditor& textEditor)
 }
 
 
+//==============================================================================
+void PlaylistComponent::changeListenerCallback(ChangeBroadcaster* source)
+{
+    tableComponent.repaint();
+
+    //keep the results once a batch is done, so a crate is only ever analysed once
+    if (trackAnalyser.getNumPending() == 0)
+    {
+        trackAnalyser.saveResults(getAnalysisFile());
+    }
+}
+
 //==============================================================================
 // Add music file to list of the respective Left/Right channel's playlist
 void PlaylistComponent::addToChannelList(std::string filepath, int channel)
@@ -339,7 +389,9 @@ void PlaylistComponent::deleteTrack(int id)
     interestedFiles.erase(interestedFiles.begin() + id);
     interestedDuration.erase(interestedDuration.begin() + id);
 
-    trackDurations.erase(trackDurations.begin() + id);
+    //the full lists are erased at the track's own position, not at its row in the filtered table
+    trackDurations.erase(trackDurations.begin() + fileID);
+    path.erase(path.begin() + fileID);
 
     AlertWindow::showMessageBox(juce::AlertWindow::AlertIconType::InfoIcon,
             "Information:",
@@ -353,17 +405,11 @@ void PlaylistComponent::deleteTrack(int id)
 // get audio length metadata
 void PlaylistComponent::getAudioLength(URL audioURL)
 {
-    double trackLen = 0.0;
+    //the cache knows the length of anything it has decoded, otherwise only the file header is read
+    double trackLen = decodedTrackCache.getLengthInSeconds(audioURL.getLocalFile());
 
-    auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
-
-    if (reader != nullptr) // good file!
+    if (trackLen > 0.0) // good file!
     {
-        std::unique_ptr<AudioFormatReaderSource> newSource(new AudioFormatReaderSource(reader,
-            true));
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset(newSource.release());
-        double trackLen = transportSource.getLengthInSeconds(); // get length of audio
         std::string trackLength = std::to_string(trackLen);
         trackDurations.push_back(trackLength); // add audio length to vector
     }
@@ -410,6 +456,8 @@ void PlaylistComponent::writingIntoFile()
         }
     }
     _file.flush(); 
+
+    trackAnalyser.saveResults(getAnalysisFile());
 }
 
 //reading in name, duration and path from txt file and then pushing it back to the vectors
@@ -436,6 +484,24 @@ void PlaylistComponent::readingFile()
                 singleLine = _file.readNextLine();
                 DBG(singleLine);
                 path.push_back(singleLine);  
+
+                //the table and the analysis columns look tracks up by their local path
+                inputFiles.push_back(path.back().getLocalFile().getFullPathName().toStdString());
+
+                if (path.back().isLocalFile())
+                {
+                    trackAnalyser.analyse(path.back().getLocalFile());
+                }
           }
     }
+
+    //Initialise the interested lists as the full list, the same as when files are dropped
+    interestedTitles = trackTitles;
+    interestedDuration = trackDurations;
+    interestedFiles = inputFiles;
+}
+
+File PlaylistComponent::getAnalysisFile()
+{
+    return File::getCurrentWorkingDirectory().getChildFile("trackAnalysis.txt");
 }
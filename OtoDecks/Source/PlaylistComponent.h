@@ -12,8 +12,11 @@
 
 #include <JuceHeader.h>
 #include <vector>
+#include <deque>
 #include <string>
 #include <fstream>
+#include "DecodedTrackCache.h"
+#include "TrackAnalyser.h"
 
 
 //==============================================================================
@@ -24,10 +27,13 @@ class PlaylistComponent  : public juce::Component,
                            public AudioSource,
                            public Button::Listener,
                            public FileDragAndDropTarget,
-                           public TextEditor::Listener
+                           public TextEditor::Listener,
+                           public ChangeListener
 {
 public:
-    PlaylistComponent(AudioFormatManager& formatManager);
+    PlaylistComponent(AudioFormatManager& formatManager,
+                      DecodedTrackCache& decodedTrackCache,
+                      TrackAnalyser& trackAnalyser);
     ~PlaylistComponent() override;
 
     //customisation for input graphics
@@ -79,20 +85,23 @@ public:
     /**Override of TextEditor::Listener function to be called whenever the user changes 
     the text in the object in some way*/
     void textEditorTextChanged(TextEditor&) override;
+    /**Override of ChangeListener, called when the analyser has new BPM and key results
+    to show in the table*/
+    void changeListenerCallback(ChangeBroadcaster* source) override;
 
 
-    /**Vector of songs to be added to the Left Channel Player, utilised by DeckGUI*/
-    std::vector<std::string> playListLeft;
-    /**Vector of songs to be added to the Right Channel Player, utilised by DeckGUI*/
-    std::vector<std::string> playListRight;
+    /**Queue of songs to be added to the Left Channel Player, utilised by DeckGUI*/
+    std::deque<std::string> playListLeft;
+    /**Queue of songs to be added to the Right Channel Player, utilised by DeckGUI*/
+    std::deque<std::string> playListRight;
   
 
 
 private:
 
     AudioFormatManager& formatManager;
-    AudioTransportSource transportSource;
-    std::unique_ptr<AudioFormatReaderSource> readerSource;
+    DecodedTrackCache& decodedTrackCache;
+    TrackAnalyser& trackAnalyser;
 
     //playlist displayed as a table list
     TableListBox tableComponent;
@@ -120,5 +129,8 @@ private:
     void writingIntoFile();
     void readingFile();
 
+    //BPM and key results are kept next to songData.txt
+    File getAnalysisFile();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlaylistComponent)
 };
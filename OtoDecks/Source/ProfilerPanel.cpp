@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    ProfilerPanel.cpp
+    Created: 18 Oct 2026 2:24:38am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ProfilerPanel.h"
+
+//==============================================================================
+ProfilerPanel::ProfilerPanel(AudioDeviceManager& _deviceManager)
+              : deviceManager(_deviceManager)
+{
+    addAndMakeVisible(resetButton);
+    addAndMakeVisible(dumpButton);
+    resetButton.addListener(this);
+    dumpButton.addListener(this);
+
+    statusLabel.setColour(juce::Label::textColourId, juce::Colours::whitesmoke);
+    addAndMakeVisible(statusLabel);
+
+    //a fixed-width font keeps the table's columns lined up
+    reportText.setMultiLine(true);
+    reportText.setReadOnly(true);
+    reportText.setCaretVisible(false);
+    reportText.setFont(Font(Font::getDefaultMonospacedFontName(), 13.0f, Font::plain));
+    addAndMakeVisible(reportText);
+}
+
+ProfilerPanel::~ProfilerPanel()
+{
+    stopTimer();
+    CallbackProfiler::getInstance().setEnabled(false);
+}
+
+void ProfilerPanel::paint (Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(ResizableWindow::backgroundColourId));
+    g.setColour(juce::Colours::lightslategrey);
+    g.drawRect(getLocalBounds(), 1);
+}
+
+void ProfilerPanel::resized()
+{
+    resetButton.setBounds(4, 4, 80, 24);
+    dumpButton.setBounds(88, 4, 80, 24);
+    statusLabel.setBounds(172, 4, getWidth() - 176, 24);
+    reportText.setBounds(4, 32, getWidth() - 8, getHeight() - 36);
+}
+
+void ProfilerPanel::visibilityChanged()
+{
+    CallbackProfiler::getInstance().setEnabled(isVisible());
+
+    if (isVisible())
+    {
+        timerCallback();
+        startTimer(250);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void ProfilerPanel::buttonClicked (Button* button)
+{
+    if (button == &resetButton)
+    {
+        CallbackProfiler::getInstance().reset();
+        statusLabel.setText({}, juce::dontSendNotification);
+        timerCallback();
+    }
+
+    if (button == &dumpButton)
+    {
+        const auto file = File::getSpecialLocation(File::userDocumentsDirectory)
+                              .getChildFile("OtoDecks profile " + Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + ".txt");
+
+        const bool written = CallbackProfiler::getInstance().writeReport(file, getDeviceXRuns());
+        statusLabel.setText(written ? "Saved to " + file.getFullPathName() : "Could not write " + file.getFullPathName(),
+                            juce::dontSendNotification);
+    }
+}
+
+void ProfilerPanel::timerCallback()
+{
+    reportText.setText(CallbackProfiler::getInstance().createReport(getDeviceXRuns()), false);
+}
+
+int ProfilerPanel::getDeviceXRuns()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    return device != nullptr ? device->getXRunCount() : -1;
+}
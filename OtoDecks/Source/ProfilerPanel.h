@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    ProfilerPanel.h
+    Created: 18 Oct 2026 2:24:38am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CallbackProfiler.h"
+
+//==============================================================================
+/*
+    Shows the CallbackProfiler's stats, refreshed a few times a second.
+    Profiling runs only while the panel is visible, so a hidden panel costs
+    the audio thread nothing but a flag check per stage.
+*/
+class ProfilerPanel : public Component,
+                      public Button::Listener,
+                      public Timer
+{
+public:
+    ProfilerPanel(AudioDeviceManager& _deviceManager);
+    ~ProfilerPanel();
+
+    void paint (Graphics& g) override;
+    void resized() override;
+
+    /** turns profiling on while the panel is showing */
+    void visibilityChanged() override;
+
+    /** implement Button::Listener, for RESET and DUMP */
+    void buttonClicked (Button* button) override;
+
+    /** implement Timer, refreshes the report */
+    void timerCallback() override;
+
+private:
+    /** what the device reports as xruns, or -1 if it can't tell */
+    int getDeviceXRuns();
+
+    AudioDeviceManager& deviceManager;
+
+    TextButton resetButton{"RESET"};
+    TextButton dumpButton{"DUMP"};
+    Label statusLabel;
+    TextEditor reportText;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProfilerPanel)
+};
@@ -0,0 +1,318 @@
+/*
+  ==============================================================================
+
+    ReadAheadPool.cpp
+    Created: 17 Oct 2026 9:12:40am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ReadAheadPool.h"
+
+//==============================================================================
+ReadAheadPool::ReadAheadPool(int numThreads, int _defaultBufferSize)
+             : defaultBufferSize(_defaultBufferSize)
+{
+    //always keep at least one worker so decks never fall back to decoding on the audio thread
+    for (int i = 0; i < jmax(1, numThreads); ++i)
+    {
+        auto* thread = threads.add(new TimeSliceThread("Read-ahead " + String(i + 1)));
+        thread->startThread(8);
+    }
+}
+
+ReadAheadPool::~ReadAheadPool()
+{
+    for (auto* thread : threads)
+    {
+        thread->stopThread(2000);
+    }
+}
+
+TimeSliceThread& ReadAheadPool::getNextThread()
+{
+    //unsigned, so the count wraps round to 0 rather than going negative
+    return *threads[(int) (nextThread++ % (uint32) threads.size())];
+}
+
+int ReadAheadPool::getNumThreads() const
+{
+    return threads.size();
+}
+
+int ReadAheadPool::getDefaultBufferSize() const
+{
+    return defaultBufferSize;
+}
+
+void ReadAheadPool::setDefaultBufferSize(int numSamples)
+{
+    defaultBufferSize = jmax(1024, numSamples);
+}
+
+//==============================================================================
+ReadAheadSource::ReadAheadSource(PositionableAudioSource* _source,
+                                 ReadAheadPool& pool,
+                                 int bufferSizeSamples,
+                                 int numChannels)
+               : source(_source),
+                 thread(pool.getNextThread()),
+                 numberOfSamplesToBuffer(jmax(1024, bufferSizeSamples)),
+                 numberOfChannels(numChannels)
+{
+    jassert(source != nullptr);
+}
+
+ReadAheadSource::~ReadAheadSource()
+{
+    //blocks until the worker has left useTimeSlice, so the ring can't be written after this
+    releaseResources();
+}
+
+void ReadAheadSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    thread.removeTimeSliceClient(this);
+
+    auto bufferSizeNeeded = jmax(samplesPerBlockExpected * 2, numberOfSamplesToBuffer);
+    buffer.setSize(numberOfChannels, bufferSizeNeeded);
+    buffer.clear();
+
+    source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+
+    {
+        const SpinLock::ScopedLockType sl(rangeLock);
+        bufferValidStart = 0;
+        bufferValidEnd = 0;
+    }
+
+    //prime the head of the ring before the worker takes over, so playback starts without an underrun
+    while (readNextChunk() && bufferValidEnd - nextPlayPos < jmin((int64) bufferSizeNeeded / 2, getTotalLength()))
+    {
+    }
+
+    thread.addTimeSliceClient(this);
+    isPrepared = true;
+}
+
+void ReadAheadSource::releaseResources()
+{
+    thread.removeTimeSliceClient(this);
+
+    if (isPrepared)
+    {
+        buffer.setSize(numberOfChannels, 0);
+        source->releaseResources();
+        isPrepared = false;
+    }
+}
+
+void ReadAheadSource::getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill)
+{
+    auto playPos = nextPlayPos.load();
+    auto numSamples = bufferToFill.numSamples;
+
+    int validStart, validEnd;
+    {
+        const SpinLock::ScopedLockType sl(rangeLock);
+        validStart = (int) (jlimit(bufferValidStart, bufferValidEnd, playPos) - playPos);
+        validEnd = (int) (jlimit(bufferValidStart, bufferValidEnd, playPos + numSamples) - playPos);
+    }
+
+    if (validStart > 0)
+    {
+        bufferToFill.buffer->clear(bufferToFill.startSample, validStart);
+    }
+    if (validEnd < numSamples)
+    {
+        bufferToFill.buffer->clear(bufferToFill.startSample + jmax(0, validEnd), numSamples - jmax(0, validEnd));
+    }
+
+    if (validStart < validEnd)
+    {
+        auto ringSize = buffer.getNumSamples();
+        auto startIndex = (int) ((playPos + validStart) % ringSize);
+        auto endIndex = (int) ((playPos + validEnd) % ringSize);
+
+        for (int chan = 0; chan < jmin(numberOfChannels, bufferToFill.buffer->getNumChannels()); ++chan)
+        {
+            if (startIndex < endIndex)
+            {
+                bufferToFill.buffer->copyFrom(chan, bufferToFill.startSample + validStart,
+                                              buffer, chan, startIndex, validEnd - validStart);
+            }
+            else
+            {
+                auto initialSize = ringSize - startIndex;
+                bufferToFill.buffer->copyFrom(chan, bufferToFill.startSample + validStart,
+                                              buffer, chan, startIndex, initialSize);
+                bufferToFill.buffer->copyFrom(chan, bufferToFill.startSample + validStart + initialSize,
+                                              buffer, chan, 0, (validEnd - validStart) - initialSize);
+            }
+        }
+    }
+
+    //only samples that exist in the track count as missing; running off the end is not an underrun
+    auto wanted = (int) jlimit((int64) 0, (int64) numSamples, getTotalLength() - playPos);
+    if (wanted > 0)
+    {
+        ++blocksPlayed;
+
+        auto missing = wanted - jmax(0, validEnd - validStart);
+        if (missing > 0)
+        {
+            ++underrunBlocks;
+            underrunSamples += missing;
+        }
+
+        int bufferedAhead;
+        {
+            const SpinLock::ScopedLockType sl(rangeLock);
+            bufferedAhead = (int) jmax((int64) 0, bufferValidEnd - playPos);
+        }
+        if (bufferedAhead < lowestBufferedSamples.load(std::memory_order_relaxed))
+        {
+            lowestBufferedSamples.store(bufferedAhead, std::memory_order_relaxed);
+        }
+    }
+
+    //don't clobber a seek that arrived from another thread while we were copying
+    nextPlayPos.compare_exchange_strong(playPos, playPos + numSamples);
+}
+
+void ReadAheadSource::setNextReadPosition(int64 newPosition)
+{
+    //called from the audio thread on every cue and loop jump, so the pool isn't woken here:
+    //it polls, and readNextChunk() sees the jump from nextPlayPos
+    nextPlayPos = newPosition;
+}
+
+int64 ReadAheadSource::getNextReadPosition() const
+{
+    return nextPlayPos;
+}
+
+int64 ReadAheadSource::getTotalLength() const
+{
+    return source->getTotalLength();
+}
+
+bool ReadAheadSource::isLooping() const
+{
+    //decks never loop the whole file, so the ring doesn't need to wrap around the track end
+    return false;
+}
+
+ReadAheadSource::Stats ReadAheadSource::getStats() const
+{
+    Stats stats;
+    stats.blocksPlayed = blocksPlayed;
+    stats.underrunBlocks = underrunBlocks;
+    stats.underrunSamples = underrunSamples;
+
+    auto lowest = lowestBufferedSamples.load();
+    stats.lowestBufferedSamples = lowest == std::numeric_limits<int>::max() ? 0 : lowest;
+    return stats;
+}
+
+void ReadAheadSource::resetStats()
+{
+    blocksPlayed = 0;
+    underrunBlocks = 0;
+    underrunSamples = 0;
+    lowestBufferedSamples = std::numeric_limits<int>::max();
+}
+
+//==============================================================================
+// how long a source with a full ring waits before looking at the playhead again
+static const int fullRingPollMs = 4;
+
+int ReadAheadSource::useTimeSlice()
+{
+    //come straight back while there's more to fill. With the ring full, check again soon: nothing
+    //wakes the pool when the playhead moves on or jumps, and a few ms is well inside the read-ahead
+    return readNextChunk() ? 1 : fullRingPollMs;
+}
+
+bool ReadAheadSource::readNextChunk()
+{
+    const int maxChunkSize = 2048;
+    auto ringSize = buffer.getNumSamples();
+
+    if (ringSize == 0)
+    {
+        return false;
+    }
+
+    int64 newValidStart, newValidEnd, sectionStart, sectionEnd;
+    {
+        const SpinLock::ScopedLockType sl(rangeLock);
+
+        newValidStart = jmax((int64) 0, nextPlayPos.load());
+        newValidEnd = jmin(newValidStart + ringSize - 4, getTotalLength());
+        sectionStart = 0;
+        sectionEnd = 0;
+
+        if (newValidStart < bufferValidStart || newValidStart >= bufferValidEnd)
+        {
+            //the playhead jumped outside what we hold: start again from the new position
+            newValidEnd = jmin(newValidEnd, newValidStart + maxChunkSize);
+            sectionStart = newValidStart;
+            sectionEnd = newValidEnd;
+            bufferValidStart = 0;
+            bufferValidEnd = 0;
+        }
+        else if (newValidStart - bufferValidStart > 512 || newValidEnd - bufferValidEnd > 512)
+        {
+            newValidEnd = jmin(newValidEnd, bufferValidEnd + maxChunkSize);
+            sectionStart = bufferValidEnd;
+            sectionEnd = newValidEnd;
+            bufferValidStart = newValidStart;
+            bufferValidEnd = jmin(bufferValidEnd, newValidEnd);
+        }
+    }
+
+    if (sectionStart >= sectionEnd)
+    {
+        return false;
+    }
+
+    auto indexStart = (int) (sectionStart % ringSize);
+    auto indexEnd = (int) (sectionEnd % ringSize);
+
+    if (indexStart < indexEnd)
+    {
+        readSection(sectionStart, (int) (sectionEnd - sectionStart), indexStart);
+    }
+    else
+    {
+        auto initialSize = ringSize - indexStart;
+        readSection(sectionStart, initialSize, indexStart);
+        readSection(sectionStart + initialSize, (int) (sectionEnd - sectionStart) - initialSize, 0);
+    }
+
+    {
+        const SpinLock::ScopedLockType sl(rangeLock);
+        bufferValidStart = newValidStart;
+        bufferValidEnd = newValidEnd;
+    }
+
+    return true;
+}
+
+void ReadAheadSource::readSection(int64 start, int length, int bufferOffset)
+{
+    if (length <= 0)
+    {
+        return;
+    }
+
+    if (source->getNextReadPosition() != start)
+    {
+        source->setNextReadPosition(start);
+    }
+
+    AudioSourceChannelInfo info(&buffer, bufferOffset, length);
+    source->getNextAudioBlock(info);
+}
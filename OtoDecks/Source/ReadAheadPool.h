@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    ReadAheadPool.h
+    Created: 17 Oct 2026 9:12:40am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Shared pool of background read-ahead threads. Every deck hands its track's
+    reader to one of these workers, so disk reads and MP3 decoding happen here
+    instead of inside the audio callback.
+*/
+class ReadAheadPool
+{
+public:
+    ReadAheadPool(int numThreads = 1, int defaultBufferSize = 32768);
+    ~ReadAheadPool();
+
+    /** returns the worker the next track should be buffered on (round robin) */
+    TimeSliceThread& getNextThread();
+
+    int getNumThreads() const;
+
+    /** default number of samples a deck buffers ahead of the playhead */
+    int getDefaultBufferSize() const;
+    void setDefaultBufferSize(int numSamples);
+
+private:
+    OwnedArray<TimeSliceThread> threads;
+    std::atomic<uint32> nextThread{0};
+    std::atomic<int> defaultBufferSize;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadAheadPool)
+};
+
+//==============================================================================
+/*
+    Ring buffer filled ahead of the playhead by a ReadAheadPool worker.
+    The audio thread only copies out of the ring and moves the playhead, without
+    waking the worker, which polls; any block the worker has not filled in time
+    is played as silence and counted as an underrun.
+*/
+class ReadAheadSource : public PositionableAudioSource,
+                        private TimeSliceClient
+{
+public:
+    /** counters the deck reads to size its buffer from real numbers */
+    struct Stats
+    {
+        int blocksPlayed = 0;
+        int underrunBlocks = 0;
+        int64 underrunSamples = 0;
+        /** smallest number of samples that were buffered ahead of a block */
+        int lowestBufferedSamples = 0;
+    };
+
+    /** takes ownership of source */
+    ReadAheadSource(PositionableAudioSource* source,
+                    ReadAheadPool& pool,
+                    int bufferSizeSamples,
+                    int numChannels = 2);
+    ~ReadAheadSource() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+    void getNextAudioBlock(const AudioSourceChannelInfo& bufferToFill) override;
+
+    void setNextReadPosition(int64 newPosition) override;
+    int64 getNextReadPosition() const override;
+    int64 getTotalLength() const override;
+    bool isLooping() const override;
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    int useTimeSlice() override;
+
+    /** tops up the ring behind the playhead, returns false when nothing needed reading */
+    bool readNextChunk();
+    void readSection(int64 start, int length, int bufferOffset);
+
+    std::unique_ptr<PositionableAudioSource> source;
+    TimeSliceThread& thread;
+
+    int numberOfSamplesToBuffer;
+    int numberOfChannels;
+    AudioBuffer<float> buffer;
+
+    // guards the valid range only; the worker never holds it while decoding
+    SpinLock rangeLock;
+    int64 bufferValidStart = 0;
+    int64 bufferValidEnd = 0;
+
+    std::atomic<int64> nextPlayPos{0};
+    bool isPrepared = false;
+
+    std::atomic<int> blocksPlayed{0};
+    std::atomic<int> underrunBlocks{0};
+    std::atomic<int64> underrunSamples{0};
+    std::atomic<int> lowestBufferedSamples{std::numeric_limits<int>::max()};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReadAheadSource)
+};
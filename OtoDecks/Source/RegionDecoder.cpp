@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    RegionDecoder.cpp
+    Created: 18 Oct 2026 9:05:31am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RegionDecoder.h"
+
+//==============================================================================
+RegionDecoder::RegionDecoder(AudioFormatManager& _formatManager)
+             : Thread("Region decoder"),
+               formatManager(_formatManager)
+{
+    startThread();
+}
+
+RegionDecoder::~RegionDecoder()
+{
+    //wake the decoder so it sees the exit flag instead of waiting for the next request
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+}
+
+uint32 RegionDecoder::decode(int slot, const URL& url, DecodedTrack::Ptr decodedTrack, int64 start, int64 numSamples,
+                             bool makeScratchWindow)
+{
+    Request request;
+    request.slot = slot;
+    request.id = nextId++;
+    request.url = url;
+    request.decodedTrack = decodedTrack;
+    request.start = start;
+    request.numSamples = numSamples;
+    request.makeScratchWindow = makeScratchWindow;
+
+    if (offline)
+    {
+        process(request);
+        return request.id;
+    }
+
+    {
+        const ScopedLock sl(lock);
+
+        //a slot only ever needs its newest region
+        requests.erase(std::remove_if(requests.begin(), requests.end(),
+                                      [slot] (const Request& r) { return r.slot == slot; }),
+                       requests.end());
+        requests.push_back(request);
+    }
+    notify();
+    return request.id;
+}
+
+void RegionDecoder::cancelAll()
+{
+    //freed outside the lock, so the decoder thread isn't kept waiting
+    std::vector<Request> staleRequests;
+    std::vector<Result> staleResults;
+    {
+        const ScopedLock sl(lock);
+        staleRequests.swap(requests);
+        staleResults.swap(results);
+    }
+}
+
+bool RegionDecoder::takeDecodedRegion(Result& result)
+{
+    const ScopedLock sl(lock);
+    if (results.empty())
+    {
+        return false;
+    }
+
+    result = std::move(results.front());
+    results.erase(results.begin());
+    return true;
+}
+
+void RegionDecoder::setOffline(bool shouldBeOffline)
+{
+    offline = shouldBeOffline;
+}
+
+bool RegionDecoder::isOffline() const
+{
+    return offline;
+}
+
+std::unique_ptr<CueSource::Region> RegionDecoder::decodeRegion(AudioFormatManager& formatManager, const URL& url,
+                                                               DecodedTrack* decodedTrack, int64 start, int64 numSamples)
+{
+    if (numSamples <= 0)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<CueSource::Region> region (new CueSource::Region());
+    region->start = start;
+    region->samples.setSize(2, (int) numSamples);
+
+    if (decodedTrack != nullptr)
+    {
+        decodedTrack->read(region->samples, 0, start, (int) numSamples);
+        return region;
+    }
+
+    //a reader of our own, so the one the deck plays from never seeks; this is the only decoder seek a cue costs
+    std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor(url.createInputStream(false)));
+    if (reader == nullptr)
+    {
+        std::cout << "RegionDecoder::decodeRegion could not open " << url.toString(false) << std::endl;
+        return nullptr;
+    }
+
+    reader->read(&region->samples, 0, (int) numSamples, start, true, true);
+    return region;
+}
+
+void RegionDecoder::run()
+{
+    while (! threadShouldExit())
+    {
+        Request request;
+        bool hasRequest = false;
+        {
+            const ScopedLock sl(lock);
+            if (! requests.empty())
+            {
+                request = requests.front();
+                requests.erase(requests.begin());
+                hasRequest = true;
+            }
+        }
+
+        if (! hasRequest)
+        {
+            wait(-1);
+            continue;
+        }
+
+        process(request);
+        sendChangeMessage();
+    }
+}
+
+void RegionDecoder::process(const Request& request)
+{
+    Result result;
+    result.slot = request.slot;
+    result.id = request.id;
+    result.region = decodeRegion(formatManager, request.url, request.decodedTrack.get(), request.start, request.numSamples);
+    if (request.makeScratchWindow && result.region != nullptr)
+    {
+        result.window = Scratcher::makeWindow(result.region->samples, request.start, result.region->samples.getNumSamples());
+    }
+
+    const ScopedLock sl(lock);
+    results.push_back(std::move(result));
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    RegionDecoder.h
+    Created: 18 Oct 2026 9:05:31am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DecodedTrackCache.h"
+#include "CueSource.h"
+#include "Scratcher.h"
+
+//==============================================================================
+/*
+    Background decoder owned by a deck. Decodes the stretches of a track that
+    its hot cues, loop and scratches play from, so the message thread never
+    waits on the file. Each request is for a slot and gets an id; a newer request for the
+    same slot replaces one that hasn't started. Sends a change message when
+    regions are ready to collect with takeDecodedRegion().
+*/
+class RegionDecoder : public ChangeBroadcaster,
+                      private Thread
+{
+public:
+    struct Result
+    {
+        int slot = 0;
+        uint32 id = 0;
+        // nullptr if the track couldn't be read
+        std::unique_ptr<CueSource::Region> region;
+        // the same samples for a scratch, when asked for
+        std::unique_ptr<Scratcher::Window> window;
+    };
+
+    RegionDecoder(AudioFormatManager& _formatManager);
+    ~RegionDecoder() override;
+
+    /** queues numSamples of the track from start for slot, read from decodedTrack when it
+        has one or the file otherwise, and made into a scratch window as well if asked.
+        Returns the id its result will carry (message thread) */
+    uint32 decode(int slot, const URL& url, DecodedTrack::Ptr decodedTrack, int64 start, int64 numSamples,
+                  bool makeScratchWindow = false);
+    /** drops every request that hasn't started and every result not yet collected */
+    void cancelAll();
+
+    /** collects one finished region, false once there are none left (message thread) */
+    bool takeDecodedRegion(Result& result);
+
+    /** for rendering offline: regions are decoded before decode() returns */
+    void setOffline(bool shouldBeOffline);
+    bool isOffline() const;
+
+    /** decodes part of a track on the calling thread, with a reader of its own so the one
+        the deck plays from never seeks */
+    static std::unique_ptr<CueSource::Region> decodeRegion(AudioFormatManager& formatManager, const URL& url,
+                                                           DecodedTrack* decodedTrack, int64 start, int64 numSamples);
+
+private:
+    struct Request
+    {
+        int slot = 0;
+        uint32 id = 0;
+        URL url;
+        DecodedTrack::Ptr decodedTrack;
+        int64 start = 0;
+        int64 numSamples = 0;
+        bool makeScratchWindow = false;
+    };
+
+    void run() override;
+    /** decodes the request and leaves its result to be collected */
+    void process(const Request& request);
+
+    AudioFormatManager& formatManager;
+
+    std::atomic<bool> offline{false};
+    uint32 nextId = 1;
+
+    CriticalSection lock;
+    std::vector<Request> requests;
+    std::vector<Result> results;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RegionDecoder)
+};
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    SampleRateConverter.cpp
+    Created: 18 Oct 2026 6:12:47am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "SampleRateConverter.h"
+#include "VectorKernels.h"
+
+// taps either side of the centre when the rate goes up; going down stretches the filter by the ratio
+static const int zeroCrossings = 64;
+static const int maxHalfTaps = 1024;
+static const int numPhases = 512;
+// around 90dB of stopband rejection
+static const double kaiserBeta = 9.0;
+// the -6dB point as a fraction of the lower Nyquist, leaving the transition band just under it
+static const double cutoffFraction = 0.955;
+
+// zeroth order modified Bessel function, for the Kaiser window
+static double besselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64 && term > sum * 1.0e-12; ++k)
+    {
+        const double half = x / (2.0 * k);
+        term *= half * half;
+        sum += term;
+    }
+    return sum;
+}
+
+//==============================================================================
+AudioBuffer<float> SampleRateConverter::convert(const AudioBuffer<float>& source, double sourceRate, double targetRate)
+{
+    const int numChannels = source.getNumChannels();
+    const int numSourceSamples = source.getNumSamples();
+
+    AudioBuffer<float> result;
+    if (sourceRate <= 0 || targetRate <= 0 || sourceRate == targetRate || numSourceSamples == 0)
+    {
+        result.makeCopyOf(source);
+        return result;
+    }
+
+    //going down, the cutoff follows the new Nyquist and the filter gets longer to keep its steepness
+    const double scale = jmin(1.0, targetRate / sourceRate);
+    const int halfTaps = jmin(maxHalfTaps, (int) std::ceil(zeroCrossings / scale));
+    const int numTaps = halfTaps * 2;
+    const double cutoff = cutoffFraction * scale;
+
+    //a row of taps for every fractional position, as in the varispeed resampler but much longer
+    HeapBlock<float> table((size_t) (numPhases + 1) * (size_t) numTaps);
+    const double windowScale = 1.0 / besselI0(kaiserBeta);
+
+    for (int phase = 0; phase <= numPhases; ++phase)
+    {
+        float* row = table + phase * numTaps;
+        const double fraction = (double) phase / numPhases;
+        double sum = 0;
+
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            const double distance = (tap - (halfTaps - 1)) - fraction;
+            const double x = MathConstants<double>::pi * cutoff * distance;
+            const double sinc = x == 0 ? 1.0 : std::sin(x) / x;
+
+            const double across = distance / halfTaps;
+            const double window = std::abs(across) >= 1.0 ? 0.0
+                                : besselI0(kaiserBeta * std::sqrt(1.0 - across * across)) * windowScale;
+
+            row[tap] = (float) (sinc * window);
+            sum += row[tap];
+        }
+
+        //unity gain at DC whatever the cutoff
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            row[tap] = (float) (row[tap] / sum);
+        }
+    }
+
+    const double step = sourceRate / targetRate;
+    const auto numOutputSamples = (int) std::ceil(numSourceSamples / step);
+    result.setSize(numChannels, numOutputSamples);
+
+    //each channel is padded with silence so the taps never run off either end of the track
+    HeapBlock<float> padded((size_t) numSourceSamples + (size_t) numTaps + 1);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        FloatVectorOperations::clear(padded.get(), halfTaps);
+        FloatVectorOperations::copy(padded + halfTaps, source.getReadPointer(ch), numSourceSamples);
+        FloatVectorOperations::clear(padded + halfTaps + numSourceSamples, numTaps + 1 - halfTaps);
+
+        auto* out = result.getWritePointer(ch);
+        for (int j = 0; j < numOutputSamples; ++j)
+        {
+            //worked out from j each time, so the position never drifts over a long track
+            const double position = j * step;
+            const auto i = (int) position;
+            const double phase = (position - i) * numPhases;
+            const auto row = (int) phase;
+            const auto blend = (float) (phase - row);
+
+            //the taps start halfTaps - 1 before i, which is i + 1 in the padded copy
+            const float* samples = padded + i + 1;
+            const float a = VectorKernels::dotProduct(samples, table + row * numTaps, numTaps);
+            const float b = VectorKernels::dotProduct(samples, table + (row + 1) * numTaps, numTaps);
+            out[j] = a + blend * (b - a);
+        }
+    }
+    return result;
+}
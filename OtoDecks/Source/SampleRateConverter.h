@@ -0,0 +1,27 @@
+/*
+  ==============================================================================
+
+    SampleRateConverter.h
+    Created: 18 Oct 2026 6:12:47am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Offline sample rate conversion for whole tracks, run once as they are decoded
+    so the decks can play them at the device's rate without resampling. A long
+    Kaiser-windowed sinc with its cutoff under the lower of the two Nyquist
+    frequencies; far more taps than a real-time resampler could afford.
+*/
+class SampleRateConverter
+{
+public:
+    /** every channel of source converted from sourceRate to targetRate, or a copy when they're the same */
+    static AudioBuffer<float> convert(const AudioBuffer<float>& source, double sourceRate, double targetRate);
+};
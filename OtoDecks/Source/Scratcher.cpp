@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    Scratcher.cpp
+    Created: 18 Oct 2026 4:32:09am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Scratcher.h"
+
+// long enough to smooth out the steps between mouse or controller readings, short enough to feel direct
+static const double rampSeconds = 0.02;
+
+//==============================================================================
+std::unique_ptr<Scratcher::Window> Scratcher::makeWindow(const AudioBuffer<float>& samples, int64 start, int numSamples)
+{
+    std::unique_ptr<Window> window (new Window());
+    window->start = start;
+    window->numSamples = numSamples;
+    window->sums.setSize(2, numSamples + 1);
+
+    //a mono track is the same on both sides
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const auto* in = samples.getReadPointer(jmin(ch, samples.getNumChannels() - 1));
+        auto* sums = window->sums.getWritePointer(ch);
+
+        sums[0] = 0;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            sums[i + 1] = sums[i] + in[i];
+        }
+    }
+    return window;
+}
+
+Scratcher::Scratcher()
+{
+}
+
+Scratcher::~Scratcher()
+{
+    //the audio thread has let go by now, so the window is ours
+    delete window;
+}
+
+void Scratcher::prepare(double sampleRate)
+{
+    rate.reset(sampleRate, rampSeconds);
+}
+
+bool Scratcher::setWindow(std::unique_ptr<Window> newWindow)
+{
+    deleteRetiredWindows();
+
+    if (! pendingWindows.push(newWindow.get()))
+    {
+        std::cout << "Scratcher::setWindow the audio thread hasn't picked up the last window yet" << std::endl;
+        return false;
+    }
+
+    newWindow.release();
+    return true;
+}
+
+void Scratcher::deleteRetiredWindows()
+{
+    retiredWindows.deleteRetired();
+}
+
+void Scratcher::start(double _position, double _rate, int64 _length)
+{
+    length = _length;
+    position = jlimit(0.0, (double) length, _position);
+    rate.setCurrentAndTargetValue(_rate);
+    publishedPosition = position;
+}
+
+void Scratcher::setRate(double _rate)
+{
+    rate.setTargetValue(_rate);
+}
+
+double Scratcher::getPosition() const
+{
+    return publishedPosition;
+}
+
+void Scratcher::render(AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    takePendingWindow();
+
+    if (window == nullptr)
+    {
+        buffer.clear(startSample, numSamples);
+        return;
+    }
+
+    const double* sums[2] = { window->sums.getReadPointer(0), window->sums.getReadPointer(1) };
+    float* out[2] = { buffer.getWritePointer(0, startSample),
+                      buffer.getNumChannels() > 1 ? buffer.getWritePointer(1, startSample) : nullptr };
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const double step = rate.getNextValue();
+        const double next = jlimit(0.0, (double) length, position + step);
+        const double span = next - position;
+
+        //slow movements play the samples under the playhead, fast ones the average of everything they pass;
+        //between 1x and 2x it's a blend, so the change from one to the other can't be heard
+        const float blend = (float) jlimit(0.0, 1.0, std::abs(span) - 1.0);
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (out[ch] == nullptr)
+            {
+                continue;
+            }
+
+            float value = 0;
+            if (blend < 1.0f)
+            {
+                value = getSampleAt(sums[ch], position) * (1.0f - blend);
+            }
+            if (blend > 0.0f)
+            {
+                //centred on the playhead; each sample's stretch of the sums runs from its start to its start + 1
+                const double centre = position + 0.5;
+                const double average = (getSumAt(sums[ch], centre + span / 2) - getSumAt(sums[ch], centre - span / 2)) / span;
+                value += (float) average * blend;
+            }
+            out[ch][i] = value;
+        }
+
+        position = next;
+    }
+
+    publishedPosition = position;
+}
+
+//==============================================================================
+void Scratcher::takePendingWindow()
+{
+    pendingWindows.take([this] (Window* newWindow, int)
+    {
+        retiredWindows.retire(window);
+        window = newWindow;
+    });
+}
+
+double Scratcher::getSumAt(const double* sums, double pos) const
+{
+    const double local = jlimit(0.0, (double) window->numSamples, pos - window->start);
+    const int i = jmin((int) local, window->numSamples - 1);
+    return sums[i] + (local - i) * (sums[i + 1] - sums[i]);
+}
+
+float Scratcher::getSampleAt(const double* sums, double pos) const
+{
+    const double local = pos - window->start;
+    const int i = (int) std::floor(local);
+    const float t = (float) (local - i);
+
+    //the samples are the differences of the sums; outside the window they're silence
+    auto sample = [this, sums] (int index)
+    {
+        return isPositiveAndBelow(index, window->numSamples) ? (float) (sums[index + 1] - sums[index]) : 0.0f;
+    };
+    const float in0 = sample(i - 1), in1 = sample(i), in2 = sample(i + 1), in3 = sample(i + 2);
+
+    //4-point Hermite, as in VarispeedResampler
+    const float c1 = 0.5f * (in2 - in0);
+    const float c2 = in0 - 2.5f * in1 + 2.0f * in2 - 0.5f * in3;
+    const float c3 = 0.5f * (in3 - in0) + 1.5f * (in1 - in2);
+    return ((c3 * t + c2) * t + c1) * t + in1;
+}
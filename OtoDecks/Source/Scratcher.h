@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    Scratcher.h
+    Created: 18 Oct 2026 4:32:09am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "HandOverFifo.h"
+
+//==============================================================================
+/*
+    Plays a deck's track at any signed rate while it's being scratched or
+    jogged: forwards, backwards, held still and everything in between.
+
+    It never touches the deck's decoder. A background thread decodes a window
+    of the track around the playhead for the message thread to hand over, and
+    while the scratch nears the window's edge the next one is decoded the same
+    way and swapped in once it's ready. Windows are kept as
+    running sums of the samples. That way a fast movement is averaged over the
+    stretch of track it passes in each output sample, which stops it aliasing,
+    while slow ones are interpolated from the samples themselves.
+
+    The rate ramps to each new value sample by sample, so hand movements don't
+    click. Windows reach the audio thread through a HandOverFifo and leave it
+    through a RetireFifo.
+*/
+class Scratcher
+{
+public:
+    /** a stretch of the track, as running sums: sums[ch][i] is the total of the i samples from start */
+    struct Window
+    {
+        int64 start = 0;
+        int numSamples = 0;
+        AudioBuffer<double> sums;
+    };
+
+    /** the window for numSamples of the track's samples, which begin at start */
+    static std::unique_ptr<Window> makeWindow(const AudioBuffer<float>& samples, int64 start, int numSamples);
+
+    Scratcher();
+    ~Scratcher();
+
+    /** how long a change of rate takes to ramp in */
+    void prepare(double sampleRate);
+
+    /** hands a window to the audio thread, replacing the one it has. False if the
+        audio thread hasn't picked up the last one yet (message thread) */
+    bool setWindow(std::unique_ptr<Window> window);
+    /** deletes windows the audio thread has finished with (message thread) */
+    void deleteRetiredWindows();
+
+    /** starts playing from position in a track of length samples, at rate (audio thread) */
+    void start(double position, double rate, int64 length);
+    /** in the track's samples per output sample, negative plays backwards (audio thread) */
+    void setRate(double rate);
+    /** where playback has got to, in the track's samples (any thread) */
+    double getPosition() const;
+
+    /** plays into the first two channels of buffer; outside the window is silence (audio thread) */
+    void render(AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+private:
+    /** picks up a handed over window at the start of a block (audio thread) */
+    void takePendingWindow();
+    /** the sum of a channel's samples from the window's start up to position, the samples
+        between whole positions counting in proportion */
+    double getSumAt(const double* sums, double position) const;
+    /** a channel's sample at position, Hermite interpolated */
+    float getSampleAt(const double* sums, double position) const;
+
+    // owned by the audio thread
+    Window* window = nullptr;
+    double position = 0;
+    int64 length = 0;
+    SmoothedValue<double, ValueSmoothingTypes::Linear> rate{0.0};
+
+    std::atomic<double> publishedPosition{0};
+
+    HandOverFifo<Window, 4> pendingWindows;
+    RetireFifo<Window, 8> retiredWindows;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Scratcher)
+};
@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.cpp
+    Created: 18 Oct 2026 2:16:40pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "ScrollingWaveform.h"
+#include "CallbackProfiler.h"
+
+// a frame moves the shown playhead this much of the way to the audio thread's
+static const double catchUp = 0.15;
+// further out than this it's a seek or a cue, not jitter, and the view jumps there
+static const double jumpSeconds = 0.25;
+// the zoom's limits, in seconds across the view
+static const double minVisibleSeconds = 1.0;
+static const double maxVisibleSeconds = 64.0;
+
+//==============================================================================
+ScrollingWaveform::ScrollingWaveform(WaveformCache& _cache, DJAudioPlayer& _player)
+                 : cache(_cache),
+                   player(_player)
+{
+    cache.addChangeListener(this);
+
+    //the strip covers every pixel, so nothing behind needs painting each frame
+    setOpaque(true);
+    startTimerHz(60);
+}
+
+ScrollingWaveform::~ScrollingWaveform()
+{
+    stopTimer();
+    cache.removeChangeListener(this);
+}
+
+void ScrollingWaveform::paint (Graphics& g)
+{
+    //timed while the profiler is showing, alongside the overview's
+    CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::waveformPaint);
+
+    const float scale = Component::getApproximateScaleFactorForComponent(this);
+    if (pyramid != nullptr && ! stripCoversView(scale))
+    {
+        CallbackProfiler::ScopedStage stripStage(CallbackProfiler::Stage::waveformLayer);
+        renderStrip(scale);
+    }
+
+    if (pyramid != nullptr && stripValid)
+    {
+        //a whole number of physical pixels across, so the copy is a straight blit
+        drawnOffset = getStripOffset();
+        g.drawImage(strip, Rectangle<float>(drawnOffset / stripScale, 0.0f,
+                                            strip.getWidth() / stripScale, (float) getHeight()));
+    }
+    else
+    {
+        g.fillAll(getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    }
+
+    g.setColour(juce::Colours::grey);
+    g.drawRect(getLocalBounds(), 1);
+
+    //the playhead stays put and the track moves under it
+    g.setColour(juce::Colours::mediumspringgreen);
+    g.fillRect(getWidth() / 2 - 1, 0, 2, getHeight());
+}
+
+void ScrollingWaveform::resized()
+{
+    stripValid = false;
+    repaint();
+}
+
+void ScrollingWaveform::changeListenerCallback (ChangeBroadcaster* source)
+{
+    //a build finished, which may be ours
+    if (! url.isEmpty() && pyramid == nullptr)
+    {
+        pyramid = cache.getPyramid(url);
+        stripValid = false;
+        repaint();
+    }
+}
+
+void ScrollingWaveform::setVisibleSeconds(double seconds)
+{
+    visibleSeconds = jlimit(minVisibleSeconds, maxVisibleSeconds, seconds);
+    stripValid = false;
+    repaint();
+}
+
+double ScrollingWaveform::getVisibleSeconds() const
+{
+    return visibleSeconds;
+}
+
+void ScrollingWaveform::mouseWheelMove (const MouseEvent& event, const MouseWheelDetails& wheel)
+{
+    //up zooms in, as on the overview
+    setVisibleSeconds(visibleSeconds / std::pow(2.0, wheel.deltaY * 4.0));
+}
+
+//==============================================================================
+void ScrollingWaveform::timerCallback()
+{
+    //follow whatever the deck has loaded, including a track auto advance moved on to
+    const URL deckURL = player.getURL();
+    if (deckURL != url)
+    {
+        loadURL(deckURL);
+    }
+
+    DJAudioPlayer::PlayheadSnapshot snapshot;
+    if (pyramid == nullptr || ! isShowing() || ! player.getPlayheadSnapshot(snapshot))
+    {
+        return;
+    }
+
+    const double now = Time::getMillisecondCounterHiRes();
+    const double elapsed = jlimit(0.0, DJAudioPlayer::PlayheadSnapshot::maxExtrapolation, (now - lastFrameTime) / 1000.0);
+    lastFrameTime = now;
+
+    //carry on at the deck's rate, and take out a little of the difference every frame so block
+    //timing never shows as a stutter
+    const double target = snapshot.getSecondsAt(now);
+    const double predicted = shownSeconds + snapshot.rate * elapsed;
+    const double error = target - predicted;
+    shownSeconds = std::abs(error) > jumpSeconds ? target : predicted + error * catchUp;
+
+    if (! stripValid || getStripOffset() != drawnOffset)
+    {
+        repaint();
+    }
+}
+
+void ScrollingWaveform::loadURL(const URL& audioURL)
+{
+    url = audioURL;
+    pyramid = url.isEmpty() ? nullptr : cache.getPyramid(url);
+    shownSeconds = 0;
+    stripValid = false;
+    repaint();
+}
+
+void ScrollingWaveform::renderStrip(float scale)
+{
+    const int viewWidth = jmax(1, roundToInt(getWidth() * scale));
+    const int height = jmax(1, roundToInt(getHeight() * scale));
+    const int width = viewWidth * 3;
+
+    if (strip.getWidth() != width || strip.getHeight() != height)
+    {
+        strip = Image(Image::RGB, width, height, false);
+    }
+    stripValid = true;
+    stripScale = scale;
+    stripSecondsPerPixel = visibleSeconds / viewWidth;
+    stripStart = shownSeconds - visibleSeconds * 1.5;
+
+    Graphics g(strip);
+    g.fillAll(getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+
+    //one lookup per pixel whatever the zoom
+    peaks.resize((size_t) width);
+    const double sampleRate = pyramid->getSampleRate();
+    pyramid->getPeaks(stripStart * sampleRate, stripSecondsPerPixel * sampleRate, peaks.data(), width);
+
+    //coloured by band like the overview, so a kick looks the same in both
+    WaveformDisplay::drawPeaks(g, peaks.data(), width, (float) height);
+}
+
+bool ScrollingWaveform::stripCoversView(float scale) const
+{
+    if (! stripValid || scale != stripScale)
+    {
+        return false;
+    }
+    const double stripEnd = stripStart + strip.getWidth() * stripSecondsPerPixel;
+    return shownSeconds - visibleSeconds * 0.5 >= stripStart
+        && shownSeconds + visibleSeconds * 0.5 <= stripEnd;
+}
+
+int ScrollingWaveform::getStripOffset() const
+{
+    if (stripSecondsPerPixel <= 0)
+    {
+        return 0;
+    }
+    const double playheadX = getWidth() * stripScale * 0.5;
+    return roundToInt(playheadX - (shownSeconds - stripStart) / stripSecondsPerPixel);
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.h
+    Created: 18 Oct 2026 2:16:40pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveformCache.h"
+#include "WaveformDisplay.h"
+#include "DJAudioPlayer.h"
+
+//==============================================================================
+/*
+    The deck's "now playing" view: a few seconds of the track around a fixed
+    playhead in the middle, scrolling past at the display's rate.
+
+    The audio thread only says where the track was as of its last block and how
+    fast it was moving, so each frame carries the playhead on from there and
+    eases out the jitter in when blocks arrive. The waveform is drawn once into
+    a strip a few views wide and each frame only copies it across at a whole
+    pixel offset; the strip is drawn again when the view nears its edge.
+*/
+class ScrollingWaveform : public Component,
+                          public ChangeListener,
+                          private Timer
+{
+public:
+    /** shows whatever track player has loaded, from the waveforms in cache */
+    ScrollingWaveform(WaveformCache& _cache, DJAudioPlayer& _player);
+    ~ScrollingWaveform() override;
+
+    void paint (Graphics& g) override;
+    void resized() override;
+
+    /** implement ChangeListener, picks up the waveform once the cache has built it */
+    void changeListenerCallback (ChangeBroadcaster* source) override;
+
+    /** how much of the track the view covers, in seconds; 1 to 64 */
+    void setVisibleSeconds(double seconds);
+    double getVisibleSeconds() const;
+
+    /** the mouse wheel zooms in and out */
+    void mouseWheelMove (const MouseEvent& event, const MouseWheelDetails& wheel) override;
+
+private:
+    /** implement Timer, moves the playhead on a frame and repaints if it moved a pixel */
+    void timerCallback() override;
+
+    void loadURL(const URL& audioURL);
+
+    /** draws the waveform around the playhead into the strip, at the screen's resolution */
+    void renderStrip(float scale);
+    /** true if the strip is drawn at this scale and covers the whole view */
+    bool stripCoversView(float scale) const;
+    /** where the strip's left edge goes this frame, in physical pixels */
+    int getStripOffset() const;
+
+    WaveformCache& cache;
+    DJAudioPlayer& player;
+
+    URL url;
+    //nullptr until the cache has built it
+    WaveformPyramid::Ptr pyramid;
+    //one per pixel of the strip
+    std::vector<WaveformPyramid::Peak> peaks;
+
+    double visibleSeconds = 8.0;
+
+    //the playhead on screen, which follows the audio thread's smoothly rather than exactly
+    double shownSeconds = 0;
+    double lastFrameTime = 0;
+
+    //three views wide, the middle one centred on the playhead when it was drawn
+    Image strip;
+    bool stripValid = false;
+    float stripScale = 1.0f;
+    double stripStart = 0;
+    double stripSecondsPerPixel = 0;
+    //the offset the last paint used, to skip frames where nothing moved
+    int drawnOffset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScrollingWaveform)
+};
@@ -0,0 +1,302 @@
+/*
+  ==============================================================================
+
+    TimeStretcher.cpp
+    Created: 17 Oct 2026 3:22:47pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TimeStretcher.h"
+#include "VectorKernels.h"
+
+//==============================================================================
+TimeStretcher::TimeStretcher(AudioSource* _input, int _numChannels)
+              : input(_input),
+                numChannels(_numChannels)
+{
+}
+
+void TimeStretcher::setStretchRatio(double ratio)
+{
+    stretchRatio = jlimit(0.25, 4.0, ratio);
+}
+
+double TimeStretcher::getStretchRatio() const
+{
+    return stretchRatio;
+}
+
+void TimeStretcher::setKeyLock(bool shouldBeOn)
+{
+    keyLock = shouldBeOn;
+}
+
+bool TimeStretcher::isKeyLockOn() const
+{
+    return keyLock;
+}
+
+int TimeStretcher::getLatencySamples() const
+{
+    if (! keyLockActive || ! hasPreviousFrame)
+    {
+        return 0;
+    }
+
+    //the finished samples start where the newest frame starts, and some of them have gone already
+    const auto nextOut = previousFrameStart + (hopSize - outputReady);
+    return (int) jmax((int64) 0, inputStart + inputFill - nextOut);
+}
+
+void TimeStretcher::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    input->prepareToPlay(samplesPerBlockExpected, sampleRate);
+
+    //40ms frames and a 12ms search either way, multiples of 4 for the decimated search
+    blockSize = jmax(1, samplesPerBlockExpected);
+    frameSize = jmax(256, roundToInt(sampleRate * 0.040) & ~7);
+    hopSize = frameSize / 2;
+    searchRange = jmax(16, roundToInt(sampleRate * 0.012) & ~3);
+
+    //periodic Hann, which sums to exactly 1 at 50% overlap
+    window.allocate((size_t) frameSize, false);
+    for (int i = 0; i < frameSize; ++i)
+    {
+        window[i] = (float) (0.5 - 0.5 * std::cos(MathConstants<double>::twoPi * i / frameSize));
+    }
+
+    //enough for a frame, both search margins and the widest analysis hop, plus one pull from the input
+    const int inputCapacity = frameSize * 2 + searchRange * 2 + hopSize * 4 + blockSize;
+    inputBuffer.setSize(numChannels, inputCapacity);
+    outputBuffer.setSize(numChannels, frameSize);
+
+    monoScratch.allocate((size_t) inputCapacity, false);
+    coarseContinuation.allocate((size_t) inputCapacity / 4 + 1, false);
+    coarseCandidates.allocate((size_t) inputCapacity / 4 + 1, false);
+
+    keyLockActive = keyLock;
+    reset();
+}
+
+void TimeStretcher::releaseResources()
+{
+    input->releaseResources();
+}
+
+void TimeStretcher::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    const bool shouldBeOn = keyLock;
+    if (shouldBeOn != keyLockActive)
+    {
+        keyLockActive = shouldBeOn;
+        reset();
+    }
+
+    if (! keyLockActive)
+    {
+        input->getNextAudioBlock(bufferToFill);
+        return;
+    }
+
+    int numDone = 0;
+    while (numDone < bufferToFill.numSamples)
+    {
+        if (outputReady == 0)
+        {
+            synthesiseFrame();
+        }
+
+        const int numToCopy = jmin(outputReady, bufferToFill.numSamples - numDone);
+
+        for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+        {
+            auto* dest = bufferToFill.buffer->getWritePointer(ch, bufferToFill.startSample + numDone);
+            if (ch < numChannels)
+            {
+                FloatVectorOperations::copy(dest, outputBuffer.getReadPointer(ch), numToCopy);
+            }
+            else
+            {
+                FloatVectorOperations::clear(dest, numToCopy);
+            }
+        }
+
+        //slide the unfinished tail of the overlap-add to the front
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* accumulator = outputBuffer.getWritePointer(ch);
+            std::memmove(accumulator, accumulator + numToCopy, sizeof(float) * (size_t) (frameSize - numToCopy));
+            FloatVectorOperations::clear(accumulator + frameSize - numToCopy, numToCopy);
+        }
+
+        outputReady -= numToCopy;
+        numDone += numToCopy;
+    }
+}
+
+//==============================================================================
+void TimeStretcher::reset()
+{
+    inputBuffer.clear();
+    outputBuffer.clear();
+    inputStart = 0;
+    inputFill = 0;
+    outputReady = 0;
+    analysisPosition = 0;
+    previousFrameStart = 0;
+    hasPreviousFrame = false;
+}
+
+void TimeStretcher::synthesiseFrame()
+{
+    const auto target = (int64) analysisPosition;
+    auto frameStart = target;
+
+    if (hasPreviousFrame)
+    {
+        //the frame has to start near the target, at whichever offset best continues the last frame
+        const auto continuation = previousFrameStart + hopSize;
+        const auto lo = jmax(target - searchRange, inputStart);
+        const auto hi = jmax(lo, target + searchRange);
+
+        fillInput(jmin(lo, continuation), jmax(hi, continuation) + frameSize);
+        frameStart = findBestFrameStart(continuation, target, lo, hi);
+    }
+    else
+    {
+        fillInput(target, target + frameSize);
+    }
+
+    const auto offset = (int) (frameStart - inputStart);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        FloatVectorOperations::addWithMultiply(outputBuffer.getWritePointer(ch),
+                                               inputBuffer.getReadPointer(ch, offset),
+                                               window.get(),
+                                               frameSize);
+    }
+
+    outputReady = hopSize;
+    previousFrameStart = frameStart;
+    hasPreviousFrame = true;
+
+    //output always advances by hopSize, the input by hopSize times the ratio
+    analysisPosition += hopSize * stretchRatio.load();
+}
+
+void TimeStretcher::fillInput(int64 keepFrom, int64 endPosition)
+{
+    while (inputStart + inputFill < endPosition)
+    {
+        if (inputBuffer.getNumSamples() - inputFill < blockSize)
+        {
+            //make room by dropping what no later frame will look at
+            const auto numToDrop = (int) jlimit((int64) 0, (int64) inputFill, keepFrom - inputStart);
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* samples = inputBuffer.getWritePointer(ch);
+                std::memmove(samples, samples + numToDrop, sizeof(float) * (size_t) (inputFill - numToDrop));
+            }
+            inputStart += numToDrop;
+            inputFill -= numToDrop;
+        }
+
+        const auto numToRead = (int) jmin((int64) blockSize,
+                                          (int64) (inputBuffer.getNumSamples() - inputFill),
+                                          endPosition - (inputStart + inputFill));
+        if (numToRead <= 0)
+        {
+            //the buffer is sized so this can't happen
+            jassertfalse;
+            break;
+        }
+
+        input->getNextAudioBlock(AudioSourceChannelInfo(&inputBuffer, inputFill, numToRead));
+        inputFill += numToRead;
+    }
+}
+
+int64 TimeStretcher::findBestFrameStart(int64 continuation, int64 target, int64 lo, int64 hi)
+{
+    const int overlap = hopSize;
+    const auto regionStart = jmin(lo, continuation);
+    const auto regionLength = (int) (jmax(hi, continuation) + overlap - regionStart);
+    const auto offset = (int) (regionStart - inputStart);
+
+    //the search runs on a mono mix
+    FloatVectorOperations::copy(monoScratch.get(), inputBuffer.getReadPointer(0, offset), regionLength);
+    for (int ch = 1; ch < numChannels; ++ch)
+    {
+        FloatVectorOperations::add(monoScratch.get(), inputBuffer.getReadPointer(ch, offset), regionLength);
+    }
+
+    const float* continuationSamples = monoScratch.get() + (continuation - regionStart);
+    const float* candidateSamples = monoScratch.get() + (lo - regionStart);
+
+    //nothing to line up with in silence, so stay on the target
+    if (VectorKernels::dotProduct(continuationSamples, continuationSamples, overlap) < 1.0e-6f)
+    {
+        return jlimit(lo, hi, target);
+    }
+
+    //coarse pass: every 4th offset, comparing every 4th sample
+    const int coarseOverlap = overlap / 4;
+    const int numCoarse = (int) (hi - lo) / 4 + 1;
+
+    for (int i = 0; i < coarseOverlap; ++i)
+    {
+        coarseContinuation[i] = continuationSamples[i * 4];
+    }
+    for (int i = 0; i < numCoarse + coarseOverlap - 1; ++i)
+    {
+        coarseCandidates[i] = candidateSamples[i * 4];
+    }
+
+    double energy = 0;
+    for (int i = 0; i < coarseOverlap; ++i)
+    {
+        energy += coarseCandidates[i] * coarseCandidates[i];
+    }
+
+    int bestCoarse = 0;
+    double bestScore = -1.0e30;
+    for (int j = 0; j < numCoarse; ++j)
+    {
+        if (j > 0)
+        {
+            const float entering = coarseCandidates[j + coarseOverlap - 1];
+            const float leaving = coarseCandidates[j - 1];
+            energy += entering * entering - leaving * leaving;
+        }
+
+        const double score = VectorKernels::dotProduct(coarseContinuation.get(), coarseCandidates.get() + j, coarseOverlap)
+                             / std::sqrt(jmax(energy, 1.0e-9));
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestCoarse = j;
+        }
+    }
+
+    //fine pass: every offset around the coarse winner, at full resolution
+    const auto coarseStart = lo + bestCoarse * 4;
+    auto bestStart = coarseStart;
+    bestScore = -1.0e30;
+
+    for (auto start = jmax(lo, coarseStart - 3); start <= jmin(hi, coarseStart + 3); ++start)
+    {
+        const float* candidate = monoScratch.get() + (start - regionStart);
+        const double candidateEnergy = VectorKernels::dotProduct(candidate, candidate, overlap);
+        const double score = VectorKernels::dotProduct(continuationSamples, candidate, overlap)
+                             / std::sqrt(jmax(candidateEnergy, 1.0e-9));
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestStart = start;
+        }
+    }
+    return bestStart;
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    TimeStretcher.h
+    Created: 17 Oct 2026 3:22:47pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Key lock for a deck. With key lock on, the input is played faster or slower
+    by the stretch ratio without changing its pitch (WSOLA: overlapping Hann
+    frames, each one nudged to where it best lines up with the previous frame).
+    With key lock off the input passes straight through.
+
+    All buffers are allocated in prepareToPlay, so nothing allocates or locks on
+    the audio thread. The ratio and the key lock can be changed from any thread.
+*/
+class TimeStretcher : public AudioSource
+{
+public:
+    TimeStretcher(AudioSource* _input, int _numChannels = 2);
+
+    /** > 1 plays faster, < 1 slower. Clamped to 0.25 - 4 */
+    void setStretchRatio(double ratio);
+    double getStretchRatio() const;
+
+    void setKeyLock(bool shouldBeOn);
+    bool isKeyLockOn() const;
+
+    /** how far the input has been pulled ahead of the next sample to come out,
+        in input samples. 0 with key lock off (audio thread) */
+    int getLatencySamples() const;
+
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    /** drops all state so the next block starts a fresh stretch (audio thread) */
+    void reset();
+    /** overlap-adds one more frame, leaving hopSize finished samples at the front of the output */
+    void synthesiseFrame();
+    /** pulls from the input until the buffer reaches endPosition, discarding anything before keepFrom */
+    void fillInput(int64 keepFrom, int64 endPosition);
+    /** the frame start in [lo, hi] that best continues the last frame, target when there is nothing to match */
+    int64 findBestFrameStart(int64 continuation, int64 target, int64 lo, int64 hi);
+
+    AudioSource* input;
+    const int numChannels;
+
+    std::atomic<double> stretchRatio{1.0};
+    std::atomic<bool> keyLock{false};
+    bool keyLockActive = false;
+
+    int blockSize = 0;
+    int frameSize = 0;
+    int hopSize = 0;
+    int searchRange = 0;
+
+    HeapBlock<float> window;
+
+    // input samples, inputBuffer[0] being inputStart samples into the stream
+    AudioBuffer<float> inputBuffer;
+    int64 inputStart = 0;
+    int inputFill = 0;
+
+    // overlap-add accumulator, the first outputReady samples are finished
+    AudioBuffer<float> outputBuffer;
+    int outputReady = 0;
+
+    double analysisPosition = 0;
+    int64 previousFrameStart = 0;
+    bool hasPreviousFrame = false;
+
+    // mono mix and 4x decimated copies used by the similarity search
+    HeapBlock<float> monoScratch;
+    HeapBlock<float> coarseContinuation;
+    HeapBlock<float> coarseCandidates;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeStretcher)
+};
@@ -0,0 +1,361 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.cpp
+    Created: 17 Oct 2026 10:26:41pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TrackAnalyser.h"
+#include "DecodedTrackCache.h"
+
+static const double maxAnalysisSeconds = 60.0;
+static const double analysisSampleRate = 22050.0;
+
+// 4096 point frames, about 5Hz per bin at the analysis rate
+static const int keyFftOrder = 12;
+// below this the bins are too coarse to tell semitones apart, above it harmonics muddy the chroma
+static const double lowestKeyFrequency = 110.0;
+static const double highestKeyFrequency = 3520.0;
+
+// Krumhansl-Kessler key profiles, from the tonic upwards
+static const double majorProfile[12] = { 6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88 };
+static const double minorProfile[12] = { 6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17 };
+static const char* const pitchNames[12] = { "C", "C#", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B" };
+
+//==============================================================================
+TrackAnalyser::AnalysisJob::AnalysisJob(TrackAnalyser& _owner, const File& _file)
+                          : ThreadPoolJob("Track analysis"),
+                            owner(_owner),
+                            file(_file)
+{
+}
+
+ThreadPoolJob::JobStatus TrackAnalyser::AnalysisJob::runJob()
+{
+    AudioBuffer<float> mono;
+    double sampleRate = 0, start = 0;
+    Result result;
+
+    if (readForAnalysis(mono, sampleRate, start, result))
+    {
+        const auto analysed = analyseSamples(mono, sampleRate);
+        result.beatgrid = analysed.beatgrid;
+        result.key = analysed.key;
+
+        //the grid was found in the middle of the track, move beat 0 back to its start
+        if (result.beatgrid.isValid())
+        {
+            const double beatLength = 60.0 / result.beatgrid.bpm;
+            result.beatgrid.firstBeat = std::fmod(result.beatgrid.firstBeat + start, beatLength);
+        }
+    }
+
+    //shutting down: leave it unanalysed rather than store a result from half the audio
+    if (! shouldExit())
+    {
+        owner.storeResult(file, result);
+    }
+    return jobHasFinished;
+}
+
+bool TrackAnalyser::AnalysisJob::readForAnalysis(AudioBuffer<float>& mono, double& sampleRate, double& start, Result& result)
+{
+    std::unique_ptr<AudioFormatReader> reader (owner.formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0 || reader->lengthInSamples <= 0)
+    {
+        std::cout << "TrackAnalyser::AnalysisJob could not read " << file.getFullPathName() << std::endl;
+        return false;
+    }
+
+    //averaging each group of samples is a crude low pass, but onsets and chroma don't need better
+    const int factor = jmax(1, roundToInt(reader->sampleRate / analysisSampleRate));
+    const int64 numToRead = jmin(reader->lengthInSamples, (int64) (maxAnalysisSeconds * reader->sampleRate));
+    const int64 readStart = (reader->lengthInSamples - numToRead) / 2;
+
+    sampleRate = reader->sampleRate / factor;
+    start = readStart / reader->sampleRate;
+    mono.setSize(1, (int) (numToRead / factor));
+
+    //loudness needs every sample, tempo and key only the middle, so the rest is measured on either side of it
+    IntegratedLoudness loudness(reader->sampleRate);
+    if (! measureRange(*reader, 0, readStart, loudness))
+    {
+        return false;
+    }
+
+    const int chunkSize = 16384;
+    AudioBuffer<float> chunk(2, chunkSize * factor);
+    auto* out = mono.getWritePointer(0);
+    const float scale = 0.5f / factor;
+
+    for (int done = 0; done < mono.getNumSamples(); done += chunkSize)
+    {
+        if (shouldExit())
+        {
+            return false;
+        }
+
+        const int numOut = jmin(chunkSize, mono.getNumSamples() - done);
+        reader->read(&chunk, 0, numOut * factor, readStart + (int64) done * factor, true, true);
+        loudness.process(chunk, 0, numOut * factor);
+
+        auto* left = chunk.getReadPointer(0);
+        auto* right = chunk.getReadPointer(1);
+        for (int i = 0; i < numOut; ++i)
+        {
+            float sum = 0;
+            for (int j = i * factor; j < (i + 1) * factor; ++j)
+            {
+                sum += left[j] + right[j];
+            }
+            out[done + i] = sum * scale;
+        }
+    }
+
+    if (! measureRange(*reader, readStart + (int64) mono.getNumSamples() * factor, reader->lengthInSamples, loudness))
+    {
+        return false;
+    }
+
+    result.hasLoudness = true;
+    result.loudness = loudness.getLoudness();
+    result.truePeak = loudness.getTruePeak();
+    result.soundStart = loudness.getSoundStart() / reader->sampleRate;
+    result.soundEnd = loudness.getSoundEnd() / reader->sampleRate;
+    return true;
+}
+
+bool TrackAnalyser::AnalysisJob::measureRange(AudioFormatReader& reader, int64 start, int64 end, IntegratedLoudness& loudness)
+{
+    const int chunkSize = 65536;
+    AudioBuffer<float> chunk(2, chunkSize);
+
+    for (int64 position = start; position < end; position += chunkSize)
+    {
+        if (shouldExit())
+        {
+            return false;
+        }
+
+        const int numToRead = (int) jmin((int64) chunkSize, end - position);
+        reader.read(&chunk, 0, numToRead, position, true, true);
+        loudness.process(chunk, 0, numToRead);
+    }
+    return true;
+}
+
+//==============================================================================
+TrackAnalyser::TrackAnalyser(AudioFormatManager& _formatManager, int numThreads)
+              : formatManager(_formatManager),
+                pool(jmax(1, numThreads))
+{
+    //the decks' threads come first, analysis only gets what's left over
+    pool.setThreadPriorities(2);
+}
+
+TrackAnalyser::~TrackAnalyser()
+{
+    pool.removeAllJobs(true, 10000);
+}
+
+void TrackAnalyser::analyse(const File& file)
+{
+    //keyed like the decode cache, so an edited or replaced file is analysed again
+    const auto key = DecodedTrackCache::getKeyFor(file);
+    {
+        const ScopedLock sl(lock);
+        if (results.find(key) != results.end() || queuedKeys.contains(key))
+        {
+            return;
+        }
+        queuedKeys.add(key);
+    }
+
+    pool.addJob(new AnalysisJob(*this, file), true);
+}
+
+bool TrackAnalyser::getResult(const File& file, Result& result) const
+{
+    const ScopedLock sl(lock);
+
+    auto found = results.find(DecodedTrackCache::getKeyFor(file));
+    if (found == results.end())
+    {
+        return false;
+    }
+    result = found->second;
+    return true;
+}
+
+int TrackAnalyser::getNumPending() const
+{
+    const ScopedLock sl(lock);
+    return queuedKeys.size();
+}
+
+bool TrackAnalyser::saveResults(const File& file) const
+{
+    String text;
+    {
+        const ScopedLock sl(lock);
+        for (auto& item : results)
+        {
+            const auto& result = item.second;
+            text << item.first << "\t" << String(result.beatgrid.bpm, 3) << "\t"
+                 << String(result.beatgrid.firstBeat, 4) << "\t" << result.key << "\t"
+                 << (result.hasLoudness ? String(result.loudness, 2) : String()) << "\t"
+                 << (result.hasLoudness ? String(result.truePeak, 2) : String()) << "\t"
+                 << String(result.soundStart, 4) << "\t" << String(result.soundEnd, 4) << "\n";
+        }
+    }
+    return file.replaceWithText(text, false, false, "\n");
+}
+
+void TrackAnalyser::loadResults(const File& file)
+{
+    StringArray lines;
+    lines.addLines(file.loadFileAsString());
+
+    const ScopedLock sl(lock);
+    for (auto& line : lines)
+    {
+        StringArray fields;
+        fields.addTokens(line, "\t", "");
+
+        //lines from before loudness and silence were measured, or keyed by path alone, are left out
+        //so those tracks get analysed again
+        if (fields.size() < 8 || ! fields[0].contains("|"))
+        {
+            continue;
+        }
+
+        Result result;
+        result.beatgrid = { fields[1].getDoubleValue(), fields[2].getDoubleValue() };
+        result.key = fields[3];
+        result.hasLoudness = fields[4].isNotEmpty();
+        if (result.hasLoudness)
+        {
+            result.loudness = fields[4].getFloatValue();
+            result.truePeak = fields[5].getFloatValue();
+        }
+        result.soundStart = fields[6].getDoubleValue();
+        result.soundEnd = fields[7].getDoubleValue();
+        results[fields[0]] = result;
+    }
+}
+
+void TrackAnalyser::storeResult(const File& file, const Result& result)
+{
+    {
+        const ScopedLock sl(lock);
+        const auto key = DecodedTrackCache::getKeyFor(file);
+        results[key] = result;
+        queuedKeys.removeString(key);
+    }
+    sendChangeMessage();
+}
+
+//==============================================================================
+TrackAnalyser::Result TrackAnalyser::analyseSamples(const AudioBuffer<float>& mono, double sampleRate)
+{
+    Result result;
+    result.beatgrid = Beatgrid::analyse(mono, sampleRate);
+    result.key = estimateKey(mono, sampleRate);
+    return result;
+}
+
+String TrackAnalyser::estimateKey(const AudioBuffer<float>& mono, double sampleRate)
+{
+    dsp::FFT fft(keyFftOrder);
+    const int fftSize = fft.getSize();
+    dsp::WindowingFunction<float> window((size_t) fftSize, dsp::WindowingFunction<float>::hann, false);
+
+    //pitch class of every bin in range, -1 for the rest
+    HeapBlock<int> binPitchClass(fftSize / 2);
+    for (int bin = 0; bin < fftSize / 2; ++bin)
+    {
+        const double frequency = bin * sampleRate / fftSize;
+        binPitchClass[bin] = -1;
+        if (frequency >= lowestKeyFrequency && frequency <= highestKeyFrequency)
+        {
+            //semitones from A, shifted so that C is 0
+            const int semitone = roundToInt(12.0 * std::log2(frequency / 440.0)) + 9;
+            binPitchClass[bin] = ((semitone % 12) + 12) % 12;
+        }
+    }
+
+    //frequency-only transform needs room for the complex result
+    HeapBlock<float> fftData(fftSize * 2);
+    double chroma[12] = {};
+
+    for (int start = 0; start + fftSize <= mono.getNumSamples(); start += fftSize)
+    {
+        std::memcpy(fftData.getData(), mono.getReadPointer(0, start), sizeof(float) * (size_t) fftSize);
+        window.multiplyWithWindowingTable(fftData, (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData);
+
+        for (int bin = 0; bin < fftSize / 2; ++bin)
+        {
+            if (binPitchClass[bin] >= 0)
+            {
+                //log magnitude, so a loud bassline doesn't outvote everything else
+                chroma[binPitchClass[bin]] += std::log1p(fftData[bin]);
+            }
+        }
+    }
+
+    //correlate against every major and minor key
+    double mean = 0;
+    for (double value : chroma)
+    {
+        mean += value / 12.0;
+    }
+    if (mean <= 0)
+    {
+        return {};
+    }
+
+    auto correlate = [&chroma, mean] (const double* profile, int tonic)
+    {
+        double profileMean = 0;
+        for (int i = 0; i < 12; ++i)
+        {
+            profileMean += profile[i] / 12.0;
+        }
+
+        double product = 0, chromaSquares = 0, profileSquares = 0;
+        for (int i = 0; i < 12; ++i)
+        {
+            const double c = chroma[(tonic + i) % 12] - mean;
+            const double p = profile[i] - profileMean;
+            product += c * p;
+            chromaSquares += c * c;
+            profileSquares += p * p;
+        }
+        return chromaSquares > 0 ? product / std::sqrt(chromaSquares * profileSquares) : 0.0;
+    };
+
+    String bestKey;
+    double bestCorrelation = 0;
+    for (int tonic = 0; tonic < 12; ++tonic)
+    {
+        const double major = correlate(majorProfile, tonic);
+        const double minor = correlate(minorProfile, tonic);
+
+        if (major > bestCorrelation)
+        {
+            bestCorrelation = major;
+            bestKey = pitchNames[tonic];
+        }
+        if (minor > bestCorrelation)
+        {
+            bestCorrelation = minor;
+            bestKey = String(pitchNames[tonic]) + "m";
+        }
+    }
+    return bestKey;
+}
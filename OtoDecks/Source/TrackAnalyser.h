@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.h
+    Created: 17 Oct 2026 10:26:41pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include "Beatgrid.h"
+#include "IntegratedLoudness.h"
+
+//==============================================================================
+/*
+    Offline BPM, beatgrid, key and loudness analysis for the library. Files are
+    analysed in the background on a low priority pool with one thread per core,
+    and a change message goes out whenever results come in.
+
+    Each track is decoded once. The whole of it is measured for integrated
+    loudness and true peak, which the decks use to level tracks on load. Only
+    the middle minute is mixed to mono and brought down to about 22kHz for the
+    tempo and the key, which is all they need.
+*/
+class TrackAnalyser : public ChangeBroadcaster
+{
+public:
+    struct Result
+    {
+        Beatgrid beatgrid;
+        // e.g. "F#m", empty if no key stood out
+        String key;
+        // integrated loudness in LUFS and true peak in dBTP, if the track could be read
+        bool hasLoudness = false;
+        float loudness = LevelMeter::minimumLoudness;
+        float truePeak = 0;
+        // where the track's audio starts and ends in seconds, leaving out silence before and after it
+        double soundStart = 0;
+        double soundEnd = 0;
+    };
+
+    TrackAnalyser(AudioFormatManager& _formatManager, int numThreads = SystemStats::getNumCpus());
+    ~TrackAnalyser() override;
+
+    /** queues a file, unless it has already been analysed or is waiting to be */
+    void analyse(const File& file);
+    /** false while the file hasn't been analysed yet */
+    bool getResult(const File& file, Result& result) const;
+    /** files queued or being analysed */
+    int getNumPending() const;
+
+    /** one line per track: the file's cache key (path, size and date), bpm, first beat, key,
+        loudness, true peak and where the sound starts and ends, tab separated */
+    bool saveResults(const File& file) const;
+    void loadResults(const File& file);
+
+    /** analyses mono samples on the calling thread */
+    static Result analyseSamples(const AudioBuffer<float>& mono, double sampleRate);
+    /** estimates the key from a chromagram, matched against the Krumhansl-Kessler profiles */
+    static String estimateKey(const AudioBuffer<float>& mono, double sampleRate);
+
+private:
+    class AnalysisJob : public ThreadPoolJob
+    {
+    public:
+        AnalysisJob(TrackAnalyser& _owner, const File& _file);
+        JobStatus runJob() override;
+
+    private:
+        /** decodes the file, measuring all of it into result's loudness and returning the part
+            that gets analysed in mono. start is where that part begins, in seconds */
+        bool readForAnalysis(AudioBuffer<float>& mono, double& sampleRate, double& start, Result& result);
+        /** measures samples from start to end of the file, outside the part that gets analysed */
+        bool measureRange(AudioFormatReader& reader, int64 start, int64 end, IntegratedLoudness& loudness);
+
+        TrackAnalyser& owner;
+        File file;
+    };
+
+    void storeResult(const File& file, const Result& result);
+
+    AudioFormatManager& formatManager;
+
+    CriticalSection lock;
+    std::map<String, Result> results;
+    StringArray queuedKeys;
+
+    ThreadPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackAnalyser)
+};
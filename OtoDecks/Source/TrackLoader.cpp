@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    TrackLoader.cpp
+    Created: 17 Oct 2026 11:03:18am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "TrackLoader.h"
+
+//==============================================================================
+void LoadedTrack::setBeatgrid(const Beatgrid& grid)
+{
+    beatgridFirstBeat.store(grid.firstBeat, std::memory_order_relaxed);
+    beatgridBpm.store(grid.bpm, std::memory_order_release);
+}
+
+Beatgrid LoadedTrack::getBeatgrid() const
+{
+    const double bpm = beatgridBpm.load(std::memory_order_acquire);
+    return { bpm, beatgridFirstBeat.load(std::memory_order_relaxed) };
+}
+
+//==============================================================================
+TrackLoader::TrackLoader(AudioFormatManager& _formatManager,
+                         ReadAheadPool& _readAheadPool,
+                         DecodedTrackCache& _decodedTrackCache)
+           : Thread("Track loader"),
+             formatManager(_formatManager),
+             readAheadPool(_readAheadPool),
+             decodedTrackCache(_decodedTrackCache)
+{
+    startThread();
+}
+
+TrackLoader::~TrackLoader()
+{
+    //wake the loader so it sees the exit flag instead of waiting for the next request
+    signalThreadShouldExit();
+    notify();
+    stopThread(4000);
+}
+
+void TrackLoader::prepare(int samplesPerBlockExpected, double _sampleRate)
+{
+    blockSize = samplesPerBlockExpected;
+    sampleRate = _sampleRate;
+}
+
+std::unique_ptr<LoadedTrack> TrackLoader::load(const URL& url, int readAheadSize)
+{
+    std::unique_ptr<LoadedTrack> track, staleTrack;
+    {
+        const ScopedLock sl(lock);
+
+        //anything requested earlier is superseded by this load
+        staleTrack = std::move(loadedTrack);
+        hasRequest = false;
+        inProgressIsRequested = false;
+
+        if (preloadedTrack != nullptr && preloadedTrack->url == url)
+        {
+            track = std::move(preloadedTrack);
+        }
+        else if (! inProgressURL.isEmpty() && inProgressURL == url)
+        {
+            //already being opened as a preload, hand it over as soon as it is done
+            inProgressIsRequested = true;
+        }
+        else
+        {
+            requestedURL = url;
+            requestedReadAhead = readAheadSize;
+            hasRequest = true;
+        }
+    }
+
+    if (track != nullptr)
+    {
+        prepareTrack(*track);
+    }
+    else
+    {
+        notify();
+    }
+    return track;
+}
+
+void TrackLoader::preload(const URL& url, int readAheadSize)
+{
+    {
+        const ScopedLock sl(lock);
+
+        if ((preloadedTrack != nullptr && preloadedTrack->url == url)
+            || (! inProgressURL.isEmpty() && inProgressURL == url))
+        {
+            return;
+        }
+
+        preloadURL = url;
+        preloadReadAhead = readAheadSize;
+        hasPreloadRequest = true;
+    }
+    notify();
+}
+
+std::unique_ptr<LoadedTrack> TrackLoader::takePreloadedTrack(const URL& url)
+{
+    std::unique_ptr<LoadedTrack> track;
+    {
+        const ScopedLock sl(lock);
+        if (preloadedTrack != nullptr && preloadedTrack->url == url)
+        {
+            track = std::move(preloadedTrack);
+        }
+    }
+
+    if (track != nullptr)
+    {
+        prepareTrack(*track);
+    }
+    return track;
+}
+
+std::unique_ptr<LoadedTrack> TrackLoader::takeLoadedTrack()
+{
+    std::unique_ptr<LoadedTrack> track;
+    {
+        const ScopedLock sl(lock);
+        track = std::move(loadedTrack);
+    }
+
+    if (track != nullptr)
+    {
+        prepareTrack(*track);
+    }
+    return track;
+}
+
+bool TrackLoader::isLoading() const
+{
+    const ScopedLock sl(lock);
+    return hasRequest || inProgressIsRequested || loadedTrack != nullptr;
+}
+
+void TrackLoader::prepareTrack(LoadedTrack& track)
+{
+    if (track.preparedSampleRate != sampleRate || track.preparedBlockSize != blockSize)
+    {
+        //tracks decoded at the device's rate skip the transport's resampler; a device at another rate puts it back
+        const double correction = track.sourceSampleRate == sampleRate ? 0.0 : track.sourceSampleRate;
+        if (correction != track.correctedSampleRate)
+        {
+            const bool wasPlaying = track.transportSource.isPlaying();
+            track.transportSource.setSource(track.source.get(), 0, nullptr, correction);
+            track.correctedSampleRate = correction;
+            if (wasPlaying)
+            {
+                track.transportSource.start();
+            }
+        }
+
+        track.preparedSampleRate = sampleRate;
+        track.preparedBlockSize = blockSize;
+        track.transportSource.prepareToPlay(track.preparedBlockSize, track.preparedSampleRate);
+    }
+}
+
+void TrackLoader::setOffline(bool shouldBeOffline)
+{
+    offline = shouldBeOffline;
+}
+
+//==============================================================================
+void TrackLoader::run()
+{
+    while (! threadShouldExit())
+    {
+        URL url;
+        int readAheadSize = 0;
+        {
+            const ScopedLock sl(lock);
+
+            //a requested load always goes before a preload
+            if (hasRequest)
+            {
+                url = requestedURL;
+                readAheadSize = requestedReadAhead;
+                hasRequest = false;
+                inProgressIsRequested = true;
+            }
+            else if (hasPreloadRequest)
+            {
+                url = preloadURL;
+                readAheadSize = preloadReadAhead;
+                hasPreloadRequest = false;
+                inProgressIsRequested = false;
+            }
+            inProgressURL = url;
+        }
+
+        if (url.isEmpty())
+        {
+            wait(-1);
+            continue;
+        }
+
+        auto track = openTrack(url, readAheadSize);
+
+        bool trackIsReady = false;
+        std::unique_ptr<LoadedTrack> unusedTrack;
+        {
+            const ScopedLock sl(lock);
+
+            if (inProgressIsRequested)
+            {
+                loadedTrack = std::move(track);
+                trackIsReady = loadedTrack != nullptr;
+            }
+            else
+            {
+                unusedTrack = std::move(preloadedTrack);
+                preloadedTrack = std::move(track);
+            }
+            inProgressURL = URL();
+            inProgressIsRequested = false;
+        }
+
+        if (trackIsReady)
+        {
+            sendChangeMessage();
+        }
+    }
+}
+
+std::unique_ptr<LoadedTrack> TrackLoader::openTrack(const URL& url, int readAheadSize)
+{
+    std::unique_ptr<LoadedTrack> track (new LoadedTrack());
+    track->url = url;
+
+    if (url.isLocalFile())
+    {
+        //offline there's time to decode up front, and the track has its beatgrid from the first block
+        track->decodedTrack = offline ? decodedTrackCache.decodeNow(url.getLocalFile())
+                                      : decodedTrackCache.getTrack(url.getLocalFile());
+    }
+
+    if (track->decodedTrack != nullptr)
+    {
+        //already decoded: RAM plays directly, the mapped disk tier still reads ahead in case of page faults
+        track->sourceSampleRate = track->decodedTrack->getSampleRate();
+        track->setBeatgrid(track->decodedTrack->getBeatgrid());
+        track->source.reset(new DecodedTrackSource(track->decodedTrack));
+
+        if (! track->decodedTrack->isInMemory() && ! offline)
+        {
+            track->readAheadSource = new ReadAheadSource(track->source.release(), readAheadPool, readAheadSize);
+            track->source.reset(track->readAheadSource);
+        }
+    }
+    else
+    {
+        auto* reader = formatManager.createReaderFor(url.createInputStream(false));
+        if (reader == nullptr)
+        {
+            std::cout << "TrackLoader::openTrack could not open " << url.toString(false) << std::endl;
+            return nullptr;
+        }
+
+        //stream this time, and decode into the cache so the next load of it skips the decoder.
+        //the beatgrid is analysed as part of that decode and reaches the deck when it's done
+        track->sourceSampleRate = reader->sampleRate;
+
+        if (offline)
+        {
+            //no deadline to meet, so the render thread decodes as it goes
+            track->source.reset(new AudioFormatReaderSource(reader, true));
+        }
+        else
+        {
+            track->readAheadSource = new ReadAheadSource(new AudioFormatReaderSource(reader, true),
+                                                         readAheadPool,
+                                                         readAheadSize);
+            track->source.reset(track->readAheadSource);
+        }
+
+        if (url.isLocalFile() && ! offline)
+        {
+            decodedTrackCache.decodeInBackground(url.getLocalFile());
+        }
+    }
+
+    track->cueSource = new CueSource(track->source.release());
+    track->source.reset(track->cueSource);
+    track->correctedSampleRate = track->sourceSampleRate == sampleRate ? 0.0 : track->sourceSampleRate;
+    track->transportSource.setSource(track->source.get(), 0, nullptr, track->correctedSampleRate);
+
+    //priming the read-ahead buffer is the slow part, and it happens here rather than on the UI
+    prepareTrack(*track);
+    return track;
+}
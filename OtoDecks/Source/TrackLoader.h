@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    TrackLoader.h
+    Created: 17 Oct 2026 11:03:18am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ReadAheadPool.h"
+#include "DecodedTrackCache.h"
+#include "CueSource.h"
+
+//==============================================================================
+/*
+    A track opened, buffered and prepared off the audio thread. Once handed to a
+    deck it is only ever rendered by the audio thread and deleted by the message thread.
+*/
+struct LoadedTrack
+{
+    /** the message thread fills the grid in late when the track was streamed and the
+        background decode finishes after the hand-over; the audio thread may read it any time */
+    void setBeatgrid(const Beatgrid& grid);
+    Beatgrid getBeatgrid() const;
+
+    URL url;
+    double sourceSampleRate = 0;
+    // the rate the transport resamples from, 0 when the track is already at the device's rate
+    double correctedSampleRate = 0;
+    double preparedSampleRate = 0;
+    int preparedBlockSize = 0;
+
+    // set when the track plays from the decoded cache instead of the file
+    DecodedTrack::Ptr decodedTrack;
+    // the read-ahead buffer in the chain, if there is one (owned through source)
+    ReadAheadSource* readAheadSource = nullptr;
+    // plays the hot cues and loops, the last source before the transport (owned through source)
+    CueSource* cueSource = nullptr;
+
+    // a grid only ever goes from invalid to valid, so bpm is stored last and read first
+    std::atomic<double> beatgridBpm{0};
+    std::atomic<double> beatgridFirstBeat{0};
+
+    // where the track's audio ends, from the analysis; -1 until that's known, to play to the last sample
+    std::atomic<int64> soundEnd{-1};
+    // the auto gain worked out for the track, so an automatic crossfade can level it against the last one
+    std::atomic<float> autoGain{1.0f};
+
+    // declared after the source so the transport lets go of it first
+    std::unique_ptr<PositionableAudioSource> source;
+    AudioTransportSource transportSource;
+};
+
+//==============================================================================
+/*
+    Background loader owned by a deck. Opens the reader and primes the read-ahead
+    buffer for the next track, and keeps the head of the deck's queue preloaded so
+    that LOAD/NEXT only has to swap pointers. Sends a change message when a
+    requested track is ready to collect with takeLoadedTrack().
+*/
+class TrackLoader : public ChangeBroadcaster,
+                    private Thread
+{
+public:
+    TrackLoader(AudioFormatManager& _formatManager,
+                ReadAheadPool& _readAheadPool,
+                DecodedTrackCache& _decodedTrackCache);
+    ~TrackLoader() override;
+
+    /** device settings that new tracks are prepared with */
+    void prepare(int samplesPerBlockExpected, double sampleRate);
+
+    /** loads url in the background; replaces any load that has not started yet.
+        Returns the track straight away if it was already preloaded. */
+    std::unique_ptr<LoadedTrack> load(const URL& url, int readAheadSize);
+
+    /** opens and primes url in the background without handing it over */
+    void preload(const URL& url, int readAheadSize);
+
+    /** takes the preloaded track without a load, if it is url and it's ready. For playing
+        it after the current track rather than instead of it */
+    std::unique_ptr<LoadedTrack> takePreloadedTrack(const URL& url);
+
+    /** collects the last requested track once it is ready (message thread) */
+    std::unique_ptr<LoadedTrack> takeLoadedTrack();
+
+    /** true while a requested load has not been collected yet */
+    bool isLoading() const;
+
+    /** re-prepares a track if the device settings changed since it was loaded */
+    void prepareTrack(LoadedTrack& track);
+
+    /** for rendering offline: tracks are decoded whole before they're handed over and
+        read without read-ahead, so nothing depends on how fast background threads run */
+    void setOffline(bool shouldBeOffline);
+
+private:
+    void run() override;
+
+    std::unique_ptr<LoadedTrack> openTrack(const URL& url, int readAheadSize);
+
+    AudioFormatManager& formatManager;
+    ReadAheadPool& readAheadPool;
+    DecodedTrackCache& decodedTrackCache;
+
+    std::atomic<int> blockSize{512};
+    std::atomic<double> sampleRate{44100.0};
+    std::atomic<bool> offline{false};
+
+    CriticalSection lock;
+    URL requestedURL, preloadURL, inProgressURL;
+    int requestedReadAhead = 0, preloadReadAhead = 0;
+    bool hasRequest = false, hasPreloadRequest = false;
+    bool inProgressIsRequested = false;
+
+    std::unique_ptr<LoadedTrack> loadedTrack;
+    std::unique_ptr<LoadedTrack> preloadedTrack;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackLoader)
+};
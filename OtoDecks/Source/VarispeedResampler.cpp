@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    VarispeedResampler.cpp
+    Created: 17 Oct 2026 5:34:02pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "VarispeedResampler.h"
+#include "VectorKernels.h"
+
+static const int sincTaps = 32;
+static const int halfTaps = sincTaps / 2;
+static const int sincPhases = 256;
+static const double maxRatio = 16.0;
+
+//==============================================================================
+/*
+    Windowed-sinc coefficients, one table per band of ratios. Each table has a
+    row of taps for every fractional position, and the cutoff sits below the
+    Nyquist frequency of the fastest ratio in its band. Shared by every deck.
+*/
+struct SincTables
+{
+    static const int numBands = 6;
+
+    SincTables()
+    {
+        for (int band = 0; band < numBands; ++band)
+        {
+            //a little under the new Nyquist, so the 32 taps have room for their transition band
+            const double cutoff = 0.92 / bandUpperRatios[band];
+
+            for (int phase = 0; phase <= sincPhases; ++phase)
+            {
+                float* row = coefficients[band] + phase * sincTaps;
+                const double fraction = (double) phase / sincPhases;
+                double sum = 0;
+
+                for (int tap = 0; tap < sincTaps; ++tap)
+                {
+                    const double distance = (tap - (halfTaps - 1)) - fraction;
+                    const double x = MathConstants<double>::pi * cutoff * distance;
+                    const double sinc = x == 0 ? 1.0 : std::sin(x) / x;
+
+                    //Blackman window across the taps
+                    const double w = MathConstants<double>::pi * distance / halfTaps;
+                    const double window = std::abs(distance) >= halfTaps ? 0.0
+                                        : 0.42 + 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+
+                    row[tap] = (float) (sinc * window);
+                    sum += row[tap];
+                }
+
+                //unity gain at DC whatever the cutoff
+                for (int tap = 0; tap < sincTaps; ++tap)
+                {
+                    row[tap] = (float) (row[tap] / sum);
+                }
+            }
+        }
+    }
+
+    const float* getTable(double ratio) const
+    {
+        for (int band = 0; band < numBands - 1; ++band)
+        {
+            if (ratio <= bandUpperRatios[band])
+            {
+                return coefficients[band];
+            }
+        }
+        return coefficients[numBands - 1];
+    }
+
+    const double bandUpperRatios[numBands] = { 1.0, 1.25, 1.5, 2.0, 3.0, 4.0 };
+    float coefficients[numBands][(sincPhases + 1) * sincTaps];
+};
+
+static const SincTables& getSincTables()
+{
+    static const SincTables tables;
+    return tables;
+}
+
+//==============================================================================
+VarispeedResampler::VarispeedResampler(AudioSource* _input, int _numChannels)
+                   : input(_input),
+                     numChannels(_numChannels)
+{
+}
+
+void VarispeedResampler::setResamplingRatio(double newRatio)
+{
+    ratio = jlimit(0.0, maxRatio, newRatio);
+}
+
+double VarispeedResampler::getResamplingRatio() const
+{
+    return ratio;
+}
+
+void VarispeedResampler::setQuality(Quality newQuality)
+{
+    quality = newQuality;
+}
+
+VarispeedResampler::Quality VarispeedResampler::getQuality() const
+{
+    return quality;
+}
+
+String VarispeedResampler::getQualityName(Quality quality)
+{
+    switch (quality)
+    {
+        case Quality::linear:   return "Linear";
+        case Quality::cubic:    return "Cubic";
+        case Quality::sinc:     return "Sinc";
+    }
+    return {};
+}
+
+void VarispeedResampler::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
+{
+    blockSize = jmax(1, samplesPerBlockExpected);
+
+    //one block at the fastest ratio plus the interpolator's taps is the most a block ever pulls,
+    //and the input is prepared for that so the transport never grows its buffers on the audio thread
+    const int maxInputBlock = sincTaps + (int) std::ceil(blockSize * maxRatio) + 4;
+    input->prepareToPlay(maxInputBlock, sampleRate);
+
+    //look-behind and look-ahead for the sinc, plus one block's input at the fastest ratio
+    history.setSize(numChannels, maxInputBlock);
+    history.clear();
+
+    //start on silence so the first output has a full look-behind
+    historyFill = halfTaps - 1;
+    readPosition = halfTaps - 1;
+    lastRatio = ratio;
+
+    //build the shared tables here rather than on the audio thread
+    getSincTables();
+}
+
+void VarispeedResampler::releaseResources()
+{
+    input->releaseResources();
+}
+
+void VarispeedResampler::getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill)
+{
+    for (int done = 0; done < bufferToFill.numSamples; done += blockSize)
+    {
+        process(*bufferToFill.buffer,
+                bufferToFill.startSample + done,
+                jmin(blockSize, bufferToFill.numSamples - done));
+    }
+}
+
+//==============================================================================
+void VarispeedResampler::process(AudioBuffer<float>& dest, int destStartSample, int numSamples)
+{
+    //ramp the ratio across the block: output j advances the read position by lastRatio + step * (j + 1)
+    const double targetRatio = ratio;
+    const double step = (targetRatio - lastRatio) / numSamples;
+    const double endPosition = readPosition + numSamples * lastRatio + step * numSamples * (numSamples + 1) / 2;
+
+    const int numNeeded = (int) endPosition + halfTaps + 1;
+    if (numNeeded > historyFill)
+    {
+        jassert(numNeeded <= history.getNumSamples());
+        input->getNextAudioBlock(AudioSourceChannelInfo(&history, historyFill, numNeeded - historyFill));
+        historyFill = numNeeded;
+    }
+
+    const auto currentQuality = quality.load();
+    const float* sincTable = getSincTables().getTable(jmax(lastRatio, targetRatio));
+
+    for (int ch = 0; ch < dest.getNumChannels(); ++ch)
+    {
+        auto* out = dest.getWritePointer(ch, destStartSample);
+        if (ch >= numChannels)
+        {
+            FloatVectorOperations::clear(out, numSamples);
+            continue;
+        }
+
+        const float* in = history.getReadPointer(ch);
+        double position = readPosition;
+        double increment = lastRatio;
+
+        for (int j = 0; j < numSamples; ++j)
+        {
+            const auto i = (int) position;
+            const double fraction = position - i;
+            const auto t = (float) fraction;
+
+            switch (currentQuality)
+            {
+                case Quality::linear:
+                    out[j] = in[i] + t * (in[i + 1] - in[i]);
+                    break;
+
+                case Quality::cubic:
+                {
+                    //4-point Hermite through in[i - 1] .. in[i + 2]
+                    const float c1 = 0.5f * (in[i + 1] - in[i - 1]);
+                    const float c2 = in[i - 1] - 2.5f * in[i] + 2.0f * in[i + 1] - 0.5f * in[i + 2];
+                    const float c3 = 0.5f * (in[i + 2] - in[i - 1]) + 1.5f * (in[i] - in[i + 1]);
+                    out[j] = ((c3 * t + c2) * t + c1) * t + in[i];
+                    break;
+                }
+
+                case Quality::sinc:
+                    out[j] = interpolateSinc(in + i - (halfTaps - 1), fraction, sincTable);
+                    break;
+            }
+
+            increment += step;
+            position += increment;
+        }
+    }
+
+    readPosition = endPosition;
+    lastRatio = targetRatio;
+
+    //drop the input that is now behind the look-behind
+    const int numConsumed = (int) readPosition - (halfTaps - 1);
+    if (numConsumed > 0)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* samples = history.getWritePointer(ch);
+            std::memmove(samples, samples + numConsumed, sizeof(float) * (size_t) (historyFill - numConsumed));
+        }
+        historyFill -= numConsumed;
+        readPosition -= numConsumed;
+    }
+}
+
+float VarispeedResampler::interpolateSinc(const float* samples, double fraction, const float* table) const
+{
+    //the two nearest coefficient rows, blended by how far between them the position is
+    const double phase = fraction * sincPhases;
+    const auto row = (int) phase;
+    const auto blend = (float) (phase - row);
+
+    const float a = VectorKernels::dotProduct(samples, table + row * sincTaps, sincTaps);
+    const float b = VectorKernels::dotProduct(samples, table + (row + 1) * sincTaps, sincTaps);
+    return a + blend * (b - a);
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    VarispeedResampler.h
+    Created: 17 Oct 2026 5:34:02pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Varispeed stage of a deck, in place of ResamplingAudioSource, with a choice
+    of interpolator:
+
+        linear  cheapest, audible aliasing and high-frequency loss
+        cubic   4-point Hermite, a good default
+        sinc    32-tap windowed sinc whose cutoff follows the ratio, so speeding
+                up doesn't fold the top octave back down. Uses VectorKernels.
+
+    Quality and ratio can be changed from any thread while playing; the ratio is
+    ramped across a block so speed changes don't click.
+*/
+class VarispeedResampler : public AudioSource
+{
+public:
+    enum class Quality
+    {
+        linear,
+        cubic,
+        sinc
+    };
+
+    VarispeedResampler(AudioSource* _input, int _numChannels = 2);
+
+    /** > 1 plays faster. Clamped to 0 - 16 */
+    void setResamplingRatio(double ratio);
+    double getResamplingRatio() const;
+
+    void setQuality(Quality newQuality);
+    Quality getQuality() const;
+
+    static String getQualityName(Quality quality);
+
+    void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
+    void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill) override;
+    void releaseResources() override;
+
+private:
+    /** resamples up to blockSize output samples */
+    void process(AudioBuffer<float>& dest, int destStartSample, int numSamples);
+
+    float interpolateSinc(const float* samples, double fraction, const float* table) const;
+
+    AudioSource* input;
+    const int numChannels;
+
+    std::atomic<double> ratio{1.0};
+    std::atomic<Quality> quality{Quality::cubic};
+    double lastRatio = 1.0;
+
+    int blockSize = 0;
+
+    // input samples; the output's next read position is readPosition samples into it
+    AudioBuffer<float> history;
+    int historyFill = 0;
+    double readPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VarispeedResampler)
+};
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    VectorKernels.cpp
+    Created: 17 Oct 2026 5:10:31pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "VectorKernels.h"
+
+#if defined (__AVX__)
+ #include <immintrin.h>
+#elif JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+//==============================================================================
+float VectorKernels::dotProduct(const float* a, const float* b, int numSamples)
+{
+    int i = 0;
+    float sum = 0;
+
+   #if defined (__AVX__) || JUCE_USE_SSE_INTRINSICS
+    __m128 sum4 = _mm_setzero_ps();
+
+   #if defined (__AVX__)
+    __m256 sum8 = _mm256_setzero_ps();
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+   #endif
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+
+    //horizontal add of the four lanes
+    sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+    sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+    sum = _mm_cvtss_f32(sum4);
+
+   #elif JUCE_USE_ARM_NEON
+    float32x4_t sum4 = vdupq_n_f32(0);
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        sum4 = vmlaq_f32(sum4, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    sum = (vgetq_lane_f32(sum4, 0) + vgetq_lane_f32(sum4, 1))
+        + (vgetq_lane_f32(sum4, 2) + vgetq_lane_f32(sum4, 3));
+
+   #else
+    //four independent sums, so the compiler can still vectorise it
+    float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        sum0 += a[i] * b[i];
+        sum1 += a[i + 1] * b[i + 1];
+        sum2 += a[i + 2] * b[i + 2];
+        sum3 += a[i + 3] * b[i + 3];
+    }
+    sum = (sum0 + sum1) + (sum2 + sum3);
+   #endif
+
+    for (; i < numSamples; ++i)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+const char* VectorKernels::getInstructionSetName()
+{
+   #if defined (__AVX__)
+    return "AVX";
+   #elif JUCE_USE_SSE_INTRINSICS
+    return "SSE";
+   #elif JUCE_USE_ARM_NEON
+    return "NEON";
+   #else
+    return "scalar";
+   #endif
+}
@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    VectorKernels.h
+    Created: 17 Oct 2026 5:10:31pm
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Inner loops the deck DSP spends most of its time in, written against the
+    CPU's vector units: AVX when the build enables it, otherwise SSE on Intel
+    and NEON on ARM, with a plain loop for anything else. Pointers don't need
+    to be aligned.
+*/
+class VectorKernels
+{
+public:
+    /** sum of a[i] * b[i] */
+    static float dotProduct(const float* a, const float* b, int numSamples);
+
+    /** the name of the instruction set dotProduct was built for */
+    static const char* getInstructionSetName();
+};
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    WaveformCache.cpp
+    Created: 18 Oct 2026 8:47:52am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "WaveformCache.h"
+#include "DecodedTrackCache.h"
+
+// a few hundred tracks' worth; with the bands at 9 bytes a bin, a waveform file is about 1.9MB for five minutes at 44.1kHz
+static const int64 diskBudgetBytes = (int64) 512 * 1024 * 1024;
+
+//==============================================================================
+WaveformCache::WaveformCache(AudioFormatManager& _formatManager,
+                             int _maxTracksInMemory,
+                             File _cacheDirectory)
+             : formatManager(_formatManager),
+               maxTracksInMemory(_maxTracksInMemory),
+               cacheDirectory(_cacheDirectory)
+{
+    if (cacheDirectory == File())
+    {
+        cacheDirectory = File::getSpecialLocation(File::userApplicationDataDirectory)
+                             .getChildFile("OtoDecks")
+                             .getChildFile("Waveform Cache");
+    }
+    cacheDirectory.createDirectory();
+
+    //the band analysis makes a build heavier than the decode it rides on, so it yields to the loaders
+    buildPool.setThreadPriorities(2);
+}
+
+WaveformCache::~WaveformCache()
+{
+    buildPool.removeAllJobs(true, 10000);
+}
+
+WaveformPyramid::Ptr WaveformCache::getPyramid(const URL& url)
+{
+    auto key = getKeyFor(url);
+    {
+        const ScopedLock sl(lock);
+
+        auto found = entries.find(key);
+        if (found != entries.end())
+        {
+            found->second.lastUsed = ++useCounter;
+            return found->second.pyramid;
+        }
+        if (keysBeingBuilt.contains(key))
+        {
+            return nullptr;
+        }
+
+        //seen in an earlier session: the file is small enough to read here, which is as good as instant
+        auto diskFile = getDiskFileFor(key);
+        if (auto pyramid = WaveformPyramid::readFromFile(diskFile, key))
+        {
+            //touched so the disk budget keeps the tracks in use
+            diskFile.setLastModificationTime(Time::getCurrentTime());
+            entries[key] = { pyramid, ++useCounter };
+            trimToLimit();
+            return pyramid;
+        }
+        keysBeingBuilt.add(key);
+    }
+
+    buildPool.addJob([this, url, key]
+    {
+        build(url, key);
+        {
+            const ScopedLock sl(lock);
+            keysBeingBuilt.removeString(key);
+        }
+        sendChangeMessage();
+    });
+    return nullptr;
+}
+
+String WaveformCache::getKeyFor(const URL& url)
+{
+    return url.isLocalFile() ? DecodedTrackCache::getKeyFor(url.getLocalFile()) : url.toString(false);
+}
+
+//==============================================================================
+void WaveformCache::build(const URL& url, const String& key)
+{
+    std::unique_ptr<AudioFormatReader> reader (url.isLocalFile() ? formatManager.createReaderFor(url.getLocalFile())
+                                                                 : formatManager.createReaderFor(url.createInputStream(false)));
+    WaveformPyramid::Ptr pyramid;
+    if (reader != nullptr)
+    {
+        pyramid = WaveformPyramid::build(*reader);
+    }
+    if (pyramid != nullptr)
+    {
+        auto diskFile = getDiskFileFor(key);
+        if (pyramid->writeToFile(diskFile, key))
+        {
+            trimDiskTier();
+        }
+        else
+        {
+            std::cout << "WaveformCache::build could not write " << diskFile.getFullPathName() << std::endl;
+        }
+    }
+    else
+    {
+        std::cout << "WaveformCache::build could not open " << url.toString(false) << std::endl;
+    }
+
+    {
+        //a track that can't be read is remembered as such, so it isn't tried again every time it's drawn
+        const ScopedLock sl(lock);
+        entries[key] = { pyramid, ++useCounter };
+    }
+    trimToLimit();
+}
+
+void WaveformCache::trimToLimit()
+{
+    const ScopedLock sl(lock);
+
+    while ((int) entries.size() > maxTracksInMemory)
+    {
+        auto oldest = entries.begin();
+        for (auto item = entries.begin(); item != entries.end(); ++item)
+        {
+            if (item->second.lastUsed < oldest->second.lastUsed)
+            {
+                oldest = item;
+            }
+        }
+        entries.erase(oldest);
+    }
+}
+
+File WaveformCache::getDiskFileFor(const String& key) const
+{
+    return cacheDirectory.getChildFile(String::toHexString(key.hashCode64()) + ".wfm");
+}
+
+void WaveformCache::trimDiskTier()
+{
+    auto cacheFiles = cacheDirectory.findChildFiles(File::findFiles, false, "*.wfm");
+
+    int64 diskUsage = 0;
+    for (auto& cacheFile : cacheFiles)
+    {
+        diskUsage += cacheFile.getSize();
+    }
+
+    //least recently used first, reading a file having touched it
+    std::sort(cacheFiles.begin(), cacheFiles.end(), [] (const File& a, const File& b)
+    {
+        return a.getLastModificationTime().toMilliseconds() < b.getLastModificationTime().toMilliseconds();
+    });
+
+    for (auto& cacheFile : cacheFiles)
+    {
+        if (diskUsage <= diskBudgetBytes)
+        {
+            break;
+        }
+        auto size = cacheFile.getSize();
+        if (cacheFile.deleteFile())
+        {
+            diskUsage -= size;
+        }
+    }
+}
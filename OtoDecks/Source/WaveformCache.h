@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    WaveformCache.h
+    Created: 18 Oct 2026 8:47:52am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include "WaveformPyramid.h"
+
+//==============================================================================
+/*
+    Builds waveform pyramids on a background thread and keeps the most recently
+    used ones, so a track that comes back to a deck is drawn straight away.
+    Every pyramid built is also written to a small file on disk, which later
+    sessions read instead of decoding the track again; the least recently used
+    files go once the folder outgrows its budget. Keyed the same way as the
+    decoded track cache. Sends a change message whenever a build finishes.
+*/
+class WaveformCache : public ChangeBroadcaster
+{
+public:
+    WaveformCache(AudioFormatManager& _formatManager,
+                  int _maxTracksInMemory = 32,
+                  File _cacheDirectory = File());
+    ~WaveformCache() override;
+
+    /** the track's pyramid from RAM or disk, otherwise nullptr and it starts building. Also
+        nullptr for a track that couldn't be read */
+    WaveformPyramid::Ptr getPyramid(const URL& url);
+
+    /** identity of a track's contents, for local files the same as DecodedTrackCache's */
+    static String getKeyFor(const URL& url);
+
+private:
+    struct Entry
+    {
+        WaveformPyramid::Ptr pyramid;
+        uint64 lastUsed = 0;
+    };
+
+    /** runs on the pool */
+    void build(const URL& url, const String& key);
+    /** forgets the least recently used pyramids past the limit; displays keep theirs */
+    void trimToLimit();
+
+    File getDiskFileFor(const String& key) const;
+    /** deletes the least recently used files once the folder outgrows its budget */
+    void trimDiskTier();
+
+    AudioFormatManager& formatManager;
+    const int maxTracksInMemory;
+    File cacheDirectory;
+
+    CriticalSection lock;
+    std::map<String, Entry> entries;
+    StringArray keysBeingBuilt;
+    uint64 useCounter = 0;
+
+    ThreadPool buildPool{1};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformCache)
+};
@@ -2,11 +2,14 @@
 
 #include <JuceHeader.h>
 #include "WaveformDisplay.h"
+#include "CallbackProfiler.h"
+
+// the closest zoom still has a few samples per pixel
+static const double minVisibleSeconds = 0.5;
 
 //==============================================================================
-WaveformDisplay::WaveformDisplay(AudioFormatManager & 	formatManagerToUse,
-                                 AudioThumbnailCache & 	cacheToUse) :
-                                 audioThumb(1000, formatManagerToUse, cacheToUse), 
+WaveformDisplay::WaveformDisplay(WaveformCache & 	cacheToUse) :
+                                 cache(cacheToUse), 
                                  fileLoaded(false), 
                                  position(0)
                           
@@ -14,15 +17,45 @@ WaveformDisplay::WaveformDisplay(AudioFormatManager & 	formatManagerToUse,
     // In your constructor, you should add any child components, and
     // initialise any special settings that your component needs.
 
-  audioThumb.addChangeListener(this);
+  cache.addChangeListener(this);
+
+  //the layer covers every pixel, so nothing behind needs painting when the playhead moves
+  setOpaque(true);
 }
 
 WaveformDisplay::~WaveformDisplay()
 {
+  cache.removeChangeListener(this);
 }
 
 void WaveformDisplay::paint (juce::Graphics& g)
 {
+    //timed while the profiler is showing, the layer apart from the rest
+    CallbackProfiler::ScopedStage stage(CallbackProfiler::Stage::waveformPaint);
+
+    if (! layerValid)
+    {
+        CallbackProfiler::ScopedStage layerStage(CallbackProfiler::Stage::waveformLayer);
+        renderLayer();
+    }
+    g.drawImage(layer, getLocalBounds().toFloat());
+
+    if (fileLoaded && pyramid != nullptr)
+    {
+        //setting colour to playerhead
+        g.setColour(juce::Colours::mediumspringgreen);
+        g.fillRect(getPlayheadX(), 0, 2, getHeight());
+    }
+}
+
+void WaveformDisplay::renderLayer()
+{
+    const float scale = Component::getApproximateScaleFactorForComponent(this);
+    layer = Image(Image::RGB, jmax(1, roundToInt(getWidth() * scale)), jmax(1, roundToInt(getHeight() * scale)), false);
+    layerValid = true;
+
+    Graphics g(layer);
+    g.addTransform(AffineTransform::scale(scale));
 
     g.fillAll(getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));   // clear the background
 
@@ -32,18 +65,11 @@ void WaveformDisplay::paint (juce::Graphics& g)
     //draw waveforms when file is loaded into deck
     if(fileLoaded)
     { 
-      g.setColour(juce::Colours::blue);
-      audioThumb.drawChannel(g, 
-        getLocalBounds(), //initialising area
-        0, //start time
-        audioThumb.getTotalLength(), //retrieving the length of track as end time
-        0, 
-        1.0f
-      );
-
-      //setting colour to playerhead
-      g.setColour(juce::Colours::mediumspringgreen);
-      g.fillRect(position * getWidth(), 0, 2, getHeight());
+      //the pyramid turns up a moment after the track when it hasn't been drawn before
+      if (pyramid != nullptr)
+      {
+        drawWaveform(g);
+      }
 
       //display name of currently playing track on the waveform in white
       g.setColour(juce::Colours::floralwhite);
@@ -68,12 +94,18 @@ void WaveformDisplay::resized()
     // This method is where you should set the bounds of any child
     // components that your component contains..
 
+    invalidateLayer();
 }
 
 void WaveformDisplay::loadURL(URL audioURL)
 {
-  audioThumb.clear();
-  fileLoaded  = audioThumb.setSource(new URLInputSource(audioURL));
+  url = audioURL;
+  position = 0;
+  viewStart = 0;
+  pyramid = cache.getPyramid(audioURL);
+
+  //the cache builds the waveform in the background, so here it's enough that there is a file
+  fileLoaded = audioURL.isLocalFile() ? audioURL.getLocalFile().existsAsFile() : ! audioURL.isEmpty();
   if (fileLoaded)
   {
         std::string justFile = audioURL.toString(false).toStdString();
@@ -83,19 +115,26 @@ void WaveformDisplay::loadURL(URL audioURL)
         std::string file = justFile.substr(startFilePos + 1, justFile.length() - startFilePos - extn.size() - 2);
 
         nowPlaying = file;
-        repaint();
   }
   else {
     std::cout << "wfd: not loaded! " << std::endl;
   }
+  invalidateLayer();
 
 }
 
 void WaveformDisplay::changeListenerCallback (ChangeBroadcaster *source)
 {
-    std::cout << "wfd: change received! " << std::endl;
-
-    repaint();
+    //a build finished, which may be ours
+    if (fileLoaded && pyramid == nullptr)
+    {
+        pyramid = cache.getPyramid(url);
+        if (pyramid != nullptr)
+        {
+            setViewStart(viewStart);
+            invalidateLayer();
+        }
+    }
 
 }
 
@@ -104,13 +143,145 @@ void WaveformDisplay::setPositionRelative(double pos)
   if (pos != position && !isnan(pos))
 
   {
+    const int oldX = getPlayheadX();
     position = pos;
-    repaint();
+
+    //zoomed in, turn the page once the playhead runs off the end of the view
+    if (pyramid != nullptr && zoom > 1.0)
+    {
+      const double seconds = position * pyramid->getLengthInSeconds();
+      if (seconds < viewStart || seconds >= viewStart + getVisibleSeconds())
+      {
+        setViewStart(seconds - getVisibleSeconds() * 0.1);
+        invalidateLayer();
+        return;
+      }
+    }
+
+    //the layer underneath is unchanged, so only the two strips need compositing
+    const int newX = getPlayheadX();
+    if (newX != oldX)
+    {
+      repaint(oldX - 1, 0, 4, getHeight());
+      repaint(newX - 1, 0, 4, getHeight());
+    }
   }
 
   
 }
 
+void WaveformDisplay::setZoom(double newZoom)
+{
+  if (pyramid == nullptr)
+  {
+    zoom = jmax(1.0, newZoom);
+    return;
+  }
 
+  //keep the playhead where it is on screen
+  const double seconds = position * pyramid->getLengthInSeconds();
+  const double onScreen = (seconds - viewStart) / getVisibleSeconds();
+  zoom = jlimit(1.0, jmax(1.0, pyramid->getLengthInSeconds() / minVisibleSeconds), newZoom);
+  setViewStart(seconds - onScreen * getVisibleSeconds());
+  invalidateLayer();
+}
+
+double WaveformDisplay::getZoom() const
+{
+  return zoom;
+}
 
+void WaveformDisplay::mouseWheelMove (const MouseEvent& event, const MouseWheelDetails& wheel)
+{
+  if (pyramid == nullptr || getWidth() <= 0)
+  {
+    return;
+  }
 
+  //the time under the pointer stays under it
+  const double across = event.position.x / getWidth();
+  const double seconds = viewStart + across * getVisibleSeconds();
+  zoom = jlimit(1.0, jmax(1.0, pyramid->getLengthInSeconds() / minVisibleSeconds), zoom * std::pow(2.0, wheel.deltaY * 4.0));
+  setViewStart(seconds - across * getVisibleSeconds());
+  invalidateLayer();
+}
+
+//==============================================================================
+double WaveformDisplay::getVisibleSeconds() const
+{
+  return pyramid != nullptr ? pyramid->getLengthInSeconds() / zoom : 0.0;
+}
+
+void WaveformDisplay::setViewStart(double seconds)
+{
+  const double length = pyramid != nullptr ? pyramid->getLengthInSeconds() : 0.0;
+  viewStart = jlimit(0.0, jmax(0.0, length - getVisibleSeconds()), seconds);
+}
+
+int WaveformDisplay::getPlayheadX() const
+{
+  if (pyramid == nullptr || getVisibleSeconds() <= 0)
+  {
+    return 0;
+  }
+  const double playhead = (position * pyramid->getLengthInSeconds() - viewStart) / getVisibleSeconds();
+  return (int) std::floor(playhead * getWidth());
+}
+
+void WaveformDisplay::invalidateLayer()
+{
+  layerValid = false;
+  repaint();
+}
+
+void WaveformDisplay::drawWaveform(Graphics& g)
+{
+  const int width = getWidth();
+  if (width <= 0)
+  {
+    return;
+  }
+
+  //one lookup per pixel whatever the zoom
+  peaks.resize((size_t) width);
+  const double sampleRate = pyramid->getSampleRate();
+  pyramid->getPeaks(viewStart * sampleRate, getVisibleSeconds() * sampleRate / width, peaks.data(), width);
+  drawPeaks(g, peaks.data(), width, (float) getHeight());
+}
+
+void WaveformDisplay::drawPeaks(Graphics& g, const WaveformPyramid::Peak* peaks, int numPixels, float height)
+{
+  const Colour lowColour(0xff2040ff);
+  const Colour midColour(0xffffa020);
+  const Colour highColour(0xfff0f0ff);
+
+  const float centre = height * 0.5f;
+  const float scale = height * 0.5f;
+
+  for (int x = 0; x < numPixels; ++x)
+  {
+    const auto& peak = peaks[x];
+
+    //each band's colour in proportion to its share of the energy; silence has no shares and stays blue
+    const int total = peak.low + peak.mid + peak.high;
+    Colour colour = lowColour;
+    if (total > 0)
+    {
+      auto mix = [&] (uint8 low, uint8 mid, uint8 high)
+      {
+        return (uint8) ((low * peak.low + mid * peak.mid + high * peak.high) / total);
+      };
+      colour = Colour(mix(lowColour.getRed(), midColour.getRed(), highColour.getRed()),
+                      mix(lowColour.getGreen(), midColour.getGreen(), highColour.getGreen()),
+                      mix(lowColour.getBlue(), midColour.getBlue(), highColour.getBlue()));
+    }
+
+    g.setColour(colour);
+    g.drawVerticalLine(x, centre - peak.max * scale, centre - peak.min * scale);
+
+    //the RMS, lighter, inside the peaks
+    const float rms = peak.rms * scale;
+    g.setColour(colour.brighter(0.5f));
+    g.drawVerticalLine(x, centre - rms, centre + rms);
+  }
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "WaveformCache.h"
 
 //==============================================================================
 /*
@@ -11,8 +12,7 @@ class WaveformDisplay    : public Component,
                            public ChangeListener
 {
 public:
-    WaveformDisplay( AudioFormatManager & 	formatManagerToUse,
-                    AudioThumbnailCache & 	cacheToUse );
+    WaveformDisplay( WaveformCache & 	cacheToUse );
     ~WaveformDisplay() override;
 
     void paint (juce::Graphics&) override;
@@ -22,15 +22,55 @@ public:
 
     void loadURL(URL audioURL);
 
-    /** set the relative position of the playhead*/
+    /** set the relative position of the playhead, repainting only where it was and where it is */
     void setPositionRelative(double pos);
 
+    /** 1 shows the whole track, 2 half of it and so on. Zoomed in, the view pages along with the playhead */
+    void setZoom(double newZoom);
+    double getZoom() const;
+
+    /** the mouse wheel zooms in and out around the pointer */
+    void mouseWheelMove (const MouseEvent& event, const MouseWheelDetails& wheel) override;
+
+    /** a column per peak from x = 0, the min and max outline with the RMS lighter inside it,
+        coloured blue for bass, amber for mids and white for highs */
+    static void drawPeaks(Graphics& g, const WaveformPyramid::Peak* peaks, int numPixels, float height);
+
 private:
-    AudioThumbnail audioThumb;
+    /** how much of the track the view covers, in seconds */
+    double getVisibleSeconds() const;
+    /** keeps the view inside the track */
+    void setViewStart(double seconds);
+
+    /** min and max outline with the RMS inside it, from the pyramid */
+    void drawWaveform(Graphics& g);
+
+    /** the playhead's left edge, in pixels */
+    int getPlayheadX() const;
+    /** draws everything but the playhead into the layer, at the screen's resolution */
+    void renderLayer();
+    /** the layer is drawn again before the next paint; call when anything in it changes */
+    void invalidateLayer();
+
+    WaveformCache& cache;
+    URL url;
+    //nullptr until the cache has built it
+    WaveformPyramid::Ptr pyramid;
+    //one per pixel, refilled on every paint
+    std::vector<WaveformPyramid::Peak> peaks;
     
     bool fileLoaded; 
     double position;
     std::string nowPlaying;
+
+    double zoom = 1.0;
+    //where the view starts in the track, in seconds
+    double viewStart = 0;
+
+    //the waveform, outline and title, which only change with the track, the view or the size;
+    //playhead moves just copy the strip of it they uncover
+    Image layer;
+    bool layerValid = false;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformDisplay)
 };
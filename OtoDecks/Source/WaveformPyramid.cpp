@@ -0,0 +1,381 @@
+/*
+  ==============================================================================
+
+    WaveformPyramid.cpp
+    Created: 18 Oct 2026 8:20:14am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "WaveformPyramid.h"
+#include "VectorKernels.h"
+#include "DeckEQ.h"
+
+// bins decoded at a time while building
+static const int readBlockBins = 1024;
+
+// waveform file: magic, version, the cache key of the track it was built from, sample rate,
+// length, bin count, then min, max and RMS of each bin as int16 and its low, mid and high shares as uint8
+static const char* const waveformFileMagic = "OTWF";
+static const int waveformFileVersion = 3;
+// the header without its key
+static const int waveformFileHeaderSize = 32;
+static const int bytesPerBin = 9;
+
+static const float butterworthQ = 0.70710678f;
+
+//==============================================================================
+/*
+    Splits blocks into low, mid and high with the same Linkwitz-Riley crossovers
+    as DeckEQ, the channels going through the biquads together in the lanes of a
+    SIMDRegister, and sums each band's energy over a bin.
+*/
+class WaveformPyramid::BandSplitter
+{
+public:
+    BandSplitter(double sampleRate, int maximumBlockSize)
+    {
+        bands = dsp::AudioBlock<Vector>(memory, 3, (size_t) maximumBlockSize);
+        //lanes past the last channel are never written, and stay silent through every filter
+        bands.clear();
+
+        auto lowSplit = Coefficients::makeLowPass(sampleRate, DeckEQ::lowCrossover, butterworthQ);
+        auto lowSplitHigh = Coefficients::makeHighPass(sampleRate, DeckEQ::lowCrossover, butterworthQ);
+        auto highSplit = Coefficients::makeLowPass(sampleRate, DeckEQ::highCrossover, butterworthQ);
+        auto highSplitHigh = Coefficients::makeHighPass(sampleRate, DeckEQ::highCrossover, butterworthQ);
+
+        for (int i = 0; i < 2; ++i)
+        {
+            lowSplitLowPass[i].coefficients = lowSplit;
+            lowSplitHighPass[i].coefficients = lowSplitHigh;
+            highSplitLowPass[i].coefficients = highSplit;
+            highSplitHighPass[i].coefficients = highSplitHigh;
+        }
+    }
+
+    /** splits the first numSamples of the buffer's first numChannels channels */
+    void process(const AudioBuffer<float>& buffer, int numChannels, int numSamples)
+    {
+        const int numLanes = (int) Vector::size();
+        auto low = bands.getSingleChannelBlock(0).getSubBlock(0, (size_t) numSamples);
+        auto mid = bands.getSingleChannelBlock(1).getSubBlock(0, (size_t) numSamples);
+        auto high = bands.getSingleChannelBlock(2).getSubBlock(0, (size_t) numSamples);
+
+        //channel n goes in lane n, the input starting out in the high band
+        auto* highData = high.getChannelPointer(0);
+        auto* lanes = reinterpret_cast<float*>(highData);
+        for (int ch = 0; ch < jmin(numChannels, numLanes); ++ch)
+        {
+            auto* source = buffer.getReadPointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                lanes[i * numLanes + ch] = source[i];
+            }
+        }
+
+        dsp::ProcessContextReplacing<Vector> lowContext(low);
+        dsp::ProcessContextReplacing<Vector> midContext(mid);
+        dsp::ProcessContextReplacing<Vector> highContext(high);
+
+        //only the energy matters here, so the low band skips DeckEQ's phase matching all pass
+        std::copy(highData, highData + numSamples, low.getChannelPointer(0));
+        lowSplitLowPass[0].process(lowContext);
+        lowSplitLowPass[1].process(lowContext);
+        lowSplitHighPass[0].process(highContext);
+        lowSplitHighPass[1].process(highContext);
+
+        std::copy(highData, highData + numSamples, mid.getChannelPointer(0));
+        highSplitLowPass[0].process(midContext);
+        highSplitLowPass[1].process(midContext);
+        highSplitHighPass[0].process(highContext);
+        highSplitHighPass[1].process(highContext);
+    }
+
+    /** the sum of squares of band 0, 1 or 2 over numSamples from start, every channel together */
+    double getEnergy(int band, int start, int numSamples) const
+    {
+        const auto* data = bands.getChannelPointer((size_t) band) + start;
+        auto sum = Vector::expand(0.0f);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            sum += data[i] * data[i];
+        }
+        return sum.sum();
+    }
+
+private:
+    using Vector = dsp::SIMDRegister<float>;
+    using Filter = dsp::IIR::Filter<Vector>;
+    using Coefficients = dsp::IIR::Coefficients<float>;
+
+    HeapBlock<char> memory;
+    dsp::AudioBlock<Vector> bands;
+
+    Filter lowSplitLowPass[2], lowSplitHighPass[2];
+    Filter highSplitLowPass[2], highSplitHighPass[2];
+};
+
+//==============================================================================
+WaveformPyramid::WaveformPyramid(double _sampleRate, int64 _lengthInSamples)
+               : sampleRate(_sampleRate),
+                 lengthInSamples(_lengthInSamples)
+{
+}
+
+WaveformPyramid::Ptr WaveformPyramid::build(AudioFormatReader& reader)
+{
+    if (reader.lengthInSamples <= 0 || reader.sampleRate <= 0)
+    {
+        return nullptr;
+    }
+
+    Ptr pyramid (new WaveformPyramid(reader.sampleRate, reader.lengthInSamples));
+    const int64 length = reader.lengthInSamples;
+    const int numChannels = jmin(2, (int) reader.numChannels);
+
+    pyramid->levels.resize(1);
+    auto& bins = pyramid->levels[0];
+    bins.resize((size_t) ((length + baseBinSize - 1) / baseBinSize));
+
+    AudioBuffer<float> block(numChannels, readBlockBins * baseBinSize);
+    BandSplitter splitter(reader.sampleRate, block.getNumSamples());
+    for (int64 pos = 0; pos < length; pos += block.getNumSamples())
+    {
+        const auto numThisTime = (int) jmin((int64) block.getNumSamples(), length - pos);
+        reader.read(&block, 0, numThisTime, pos, true, numChannels > 1);
+        splitter.process(block, numChannels, numThisTime);
+
+        for (int start = 0; start < numThisTime; start += baseBinSize)
+        {
+            const int numInBin = jmin(baseBinSize, numThisTime - start);
+            auto& peak = bins[(size_t) ((pos + start) / baseBinSize)];
+            double squares = 0;
+
+            //the min, max and sum of squares of a bin are each one vector pass per channel
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto* samples = block.getReadPointer(ch, start);
+                const auto range = FloatVectorOperations::findMinAndMax(samples, numInBin);
+                //from the first channel's range, so a bin that never crosses zero doesn't reach it
+                peak.min = ch == 0 ? range.getStart() : jmin(peak.min, range.getStart());
+                peak.max = ch == 0 ? range.getEnd() : jmax(peak.max, range.getEnd());
+                squares += VectorKernels::dotProduct(samples, samples, numInBin);
+            }
+            peak.rms = (float) std::sqrt(squares / (numInBin * numChannels));
+
+            const double low = splitter.getEnergy(0, start, numInBin);
+            const double mid = splitter.getEnergy(1, start, numInBin);
+            const double high = splitter.getEnergy(2, start, numInBin);
+            const double total = low + mid + high;
+            if (total > 0)
+            {
+                peak.low = (uint8) roundToInt(low * 255.0 / total);
+                peak.mid = (uint8) roundToInt(mid * 255.0 / total);
+                peak.high = (uint8) roundToInt(high * 255.0 / total);
+            }
+        }
+    }
+
+    pyramid->buildLevels();
+    return pyramid;
+}
+
+WaveformPyramid::Ptr WaveformPyramid::readFromFile(const File& file, const String& key)
+{
+    MemoryBlock data;
+    if (! file.existsAsFile() || ! file.loadFileAsData(data) || data.getSize() < (size_t) waveformFileHeaderSize)
+    {
+        return nullptr;
+    }
+
+    MemoryInputStream in(data, false);
+    char magic[4];
+    in.read(magic, 4);
+    const int version = in.readInt();
+    if (std::memcmp(magic, waveformFileMagic, 4) != 0 || version != waveformFileVersion)
+    {
+        //from an older build, without the bands or the key, the caller will build it again
+        return nullptr;
+    }
+
+    //files are named by a hash of the key, so two tracks can land on the same name
+    if (in.readString() != key)
+    {
+        return nullptr;
+    }
+
+    const double rate = in.readDouble();
+    const int64 length = in.readInt64();
+    const int64 numBins = in.readInt64();
+
+    if (rate <= 0 || length <= 0 || numBins != (length + baseBinSize - 1) / baseBinSize
+        || data.getSize() != (size_t) (in.getPosition() + numBins * bytesPerBin))
+    {
+        //half written, the caller will build it again
+        return nullptr;
+    }
+
+    Ptr pyramid (new WaveformPyramid(rate, length));
+    pyramid->levels.resize(1);
+    auto& bins = pyramid->levels[0];
+    bins.resize((size_t) numBins);
+
+    const float scale = 1.0f / 32767.0f;
+    for (auto& peak : bins)
+    {
+        peak.min = in.readShort() * scale;
+        peak.max = in.readShort() * scale;
+        peak.rms = in.readShort() * scale;
+        peak.low = (uint8) in.readByte();
+        peak.mid = (uint8) in.readByte();
+        peak.high = (uint8) in.readByte();
+    }
+
+    pyramid->buildLevels();
+    return pyramid;
+}
+
+bool WaveformPyramid::writeToFile(const File& file, const String& key) const
+{
+    //write next to the target and move it into place, so a reader never loads half a file
+    auto tempFile = file.getSiblingFile(file.getFileName() + ".part");
+    {
+        FileOutputStream out(tempFile);
+        if (! out.openedOk())
+        {
+            return false;
+        }
+        out.truncate();
+
+        const auto& bins = levels[0];
+        out.write(waveformFileMagic, 4);
+        out.writeInt(waveformFileVersion);
+        out.writeString(key);
+        out.writeDouble(sampleRate);
+        out.writeInt64(lengthInSamples);
+        out.writeInt64((int64) bins.size());
+
+        auto toInt16 = [] (float value) { return (short) roundToInt(jlimit(-1.0f, 1.0f, value) * 32767.0f); };
+        for (auto& peak : bins)
+        {
+            out.writeShort(toInt16(peak.min));
+            out.writeShort(toInt16(peak.max));
+            out.writeShort(toInt16(peak.rms));
+            out.writeByte((char) peak.low);
+            out.writeByte((char) peak.mid);
+            out.writeByte((char) peak.high);
+        }
+        out.flush();
+    }
+
+    return tempFile.moveFileTo(file);
+}
+
+void WaveformPyramid::getPeaks(double startSample, double samplesPerPixel, Peak* dest, int numPixels) const
+{
+    //the coarsest level that still has a bin or more per pixel
+    int level = 0;
+    while (level + 1 < (int) levels.size() && (double) ((int64) baseBinSize << (level + 1)) <= samplesPerPixel)
+    {
+        ++level;
+    }
+
+    const auto& bins = levels[(size_t) level];
+    const auto numBins = (int64) bins.size();
+    const auto binSize = (double) ((int64) baseBinSize << level);
+
+    for (int i = 0; i < numPixels; ++i)
+    {
+        //under two bins a pixel from the level picked, three where the pixel straddles them
+        const double start = startSample + i * samplesPerPixel;
+        auto first = (int64) std::floor(start / binSize);
+        auto last = jmax(first + 1, (int64) std::ceil((start + samplesPerPixel) / binSize));
+        first = jmax((int64) 0, first);
+        last = jmin(numBins, last);
+
+        if (first >= last)
+        {
+            dest[i] = {};
+            continue;
+        }
+
+        dest[i] = combine(&bins[(size_t) first], (size_t) (last - first));
+    }
+}
+
+double WaveformPyramid::getSampleRate() const
+{
+    return sampleRate;
+}
+
+int64 WaveformPyramid::getLengthInSamples() const
+{
+    return lengthInSamples;
+}
+
+double WaveformPyramid::getLengthInSeconds() const
+{
+    return lengthInSamples / sampleRate;
+}
+
+int WaveformPyramid::getNumLevels() const
+{
+    return (int) levels.size();
+}
+
+int64 WaveformPyramid::getMemoryUsage() const
+{
+    int64 numBytes = 0;
+    for (auto& level : levels)
+    {
+        numBytes += (int64) (level.size() * sizeof(Peak));
+    }
+    return numBytes;
+}
+
+//==============================================================================
+WaveformPyramid::Peak WaveformPyramid::combine(const Peak* bins, size_t numBins)
+{
+    Peak peak = bins[0];
+    double squares = 0, low = 0, mid = 0, high = 0;
+    for (size_t i = 0; i < numBins; ++i)
+    {
+        const auto& bin = bins[i];
+        peak.min = jmin(peak.min, bin.min);
+        peak.max = jmax(peak.max, bin.max);
+
+        //a loud bin's colour counts for more than a quiet one's
+        const double energy = (double) bin.rms * bin.rms;
+        squares += energy;
+        low += bin.low * energy;
+        mid += bin.mid * energy;
+        high += bin.high * energy;
+    }
+
+    peak.rms = (float) std::sqrt(squares / (double) numBins);
+    if (squares > 0)
+    {
+        peak.low = (uint8) roundToInt(low / squares);
+        peak.mid = (uint8) roundToInt(mid / squares);
+        peak.high = (uint8) roundToInt(high / squares);
+    }
+    return peak;
+}
+
+void WaveformPyramid::buildLevels()
+{
+    while (levels.back().size() > 1)
+    {
+        const auto& below = levels.back();
+        std::vector<Peak> level((below.size() + 1) / 2);
+
+        for (size_t i = 0; i < level.size(); ++i)
+        {
+            //an odd bin out at the end stands on its own
+            level[i] = combine(&below[i * 2], jmin((size_t) 2, below.size() - i * 2));
+        }
+        levels.push_back(std::move(level));
+    }
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    WaveformPyramid.h
+    Created: 18 Oct 2026 8:20:14am
+    Author:  Aaron Lee
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    A track's waveform at every zoom: min, max and RMS peaks for bins of
+    baseBinSize samples, then levels above with half as many bins each. Built
+    once per track and immutable after that, so the decks' displays share it
+    freely. Any zoom is drawn from the level closest to one bin per pixel,
+    which makes a pixel a handful of bins at most.
+
+    Each bin also keeps how its energy splits between the low, mid and high
+    bands, split at the decks' EQ crossovers, for colouring the waveform.
+*/
+class WaveformPyramid : public ReferenceCountedObject
+{
+public:
+    using Ptr = ReferenceCountedObjectPtr<WaveformPyramid>;
+
+    /** the lowest and highest sample and the RMS over a bin, both channels together */
+    struct Peak
+    {
+        float min = 0;
+        float max = 0;
+        float rms = 0;
+        /** each band's share of the bin's energy, out of 255 */
+        uint8 low = 0;
+        uint8 mid = 0;
+        uint8 high = 0;
+    };
+
+    /** samples per bin at the finest level */
+    static constexpr int baseBinSize = 64;
+
+    /** reads the whole of the reader on the calling thread, nullptr if it has nothing in it */
+    static Ptr build(AudioFormatReader& reader);
+
+    /** reads a file written by writeToFile() for the same key, nullptr if it isn't one */
+    static Ptr readFromFile(const File& file, const String& key);
+    /** writes the finest level as 16-bit peaks and 8-bit bands; the levels above are rebuilt when it's read.
+        key names the track it was built from, so a file can't be read back for a different one */
+    bool writeToFile(const File& file, const String& key) const;
+
+    /** one peak per pixel, the first pixel starting at startSample and each covering samplesPerPixel.
+        Anything outside the track is silence */
+    void getPeaks(double startSample, double samplesPerPixel, Peak* dest, int numPixels) const;
+
+    double getSampleRate() const;
+    int64 getLengthInSamples() const;
+    double getLengthInSeconds() const;
+    int getNumLevels() const;
+    /** RAM held by the levels */
+    int64 getMemoryUsage() const;
+
+private:
+    class BandSplitter;
+
+    WaveformPyramid(double _sampleRate, int64 _lengthInSamples);
+
+    /** one peak covering numBins bins, the bands weighted by each bin's energy */
+    static Peak combine(const Peak* bins, size_t numBins);
+
+    /** adds the levels above the finest, each from the one below */
+    void buildLevels();
+
+    double sampleRate;
+    int64 lengthInSamples;
+    std::vector<std::vector<Peak>> levels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformPyramid)
+};